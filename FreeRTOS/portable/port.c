@@ -38,6 +38,10 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+    #include "port_tickless.h"
+#endif
+
 /* Hardware specifics. */
 #define portTIMER_PRESCALE  8
 #define portPRESCALE_BITS   1
@@ -328,3 +332,104 @@ void vPortClearInterruptMaskFromISR( UBaseType_t uxSavedStatusRegister )
     _CP0_SET_STATUS( uxSavedStatusRegister );
 }
 /*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+/* The core timer runs at SYSCLK / 2 in Run and Idle mode.  Its count is left
+alone (it is the run time stats clock), only the compare register is used to
+end a sleep. */
+#define portCORE_TIMER_HZ           ( configCPU_CLOCK_HZ / 2UL )
+#define portCORE_COUNTS_PER_TICK    ( portCORE_TIMER_HZ / configTICK_RATE_HZ )
+
+/* Conversions between Timer 1 counts and core timer counts. */
+#define portTIMER1_TO_CORE( x )     ( ( uint32_t ) ( ( ( uint64_t ) ( x ) * portTIMER_PRESCALE * portCORE_TIMER_HZ ) / configPERIPHERAL_CLOCK_HZ ) )
+#define portCORE_TO_TIMER1( x )     ( ( uint32_t ) ( ( ( uint64_t ) ( x ) * configPERIPHERAL_CLOCK_HZ ) / ( ( uint64_t ) portTIMER_PRESCALE * portCORE_TIMER_HZ ) ) )
+
+/*
+ * Called by the idle task with the scheduler suspended.  Stops the Timer 1
+ * tick, sets the core timer compare to the end of the expected idle time and
+ * waits.  WAIT puts the core into Idle mode (OSCCON.SLPEN is 0 from reset),
+ * peripherals keep running, so any enabled interrupt above IPL 0 ends the
+ * sleep early: the core timer compare, UART1 RX, or the ENC624J600 INT pin
+ * once it is routed to an external interrupt.  Interrupts stay disabled across
+ * WAIT, the core resumes after it without vectoring and the pending
+ * interrupt is taken once the tick count is corrected.
+ */
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+    uint32_t ulPosition;
+    uint32_t ulStart;
+    uint32_t ulElapsed;
+    uint32_t ulNewPosition;
+    uint32_t ulCompleted;
+    uint32_t ulTimer1;
+    TickType_t xModifiableIdleTime;
+
+    if( xExpectedIdleTime > ulPortTicklessMaxIdleTicks( portCORE_COUNTS_PER_TICK ) )
+    {
+        xExpectedIdleTime = ulPortTicklessMaxIdleTicks( portCORE_COUNTS_PER_TICK );
+    }
+
+    __builtin_disable_interrupts();
+
+    /* Stop the tick.  If it is already pending, or a task was readied since
+    the idle task decided to sleep, let the scheduler handle that first. */
+    T1CONbits.TON = 0;
+
+    if( ( IFS0bits.T1IF != 0 ) || ( eTaskConfirmSleepModeStatus() == eAbortSleep ) )
+    {
+        T1CONbits.TON = 1;
+        __builtin_enable_interrupts();
+        return;
+    }
+
+    ulPosition = portTIMER1_TO_CORE( TMR1 );
+    ulStart = _CP0_GET_COUNT();
+
+    _CP0_SET_COMPARE( ulStart + ulPortTicklessSleepCounts( xExpectedIdleTime, ulPosition, portCORE_COUNTS_PER_TICK ) );
+    IFS0CLR = _IFS0_CTIF_MASK;
+    IPC0CLR = _IPC0_CTIP_MASK;
+    IPC0SET = ( configKERNEL_INTERRUPT_PRIORITY << _IPC0_CTIP_POSITION );
+    IEC0SET = _IEC0_CTIE_MASK;
+
+    xModifiableIdleTime = xExpectedIdleTime;
+    configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+
+    if( xModifiableIdleTime > 0 )
+    {
+        __asm__ volatile ( "wait" );
+    }
+
+    configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+    ulElapsed = _CP0_GET_COUNT() - ulStart;
+
+    /* Writing the compare clears the core timer interrupt, move it a full
+    wrap away. */
+    IEC0CLR = _IEC0_CTIE_MASK;
+    _CP0_SET_COMPARE( _CP0_GET_COUNT() - 1UL );
+    IFS0CLR = _IFS0_CTIF_MASK;
+
+    ulCompleted = ulPortTicklessCompletedTicks( ulElapsed, ulPosition, portCORE_COUNTS_PER_TICK,
+                                                xExpectedIdleTime, &ulNewPosition );
+
+    /* Resume the tick in phase with the time that passed. */
+    ulTimer1 = portCORE_TO_TIMER1( ulNewPosition );
+
+    if( ulTimer1 > PR1 )
+    {
+        ulTimer1 = PR1;
+    }
+
+    TMR1 = ulTimer1;
+    T1CONbits.TON = 1;
+
+    if( ulCompleted > 0UL )
+    {
+        vTaskStepTick( ( TickType_t ) ulCompleted );
+    }
+
+    __builtin_enable_interrupts();
+}
+
+#endif /* configUSE_TICKLESS_IDLE */
@@ -0,0 +1,60 @@
+/*
+ * Tick suppression arithmetic for the PIC32MX port.
+ *
+ * vPortSuppressTicksAndSleep() in port.c stops the Timer 1 tick, programs the
+ * CP0 core timer compare to the next expected wake up and executes WAIT.  The
+ * calculations it needs are kept here, free of any register access, so they
+ * can be compiled on a host and driven with a simulated timer.
+ *
+ * All positions and durations are in core timer counts (SYSCLK / 2).  The
+ * position is how far the current tick period has advanced.
+ */
+
+#ifndef PORT_TICKLESS_H
+#define PORT_TICKLESS_H
+
+#include <stdint.h>
+
+/*
+ * Longest sleep that can be programmed, the compare must stay within one wrap
+ * of the 32 bit count.  One period is kept back for the partial tick the sleep
+ * starts in.
+ */
+static inline uint32_t ulPortTicklessMaxIdleTicks( uint32_t ulCountsPerTick )
+{
+    return ( 0xFFFFFFFFUL / ulCountsPerTick ) - 1UL;
+}
+
+/*
+ * Core timer counts from now until the end of xExpectedIdleTicks tick periods,
+ * the first of which has already advanced by ulPosition.
+ */
+static inline uint32_t ulPortTicklessSleepCounts( uint32_t ulExpectedIdleTicks, uint32_t ulPosition, uint32_t ulCountsPerTick )
+{
+    return ( ulExpectedIdleTicks * ulCountsPerTick ) - ulPosition;
+}
+
+/*
+ * Splits the time actually slept into whole tick periods to step the kernel by
+ * and the position in the period that is now running.  An early wake up
+ * (interrupt) yields fewer ticks, a late one never more than were expected,
+ * because the kernel must not be stepped past the next unblock time.
+ */
+static inline uint32_t ulPortTicklessCompletedTicks( uint32_t ulElapsed, uint32_t ulPosition, uint32_t ulCountsPerTick,
+                                                     uint32_t ulExpectedIdleTicks, uint32_t *pulNewPosition )
+{
+    uint32_t ulTotal = ulPosition + ulElapsed;
+    uint32_t ulCompleted = ulTotal / ulCountsPerTick;
+
+    if( ulCompleted >= ulExpectedIdleTicks )
+    {
+        /* Woken by the compare match, the new period has just begun. */
+        *pulNewPosition = 0UL;
+        return ulExpectedIdleTicks;
+    }
+
+    *pulNewPosition = ulTotal % ulCountsPerTick;
+    return ulCompleted;
+}
+
+#endif /* PORT_TICKLESS_H */
@@ -184,6 +184,12 @@ extern volatile UBaseType_t uxInterruptNesting;
 
 #define portNOP()   __asm volatile ( "nop" )
 
+/* Tickless idle, see vPortSuppressTicksAndSleep() in port.c. */
+#if ( configUSE_TICKLESS_IDLE == 1 )
+    extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+    #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Task function macros as described on the FreeRTOS.org WEB site. */
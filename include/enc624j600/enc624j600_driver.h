@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 /**
  *	@enum enc624j600_transmit_result
  *	@brief Returned values by enc624j600_transmit().
@@ -103,4 +105,36 @@ extern enc624j600_transmit_result enc624j600_transmit(uint8_t *destination_mac,
  *	@return enc624j600_receive_result
  *		See @ref enc624j600_receive_result for possible return values.
  */
-extern enc624j600_receive_result enc624j600_receive(uint8_t *destination_mac, uint8_t *source_mac, uint8_t *length_type, uint8_t *buffer, uint16_t *received_bytes);
\ No newline at end of file
+extern enc624j600_receive_result enc624j600_receive(uint8_t *destination_mac, uint8_t *source_mac, uint8_t *length_type, uint8_t *buffer, uint16_t *received_bytes);
+
+/**
+ *	@brief Reads a PHY register through the MII management interface.
+ *
+ *	Waits for the MII read and spins on MISTAT.BUSY until it completes.
+ *	Call it from a task that may block, not from the tcpip thread. The HAL
+ *	locks each SPI transaction, not the MII sequence of several of them:
+ *	callers serialize PHY access with each other.
+ *
+ *	@param address PHY register address (0x00 - 0x1F).
+ *
+ *	@return Register value.
+ */
+extern uint16_t enc624j600_read_phy_register(uint8_t address);
+
+/**
+ *	@brief Reads the MAC address the device filters and transmits with.
+ *
+ *	The factory address unless enc624j600_init() was given a custom one.
+ *
+ *	@param mac Pointer to a 6-byte buffer for the address.
+ */
+extern void enc624j600_read_mac_address(uint8_t *mac);
+
+/**
+ *	@brief Reads the link state from ESTAT.PHYLNK.
+ *
+ *	A single SFR read, cheap enough for periodic polling.
+ *
+ *	@return 1 if the PHY has a link, 0 if not or before enc624j600_init() completed.
+ */
+extern uint8_t enc624j600_link_up(void);
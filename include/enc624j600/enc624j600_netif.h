@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lwip/err.h"
+#include "lwip/netif.h"
+
+#define ENC624J600_NETIF_MTU            1500U
+
+/** Static frame buffer, shared by transmit and receive */
+#define ENC624J600_NETIF_BUFFER_BYTES   (14U + ENC624J600_NETIF_MTU)
+
+/** Frames taken from the device per enc624j600_netif_poll() call */
+#define ENC624J600_NETIF_POLL_BUDGET    4U
+
+/**
+ *  @brief netif_add() init callback for the ENC624J600.
+ *
+ *  Call after enc624j600_init(), the MAC address is read from the device.
+ *  Link up follows ESTAT.PHYLNK at the time of the call.
+ *
+ *  @return ERR_OK.
+ */
+extern err_t enc624j600_netif_init(struct netif *netif);
+
+/**
+ *  @brief Moves received frames from the device into lwIP.
+ *
+ *  Each frame is copied into a PBUF_POOL chain and handed to netif->input,
+ *  with tcpip_input() the tcpip thread processes it. A frame is dropped if
+ *  no pbuf is free, the device buffer is not held up by lwIP.
+ *
+ *  @note Call from one task only, not from the tcpip thread.
+ *
+ *  @return Number of frames taken from the device, at most ENC624J600_NETIF_POLL_BUDGET.
+ */
+extern uint8_t enc624j600_netif_poll(struct netif *netif);
+
+/**
+ *  @return Received frames dropped because lwIP had no pbuf for them.
+ */
+extern uint32_t enc624j600_netif_rx_dropped(void);
+
+/**
+ *  @return Frames lwIP handed to the netif that the device did not transmit.
+ */
+extern uint32_t enc624j600_netif_tx_failed(void);
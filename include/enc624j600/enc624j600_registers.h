@@ -0,0 +1,391 @@
+#pragma once
+
+/*
+ *  ENC624J600 register addresses, SPI opcodes and bit masks, shared by the
+ *  driver and the host device model.
+ */
+
+/**
+ *  @defgroup Unbanked_SFR_Address Unbanked SFR addresses
+ *  @brief Unbanked special function register (SFR) addresses for the ENC624J600.
+ * 
+ *  @{
+ */
+
+#define ETXST       0x00U   /**< Transmit Data Start Pointer */
+#define ETXLEN      0x02U   /**< Transmit Buffer Length Pointer */
+#define ERXST       0x04U   /**< Receive Buffer Start Address */
+#define ERXTAIL     0x06U   /**< Receive Tail Pointer */
+#define ERXHEAD     0x08U   /**< Receive Head Pointer */
+#define EDMAST      0x0AU   /**< DMA Start Address */
+#define EDMALEN     0x0CU   /**< DMA Length */
+#define EDMADST     0x0EU   /**< DMA Destination Address */
+#define EDMACS      0x10U   /**< DMA Checksum */
+#define ETXSTAT     0x12U   /**< Ethernet transmit status register */
+#define ETXWIRE     0x14U   /**< Transmit Byte Count on Wire (including collision bytes) */
+#define EUDAST      0x16U   /**< User-Defined Area Start Pointer */
+#define EUDAND      0x18U   /**< User-Defined Area End Pointer */
+#define ESTAT       0x1AU   /**< Ethernet Status Register */
+#define EIR         0x1CU   /**< Ethernet Interrupt Flag Register */
+#define ECON1       0x1EU   /**< Ethernet control register 1 */
+#define EHT1        0x20U   /**< Hash Table Filter */
+#define EHT2        0x22U   /**< Hash Table Filter */
+#define EHT3        0x24U   /**< Hash Table Filter */
+#define EHT4        0x26U   /**< Hash Table Filter */
+#define EPMM1       0x28U   /**< Pattern Match Filter Mask */
+#define EPMM2       0x2AU   /**< Pattern Match Filter Mask */
+#define EPMM3       0x2CU   /**< Pattern Match Filter Mask */
+#define EPMM4       0x2EU   /**< Pattern Match Filter Mask */
+#define EPMCS       0x30U   /**< Pattern Match Filter Checksum */
+#define EPMO        0x32U   /**< Pattern Match Filter Offset */
+#define ERXFCON     0x34U   /**< Ethernet RX Filter Control Register */
+#define MACON1      0x40U   /**< MAC Control Register 1 */
+#define MACON2      0x42U   /**< MAC Control Register 2 */
+#define MABBIPG     0x44U   /**< MAC Back-To-Back Inter-Packet Gap Register */
+#define MAIPG       0x46U   /**< MAC Inter-Packet Gap Register */
+#define MACLCON     0x48U   /**< MAC Colision Control Register */
+#define MAMXFL      0x4AU   /**< MAC Maximum Frame Length */
+#define MICMD       0x52U   /**< MII Management Command Register */
+#define MIREGADR    0x54U   /**< MII Management Address Register */
+#define MAADR3      0x60U   /**< MAC Address 6-5th byte */
+#define MAADR2      0x62U   /**< MAC Address 4-3rd byte */
+#define MAADR1      0x64U   /**< MAC Address 2-1st byte */
+#define MIWR        0x66U   /**< MII Management Write Data */
+#define MIRD        0x68U   /**< MII Management Read Data */
+#define MISTAT      0x6AU   /**< MII Management Status Register */
+#define EPAUS       0x6CU   /**< Pause Timer Value */
+#define ECON2       0x6EU   /**< Ethernet Control Register 2 */
+#define ERXWM       0x70U   /**< Receive Watermark */
+#define EIE         0x72U   /**< Ethernet Interrupt Enable Register */
+#define EIDLED      0x74U   /**< Ethernet ID Status/Led Control Register */
+
+/** @} */
+
+
+/**
+ *  @defgroup PHY_SFR_Address Physical SFR addresses
+ *  @brief PHY special function register (SFR) addresses for the ENC624J600.
+ * 
+ *  @{
+ */
+
+#define PHCON1      0x00U   /**< PHY Control Register 1 */
+#define PHSTAT1     0x01U   /**< PHY Status Register 1 */
+#define PHANA       0x04U   /**< PHY Auto-Negotiation Advertisement Register */
+#define PHANLPA     0x05U   /**< PHY Auto-Negotiation Link Partner Ability Register */
+#define PHANE       0x06U   /**< PHY Auto-Negotiation Expansion Register */
+#define PHCON2      0x11U   /**< PHY Control Register 2 */
+#define PHSTAT2     0x1BU   /**< PHY Status Register 2 */
+#define PHSTAT3     0x1FU   /**< PHY Status Register 3 */
+
+/** @} */
+
+
+/**
+ *  @defgroup SPI_Instruction_Set SPI Instruction Set
+ *  @brief SPI instruction opcodes for the ENC624J600.
+ * 
+ *  @{
+ */
+
+/** @name Single-byte instructions */
+/** @{ */
+#define B0SEL       0xC0U   /**< Selects SFR Bank 0 */
+#define B1SEL       0xC2U   /**< Selects SFR Bank 1 */
+#define B2SEL       0xC4U   /**< Selects SFR Bank 2 */
+#define B3SEL       0xC6U   /**< Selects SFR Bank 3 */
+#define SETETHRST   0xCAU   /**< Issues System Reset by setting ETHRST */
+#define FCDISABLE   0xE0U   /**< Disables flow control */
+#define FCSINGLE    0xE2U   /**< Transmits a single pause frame */
+#define FCMULTIPLE  0xE4U   /**< Enables flow control with periodic pause frames */
+#define FCCLEAR     0xE6U   /**< Terminates flow control with a final pause frame */
+#define SETPKTDEC   0xCCU   /**< Decrements PKTCNT by setting PKTDEC */
+#define DMASTOP     0xD2U   /**< Stops current DMA operation by clearing DMAST */
+#define DMACKSUM    0xD8U   /**< Starts DMA and checksum operation */
+#define DMACKSUMS   0xDAU   /**< Starts DMA checksum operation with seed */
+#define DMACOPY     0xDCU   /**< Starts DMA copy and checksum operation */
+#define DMACOPYS    0xDEU   /**< Starts DMA copy and checksum operation with seed */
+#define SETTXRTS    0xD4U   /**< Sets TXRTS, sends an Ethernet packet */
+#define ENABLERX    0xE8U   /**< Enables packet reception by setting RXEN */
+#define DISABLERX   0xEAU   /**< Disables packet reception by clearing RXEN */
+#define SETEIE      0xECU   /**< Enable Ethernet Interrupts by setting INT */
+#define CLREIE      0xEEU   /**< Disable Ethernet Interrupts by clearing INT */
+/** @} */
+
+/** @name Two-byte instructions */
+/** @{ */
+#define RBSEL       0xC8U   /**< Read Bank Select */
+/** @} */
+
+/** @name Three-byte instructions */
+/** @{ */
+#define WGPRDPT     0x60U   /**< Write General Purpose Buffer Read Pointer (EGPRDPT) */
+#define RGPRDPT     0x62U   /**< Read General Purpose Buffer Read Pointer (EGPRDPT) */
+#define WRXRDPT     0x64U   /**< Write Receive Buffer Read Pointer (ERXRDPT) */
+#define RRXRDPT     0x66U   /**< Read Receive Buffer Read Pointer (ERXRDPT) */
+#define WUDARDPT    0x68U   /**< Write User-Defined Area Read Pointer (EUDARDPT) */
+#define RUDARDPT    0x6AU   /**< Read User-Defined Area Read Pointer (EUDARDPT) */
+#define WGPWRPT     0x6CU   /**< Write General Purpose Buffer Write Pointer (EGPWRPT) */
+#define RGPWRPT     0x6EU   /**< Read General Purpose Buffer Write Pointer (EGPWRPT) */
+#define WRXWRPT     0x70U   /**< Write Receive Buffer Write Pointer (ERXWRPT) */
+#define RRXWRPT     0x72U   /**< Read Receive Buffer Write Pointer (ERXWRPT) */
+#define WUDAWRPT    0x74U   /**< Write User-Defined Area Write Pointer (EUDAWRPT) */
+#define RUDAWRPT    0x76U   /**< Read User-Defined Area Write Pointer (EUDAWRPT) */
+/** @} */
+
+/** @name Unbanked SFR operations */
+/** @{ */
+#define RCRU        0x20U   /**< Read Control Register(s), Unbanked */
+#define WCRU        0x22U   /**< Write Control Register(s), Unbanked */
+#define BFSU        0x24U   /**< Bit Field(s) Set, Unbanked */
+#define BFCU        0x26U   /**< Bit Field(s) Clear, Unbanked */
+/** @} */
+
+/** @name SRAM operations */
+/** @{ */
+#define RGPDATA     0x28U   /**< Read Data from EGPDATA */
+#define WGPDATA     0x2AU   /**< Write Data from EGPDATA */
+#define RRXDATA     0x2CU   /**< Read Data from ERXDATA */
+#define WRXDATA     0x2EU   /**< Write Data from ERXDATA */
+#define RUDADATA    0x30U   /**< Read Data from EUDADATA */
+#define WUDADATA    0x32U   /**< Write Data from EUDADATA */
+/** @} */
+
+/** @} */
+
+
+/**
+ *  @defgroup SFR_BitMasks SFR Bit Masks
+ *  @brief Bit masks for special function registers (SFRs).
+ * 
+ *  @{
+ */
+
+/* ETXSTAT */
+#define COLCNT0     0x0001U     /**< Transmit Collision Count Status bit */
+#define COLCNT1     0x0002U     /**< Transmit Collision Count Status bit */
+#define COLCNT2     0x0004U     /**< Transmit Collision Count Status bit */
+#define COLCNT3     0x0008U     /**< Transmit Collision Count Status bit */
+#define CRCBAD      0x0010U     /**< Transmit CRC Incorrect Status bit */
+#define DEFER       0x0080U     /**< Transmit Defer Status bit */
+#define EXDEFER     0x0100U     /**< Transmit Excessive Defer Status bit */
+#define MAXCOL      0x0200U     /**< Transmit Maximum Collisions Status bit */
+#define LATECOL     0x0400U     /**< Transmit Late Collision Status bit */
+
+/* ESTAT */
+#define PKTCNT0     0x0001U     /**< Receive Packet Count bits */
+#define PKTCNT1     0x0002U     /**< Receive Packet Count bits */
+#define PKTCNT2     0x0004U     /**< Receive Packet Count bits */
+#define PKTCNT3     0x0008U     /**< Receive Packet Count bits */
+#define PKTCNT4     0x0010U     /**< Receive Packet Count bits */
+#define PKTCNT5     0x0020U     /**< Receive Packet Count bits */
+#define PKTCNT6     0x0040U     /**< Receive Packet Count bits */
+#define PKTCNT7     0x0080U     /**< Receive Packet Count bits */
+#define PHYLNK      0x0100U     /**< PHY Linked Status bit */
+#define PHYDPX      0x0400U     /**< PHY Full Duplex Status bit */
+#define CLKRDY      0x1000U     /**< Clock Ready Status bit */
+#define RXBUSY      0x2000U     /**< Receive Logic Active Status bit */
+#define FCIDLE      0x4000U     /**< Flow Control Idle Status bit */
+#define INT         0x8000U     /**< Interrupt Pending Status bit */
+
+/* EIR */
+#define PCFULIF     0x0001U     /**< Packet Counter Full Interrupt Flag bit */
+#define RXABTIF     0x0002U     /**< Receive Abort Interrupt Flag bit */
+#define TXABTIF     0x0004U     /**< Transmit Abort Interrupt Flag bit */
+#define TXIF        0x0008U     /**< Transmit Done Interrupt Flag bit */
+#define DMAIF       0x0020U     /**< DMA Interrupt Flag bit */
+#define PKTIF       0x0040U     /**< RX Packet Pending Interrupt Flag bit */
+#define LINKIF      0x0800U     /**< PHY Link Status Change Interrupt Flag bit */
+#define AESIF       0x1000U     /**< AES Encrypt/Decrypt Interrupt Flag bit */
+#define HASHIF      0x2000U     /**< MD5/SHA-1 Hash Interrupt Flag bit */
+#define MODEXIF     0x4000U     /**< Modular Exponentiation Interrupt Flag bit */
+#define CRYPTEN     0x8000U     /**< Modular Exponentiation and AES Cryptographic Modules Enable bit */
+
+/* ECON1 */
+#define RXEN        0x0001U     /**< Receive Enable bit */
+#define TXRTS       0x0002U     /**< Transmit Request to Send Status/Control bit */
+#define DMANOCS     0x0004U     /**< DMA No Checksum Control bit */
+#define DMACSSD     0x0008U     /**< DMA Checksum Seed Control bit */
+#define DMACPY      0x0010U     /**< DMA Copy Control bit */
+#define DMAST       0x0020U     /**< DMA Start bit */
+#define FCOP0       0x0040U     /**< Flow Control Operation Control/Status bit */
+#define FCOP1       0x0080U     /**< Flow Control Operation Control/Status bit */
+#define PKTDEC      0x0100U     /**< RX Packet Counter Decrement Control bit */
+#define AESOP0      0x0200U     /**< AES Operation Control bit */
+#define AESOP1      0x0400U     /**< AES Operation Control bit */
+#define AESST       0x0800U     /**< AES Encrypt/Decrypt Start bit */
+#define HASHLST     0x1000U     /**< MD5/SHA-1 Hash Last Block Control bit */
+#define HASHOP      0x2000U     /**< MD5/SHA-1 Hash Operation Control bit */
+#define HASHEN      0x4000U     /**< MD5/SHA-1 Hash Enable bit */
+#define MODEXST     0x8000U     /**< Modular Exponentiation Start bit */
+
+/* ERXFCON */
+#define BCEN        0x0001U     /**< Broadcast Collection Filter */
+#define MCEN        0x0002U     /**< Multicast Collection Filter */
+#define NOTMEEN     0x0004U     /**< Not-Me Unicast Collection Filter */
+#define UCEN        0x0008U     /**< Unicast Collection Filter */
+#define RUNTEN      0x0010U     /**< Runt Error Rejection Filter */
+#define RUNTEEN     0x0020U     /**< Runt Error Collection Filter */
+#define CRCEN       0x0040U     /**< CRC Error Rejection Filter */
+#define CRCEEN      0x0080U     /**< CRC Error Collection Filter */
+#define PMEN0       0x0100U     /**< Pattern Match Collection Filter */
+#define PMEN1       0x0200U     /**< Pattern Match Collection Filter */
+#define PMEN2       0x0400U     /**< Pattern Match Collection Filter */
+#define PMEN3       0x0800U     /**< Pattern Match Collection Filter */
+#define NOTPM       0x1000U     /**< Pattern Match Inversion Control */
+#define MPEN        0x4000U     /**< Magic Packet Collection Filter */
+#define HTEN        0x8000U     /**< Hast-Table Collection Filter */
+
+/* MACON1 */
+#define PASSALL     0x0002U     /**< Pass All Received Frames Enable bit */
+#define RXPAUS      0x0004U     /**< Pause Control Frame Reception Enable bit */
+#define LOOPBK      0x0010U     /**< MAC Loopback Enable bit */
+
+/* MACON2 */
+#define FULDPX      0x0001U     /**< MAC Full-Duplex Enable bit */
+#define HFRMEN      0x0004U     /**< Huge Frame Enable bit */
+#define PHDREN      0x0008U     /**< Proprietary Header Enable bit */
+#define TXCRCEN     0x0010U     /**< Transmit CRC Enable bit */
+#define PADCFG0     0x0020U     /**< Automatic Pad and CRC Configuration bit */
+#define PADCFG1     0x0040U     /**< Automatic Pad and CRC Configuration bit */
+#define PADCFG2     0x0080U     /**< Automatic Pad and CRC Configuration bit */
+#define NOBKOFF     0x1000U     /**< No Backoff Enable bit (applies to half duplex only) */
+#define BPEN        0x2000U     /**< No Backoff During Back Pressure Enable bit (applies to half duplex only) */
+#define MACDEFER    0x4000U     /**< Defer Transmission Enable bit (applies to half duplex only) */
+
+/* MACLCON */
+#define MAXRET0     0x0001U     /**< Maximum Retransmissions Control bit (half duplex only) */
+#define MAXRET1     0x0002U     /**< Maximum Retransmissions Control bit (half duplex only) */
+#define MAXRET2     0x0004U     /**< Maximum Retransmissions Control bit (half duplex only) */
+#define MAXRET3     0x0008U     /**< Maximum Retransmissions Control bit (half duplex only) */
+
+/* MICMD */
+#define MIIRD       0x0001U     /**< MII Read Enable bit */
+#define MIISCAN     0x0002U     /**< MII Scan Enable bit */
+
+/* MISTAT */
+#define BUSY        0x0001U     /**< MII Management Busy Status bit */
+#define SCAN        0x0002U     /**< MII Management Scan Status bit */
+#define NVALID      0x0004U     /**< MII Management Read Data Not Valid Status bit */
+
+/* ECON2 */
+#define AESLEN0     0x0001U     /**< AES Key Length Control bit */
+#define AESLEN1     0x0002U     /**< AES Key Length Control bit */
+#define MODLEN0     0x0004U     /**< Modular Exponentiation Length Control bit */
+#define MODLEN1     0x0008U     /**< Modular Exponentiation Length Control bit */
+#define ETHRST      0x0010U     /**< Master Ethernet Reset bit */
+#define RXRST       0x0020U     /**< Receive Logic Reset bit */
+#define TXRST       0x0040U     /**< Transmit Logic Reset bit */
+#define AUTOFC      0x0080U     /**< Automatic Flow Control Enable bit */
+#define COCON0      0x0100U     /**< CLKOUT Frequency Control bit */
+#define COCON1      0x0200U     /**< CLKOUT Frequency Control bit */
+#define COCON2      0x0400U     /**< CLKOUT Frequency Control bit */
+#define COCON3      0x0800U     /**< CLKOUT Frequency Control bit */
+#define SHA1MD5     0x1000U     /**< SHA-1/MD5 Hash Control bit */
+#define TXMAC       0x2000U     /**< Automatically Transmit MAC Address Enable bit */
+#define STRCH       0x4000U     /**< LED Stretching Enable bit */
+#define ETHEN       0x8000U     /**< Ethernet Enable bit */
+
+/* EIE */
+#define PCFULIE     0x0001U     /**< Packet Counter Full Interrupt Enable bit */
+#define RXABTIE     0x0002U     /**< Receive Abort Interrupt Enable bit */
+#define TXABTIE     0x0004U     /**< Transmit Abort Interrupt Enable bit */
+#define TXIE        0x0008U     /**< Transmit Done Interrupt Enable bit */
+#define DMAIE       0x0020U     /**< DMA Interrupt Enable bit */
+#define PKTIE       0x0040U     /**< RX Packet Pending Interrupt Enable bit */
+#define LINKIE      0x0800U     /**< PHY Link Status Change Interrupt Enable bit */
+#define AESIE       0x1000U     /**< AES Encrypt/Decrypt Interrupt Enable bit */
+#define HASHIE      0x2000U     /**< MD5/SHA-1 Hash Interrupt Enable bit */
+#define MODEXIE     0x4000U     /**< Modular Exponentiation Interrupt Enable bit */
+#define INTIE       0x8000U     /**< INT Global Interrupt Enable bit */
+
+/* EIDLED */
+#define REVID0      0x0001U     /**< Silicon Revision ID bit */
+#define REVID1      0x0002U     /**< Silicon Revision ID bit */
+#define REVID2      0x0004U     /**< Silicon Revision ID bit */
+#define REVID3      0x0008U     /**< Silicon Revision ID bit */
+#define REVID4      0x0010U     /**< Silicon Revision ID bit */
+#define DEVIDO      0x0020U     /**< Device ID bit */
+#define DEVID1      0x0040U     /**< Device ID bit */
+#define DEVID2      0x0080U     /**< Device ID bit */
+#define LBCFG0      0x0100U     /**< LEDB Configuration bit */
+#define LBCFG1      0x0200U     /**< LEDB Configuration bit */
+#define LBCFG2      0x0400U     /**< LEDB Configuration bit */
+#define LBCFG3      0x0800U     /**< LEDB Configuration bit */
+#define LACFG0      0x1000U     /**< LEDA Configuration bit */
+#define LACFG1      0x2000U     /**< LEDA Configuration bit */
+#define LACFG2      0x4000U     /**< LEDA Configuration bit */
+#define LACFG3      0x8000U     /**< LEDA Configuration bit */
+
+/* PHCON1 */
+#define PFULDPX     0x0100U     /**< PHY Duplex (applicable only when auto-negotiation is disable) */
+#define RENEG       0x0200U     /**< Restart Auto-Negotiation Control bit */
+#define PSLEEP      0x0800U     /**< PHY Sleep Enable bit */
+#define ANEN        0x1000U     /**< PHY Auto-Negotiation Eanble bit */
+#define SPD100      0x2000U     /**< PHY Speed Select Control bit (applicable only when auto-negotiation is disable) */
+#define PLOOPBK     0x4000U     /**< PHY Loopback Enable bit */
+#define PRST        0x8000U     /**< PHY Reset bit */
+
+/* PHSTAT1 */
+#define EXTREGS     0x0001U     /**< Extended Capabilities Registers Present Status bit */
+#define LLSTAT      0x0004U     /**< Latching Link Status bit */
+#define ANABLE      0x0008U     /**< Auto-Negotiation Ability Status bit */
+#define LRFAULT     0x0010U     /**< Latching Remote Fault Condition Status bit */
+#define ANDONE      0x0020U     /**< Auto-Negotiation Done Status bit */
+#define HALF10      0x0800U     /**< 10Base-T Half-Duplex Ability Status bit */
+#define FULL10      0x1000U     /**< 10Base-T Full-Duplex Ability Status bit */
+#define HALF100     0x2000U     /**< 100Base-TX Half-Duplex Ability Status bit */
+#define FULL100     0x4000U     /**< 100Base-TX Full-Duplex Ability Status bit */
+
+/* PHANA */
+#define ADIEEE0     0x0001U     /**< Advertise IEEE Standard Selector Field bit */
+#define ADIEEE1     0x0002U     /**< Advertise IEEE Standard Selector Field bit */
+#define ADIEEE2     0x0004U     /**< Advertise IEEE Standard Selector Field bit */
+#define ADIEEE3     0x0008U     /**< Advertise IEEE Standard Selector Field bit */
+#define ADIEEE4     0x0010U     /**< Advertise IEEE Standard Selector Field bit */
+#define AD10        0x0020U     /**< Advertise 10Base-T Half-Duplex Ability bit */
+#define AD10FD      0x0040U     /**< Advertise 10Base-T Full-Duplex Ability bit */
+#define AD100       0x0080U     /**< Advertise 100Base-TX Half-Duplex Ability bit */
+#define AD100FD     0x0100U     /**< Advertise 100Base-TX Full-Duplex Ability bit */
+#define ADPAUS0     0x0400U     /**< Advertise PAUSE Flow Control Ability bits */
+#define ADPAUS1     0x0800U     /**< Advertise PAUSE Flow Control Ability bits */
+#define ADFAULT     0x2000U     /**< Advertise Remote Fault Condition bit */
+#define ADNP        0x8000U     /**< Advertise Next Page Ability bit */
+
+/* PHANLPA */
+#define LPIEEE0     0x0001U     /**< Link Partner IEEE Standard Selector Field bit */
+#define LPIEEE1     0x0002U     /**< Link Partner IEEE Standard Selector Field bit */
+#define LPIEEE2     0x0004U     /**< Link Partner IEEE Standard Selector Field bit */
+#define LPIEEE3     0x0008U     /**< Link Partner IEEE Standard Selector Field bit */
+#define LPIEEE4     0x0010U     /**< Link Partner IEEE Standard Selector Field bit */
+#define LP10        0x0020U     /**< Link Partner 10Base-T Half-Duplex Ability bit */
+#define LP10FD      0x0040U     /**< Link Partner 10Base-T Full-Duplex Ability bit */
+#define LP100       0x0080U     /**< Link Partner 100Base-TX Half-Duplex Ability bit */
+#define LP100FD     0x0100U     /**< Link Partner 100Base-TX Full-Duplex Ability bit */
+#define LP100T4     0x0200U     /**< Link Partner 100Base-T4 Ability bit */
+#define LPPAUS0     0x0400U     /**< Link Partner PAUSE Flow Control Ability bit */
+#define LPPAUS1     0x0800U     /**< Link Partner PAUSE Flow Control Ability bit */
+#define LPFAULT     0x2000U     /**< Link Partner Remote Fault Condition bit */
+#define LPACK       0x4000U     /**< Link Partner Acknowledge Local PHY Code Word Status bit */
+#define LPNP        0x8000U     /**< Link Partner Next Page Ability bit */
+
+/* PHANE */
+#define LPANABL     0x0001U     /**< Link Partner Auto-Negotiation Able Status bit */
+#define LPARCD      0x0002U     /**< Link Partner Abilities Received Status bit */
+#define PDFLT       0x0010U     /**< Parallel Detection Fault Status bit */
+
+/* PHCON2 */
+#define EDSTAT      0x0002U     /**< Energy Detect Status bit */
+#define FRCLINK     0x0004U     /**< Force Link Control bit */
+#define EDTHRES     0x0800U     /**< Energy Detect Threshold Control bit */
+#define EDPWRDN     0x2000U     /**< Energy Detect Power-Down Enable bit */
+
+/* PHSTAT2 */
+#define PLRITY      0x0010U     /**< TPIN+/- Polarity Status bit (applies to 10Base-T only) */
+
+/* PHSTAT3 */
+#define SPDDPX0     0x0004U     /**< Current Operating Speed and Duplex Status bit */
+#define SPDDPX1     0x0008U     /**< Current Operating Speed and Duplex Status bit */
+#define SPDDPX2     0x0010U     /**< Current Operating Speed and Duplex Status bit */
+
+/** @} */
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+
+/** 1 to record every SPI transaction of the ENC624J600 HAL, 0 compiles the hooks out */
+#ifndef ENC624J600_TRACE
+#define ENC624J600_TRACE                0
+#endif
+
+/** Ring size in transactions, must be a power of 2 */
+#define ENC624J600_TRACE_RECORDS        128U
+
+/** Longest line enc624j600_trace_read() produces, CR LF and NUL included */
+#define ENC624J600_TRACE_LINE_MAX       (2U + 3U * 9U + 3U)
+
+/**
+ *  @struct enc624j600_trace_record
+ *  @brief One chip select bounded transaction.
+ */
+typedef struct {
+    uint32_t start;             /**< Core timer at chip select assert */
+    uint32_t duration;          /**< Core timer ticks until chip select deassert */
+    uint32_t info;              /**< Opcode (bits 31..24), second byte (23..16), bytes on the bus (15..0) */
+} enc624j600_trace_record;
+
+/**
+ *  @struct enc624j600_trace_reader
+ *  @brief Read cursor into the trace ring.
+ */
+typedef struct {
+    uint32_t next;              /**< Sequence number of the next record to read */
+    uint32_t end;               /**< Sequence number the dump stops at */
+    uint8_t header;             /**< 1 until the header line was read */
+} enc624j600_trace_reader;
+
+#if ENC624J600_TRACE
+#define ENC624J600_TRACE_BEGIN()        enc624j600_trace_begin()
+#define ENC624J600_TRACE_BYTE(data)     enc624j600_trace_byte(data)
+#define ENC624J600_TRACE_END()          enc624j600_trace_end()
+#else
+#define ENC624J600_TRACE_BEGIN()        do { } while (0)
+#define ENC624J600_TRACE_BYTE(data)     do { } while (0)
+#define ENC624J600_TRACE_END()          do { } while (0)
+#endif
+
+/**
+ *  @brief Starts a record, called by the HAL once it holds the bus at chip select assert.
+ *
+ *  The HAL serializes transactions, so the hooks need no locking of their own.
+ */
+extern void enc624j600_trace_begin(void);
+
+/**
+ *  @brief Counts a byte clocked out, the first two are kept as opcode and argument.
+ */
+extern void enc624j600_trace_byte(uint8_t data);
+
+/**
+ *  @brief Commits the record, called by the HAL at chip select deassert before it releases the bus.
+ */
+extern void enc624j600_trace_end(void);
+
+/**
+ *  @brief Starts or stops recording, it runs from power on.
+ */
+extern void enc624j600_trace_enable(uint8_t enable);
+
+/**
+ *  @return 1 while transactions are recorded.
+ */
+extern uint8_t enc624j600_trace_enabled(void);
+
+/**
+ *  @brief Drops every record.
+ */
+extern void enc624j600_trace_clear(void);
+
+/**
+ *  @brief Positions a reader on the oldest record in the ring.
+ *
+ *  Recording should be stopped while the ring is read, a transaction
+ *  committed meanwhile may replace the record being read.
+ */
+extern void enc624j600_trace_reader_init(enc624j600_trace_reader *reader);
+
+/**
+ *  @brief Encodes the next line of a dump.
+ *
+ *  The first line is "#T <core timer Hz>", every record then becomes
+ *  "#S <start> <duration> <info>" in hex. tools/spi_trace_decode.py turns
+ *  a dump into ENC624J600 operations.
+ *
+ *  @param reader Cursor, advanced past the line.
+ *  @param line Receives a NUL terminated line including CR LF, ENC624J600_TRACE_LINE_MAX bytes.
+ *
+ *  @return Line length in bytes, 0 at the end of the dump.
+ */
+extern uint16_t enc624j600_trace_read(enc624j600_trace_reader *reader, char *line);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+/** LED heartbeat toggle interval */
+#define HOUSEKEEPING_HEARTBEAT_MS       500U
+
+/** Link state polling interval */
+#define HOUSEKEEPING_LINK_POLL_MS       1000U
+
+/** CPU load sampling interval, must stay below the 113 s wrap of the run time counter */
+#define HOUSEKEEPING_STATS_MS           1000U
+
+/** Interval of the telnet idle session scan */
+#define HOUSEKEEPING_IDLE_SCAN_MS       10000U
+
+/** Periodic jobs, each one owns a statically allocated software timer */
+#define HOUSEKEEPING_JOB_COUNT          4U
+
+/**
+ *  @brief Creates and starts the periodic jobs on FreeRTOS software timers.
+ *
+ *  @note Call before vTaskStartScheduler(), the timers begin with the scheduler.
+ *
+ *  @return 0 on success, -1 if a timer could not be started.
+ */
+extern int housekeeping_init(void);
+
+/**
+ *  @return Share of CPU time outside the idle task over the last sampling interval, in 0.1 %.
+ */
+extern uint16_t housekeeping_cpu_load(void);
+
+/**
+ *  @return Link state seen by the last poll, 1 for up.
+ */
+extern uint8_t housekeeping_link_up(void);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/** Ring size in records, must be a power of 2 */
+#define LOG_RING_RECORDS                32U
+
+/** Arguments per record, each stored as a raw 32 bit word */
+#define LOG_ARGS_MAX                    6U
+
+/** RAM of the ring: per record the stamp, format, info and argument words */
+#define LOG_RING_BYTES                  (LOG_RING_RECORDS * (3U + LOG_ARGS_MAX) * sizeof(uint32_t))
+
+/** Longest encoded line: "#L" + format, ticks and arguments, 9 characters each, + CR LF NUL */
+#define LOG_LINE_MAX                    (2U + 9U * (2U + LOG_ARGS_MAX) + 3U)
+
+/** Drain records to UART1 from a software timer, 0 leaves reading to the log command */
+#define LOG_DRAIN                       1
+
+#define LOG_DRAIN_INTERVAL_MS           100U
+
+/*
+ *  Format strings live in their own section. The firmware never reads
+ *  them, a record only stores the address, tools/log_decode.py looks the
+ *  string up in the ELF file.
+ */
+#ifdef __XC32
+#define LOG_STRING_SECTION  __attribute__((section(".log_strings"), space(prog), used))
+#else
+#define LOG_STRING_SECTION  __attribute__((section(".log_strings"), used))
+#endif
+
+#define LOG_COUNT_ARGS(...)     LOG_COUNT_ARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_COUNT_ARGS_(_0, _1, _2, _3, _4, _5, _6, count, ...)  count
+
+/**
+ *  @brief Records a log message without formatting it.
+ *
+ *  Costs a ring reservation and one word store per argument, safe from
+ *  tasks and interrupts up to configMAX_SYSCALL_INTERRUPT_PRIORITY. Never
+ *  waits for readers, the oldest record is overwritten.
+ *
+ *  Arguments are stored as 32 bit words: integers, characters and
+ *  pointers. %s is only decoded for constant strings, the host reads
+ *  them from the ELF file as well.
+ *
+ *  @param format printf style format string literal.
+ */
+#define LOG(format, ...)                                                        \
+    do {                                                                        \
+        static const char log_format_[] LOG_STRING_SECTION = format;            \
+        log_record(log_format_, LOG_COUNT_ARGS(__VA_ARGS__), ##__VA_ARGS__);    \
+    } while (0)
+
+/**
+ *  @brief Appends one record, called through LOG().
+ *
+ *  @param format Address of the format string, the record's ID.
+ *  @param count Number of arguments that follow, up to LOG_ARGS_MAX.
+ */
+extern void log_record(const char *format, uint8_t count, ...);
+
+/**
+ *  @struct log_reader
+ *  @brief Read cursor into the shared ring, one per consumer.
+ *
+ *  Readers never hold records back. A reader that falls more than
+ *  LOG_RING_RECORDS behind loses the overwritten records and is told so.
+ */
+typedef struct {
+    uint32_t next;              /**< Sequence number of the next record to read */
+    uint32_t lost;              /**< Overwritten records not reported yet */
+} log_reader;
+
+/**
+ *  @brief Starts the UART drain timer if LOG_DRAIN is set.
+ *
+ *  @return 0 on success, -1 on allocation failure.
+ */
+extern int log_init(void);
+
+/**
+ *  @brief Positions a reader.
+ *
+ *  @param reader Reader to initialize.
+ *  @param oldest 1 to start with the oldest record still in the ring, 0 to see new records only.
+ */
+extern void log_reader_init(log_reader *reader, uint8_t oldest);
+
+/**
+ *  @brief Encodes the next record for the reader.
+ *
+ *  A record becomes "#L <format> <ticks> [<arg> ...]" in hex. After an
+ *  overrun the reader first gets "#D <count> lines dropped".
+ *
+ *  @param reader Cursor, advanced past the record. Must not be shared between tasks.
+ *  @param line Receives a NUL terminated line including CR LF, LOG_LINE_MAX bytes.
+ *
+ *  @return Line length in bytes, 0 when the reader caught up.
+ */
+extern uint16_t log_read(log_reader *reader, char *line);
@@ -34,12 +34,12 @@
 #define MEMP_NUM_PBUF                  4
 #define MEMP_NUM_RAW_PCB               2
 #define MEMP_NUM_UDP_PCB               2
-#define MEMP_NUM_TCP_PCB               2
-#define MEMP_NUM_TCP_PCB_LISTEN        1
+#define MEMP_NUM_TCP_PCB               3   /* telnet sessions + serial bridge, an iperf test takes a free one */
+#define MEMP_NUM_TCP_PCB_LISTEN        3   /* telnet, serial bridge, iperf */
 #define MEMP_NUM_TCP_SEG               4
-#define MEMP_NUM_NETBUF                2
-#define MEMP_NUM_NETCONN               2
-#define MEMP_NUM_SYS_TIMEOUT           4
+#define MEMP_NUM_NETBUF                0   /* raw API only, see LWIP_NETCONN */
+#define MEMP_NUM_NETCONN               0
+#define MEMP_NUM_SYS_TIMEOUT           (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 2)   /* telnet flush, serial bridge resume */
 
 /* ===============================================================
  * Network
@@ -85,7 +85,7 @@
  * APIs (IMPORTANT)
  * =============================================================== */
 #define LWIP_SOCKET                    0   /* sockets are EXPENSIVE */
-#define LWIP_NETCONN                   1
+#define LWIP_NETCONN                   0   /* raw API callbacks, netifapi needs no netconn */
 #define LWIP_RAW                       1
 
 /* ===============================================================
@@ -98,10 +98,45 @@
 /* ===============================================================
  * Statistics & Debug (DISABLE)
  * =============================================================== */
-#define LWIP_STATS                     0
+
+/* 1 counts usage, high-water mark and failures of the heap and the memp pools for the pools command */
+#ifndef LWIP_POOL_STATS
+#define LWIP_POOL_STATS                0
+#endif
+
+#define LWIP_STATS                     LWIP_POOL_STATS
+
+/* opt.h turns every statistic off without LWIP_STATS */
+#if LWIP_POOL_STATS
+#define MEM_STATS                      1
+#define MEMP_STATS                     1
+#define LINK_STATS                     0
+#define ETHARP_STATS                   0
+#define IP_STATS                       0
+#define ICMP_STATS                     0
+#define UDP_STATS                      0
+#define TCP_STATS                      0
+#define SYS_STATS                      0
+#endif
+
 #define LWIP_DEBUG                     0
 #define LWIP_NOASSERT                  1
 
+/* ===============================================================
+ * Hooks
+ * =============================================================== */
+
+/* 1 keeps RTT, retransmit and window figures per telnet session for netstat -v */
+#ifndef TCP_METRICS
+#define TCP_METRICS                    1
+#endif
+
+#if TCP_METRICS
+#define LWIP_HOOK_FILENAME             "network/tcp_metrics.h"
+#define LWIP_HOOK_TCP_INPACKET_PCB(pcb, hdr, optlen, opt1len, opt2, p)  tcp_metrics_segment_in(pcb, hdr)
+#define LWIP_HOOK_TCP_OUT_ADD_TCPOPTS(p, hdr, pcb, opts)                tcp_metrics_segment_out(pcb, hdr, p, opts)
+#endif
+
 /* ===============================================================
  * Checksums
  * =============================================================== */
@@ -121,10 +156,15 @@
 #define DEFAULT_THREAD_STACKSIZE       512
 #define DEFAULT_THREAD_PRIO            2
 
+#define TCPIP_MBOX_SIZE                8   /* messages posted to the tcpip thread */
+
 #define DEFAULT_ACCEPTMBOX_SIZE        2
 #define DEFAULT_TCP_RECVMBOX_SIZE      2
 #define DEFAULT_UDP_RECVMBOX_SIZE      2
 
+/* Threads, mailboxes and semaphores come from static pools, there is no FreeRTOS heap */
+#define LWIP_FREERTOS_STATIC_POOLS     1
+
 #define LWIP_DISABLE_TCP_SANITY_CHECKS 1
 
 #define USE_SLIPIF 0
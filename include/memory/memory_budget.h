@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+/** Data RAM of the PIC32MX460F512L */
+#define MEMORY_BUDGET_RAM_SIZE          32768U
+
+/** Kept free of pools for the startup stack, module state outside the pools and the C library */
+#define MEMORY_BUDGET_RESERVE           4096U
+
+/**
+ *  @struct memory_budget_pool
+ *  @brief One statically allocated pool and the bytes it takes.
+ */
+typedef struct {
+    const char *name;
+    uint32_t bytes;
+} memory_budget_pool;
+
+/**
+ *  @brief Every kernel and lwIP pool and the large module buffers, worked
+ *  out from the same constants the owners size their static buffers with.
+ *  The build fails when the sum exceeds MEMORY_BUDGET_RAM_SIZE -
+ *  MEMORY_BUDGET_RESERVE.
+ */
+extern const memory_budget_pool memory_budget_pools[];
+
+/**
+ *  @return Number of entries in memory_budget_pools.
+ */
+extern uint8_t memory_budget_pool_count(void);
+
+/**
+ *  @return Sum of all pools in bytes.
+ */
+extern uint32_t memory_budget_total(void);
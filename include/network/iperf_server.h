@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lwip/err.h"
+#include "lwip/ip_addr.h"
+#include "lwip/apps/lwiperf.h"
+
+/** TCP port of the server, the iperf2 default */
+#define IPERF_SERVER_PORT               LWIPERF_TCP_PORT_DEFAULT
+
+/** 1 to listen from boot on, 0 waits for iperf start in the shell */
+#define IPERF_SERVER_AT_BOOT            0
+
+/** A test that receives nothing for this long is aborted */
+#define IPERF_SERVER_IDLE_TIMEOUT_MS    10000U
+
+/**
+ *  @struct iperf_server_report
+ *  @brief Outcome of one test.
+ */
+typedef struct {
+    enum lwiperf_report_type type;  /**< LWIPERF_TCP_DONE_SERVER or why it was aborted */
+    ip_addr_t remote_address;
+    uint16_t remote_port;
+    uint32_t bytes;                 /**< Payload received, the iperf2 header included */
+    uint32_t ms;                    /**< Accept to FIN or abort */
+    uint32_t kbit_per_second;
+} iperf_server_report;
+
+/**
+ *  @brief Listens for iperf2 clients on IPERF_SERVER_PORT.
+ *
+ *  One TCP test runs at a time: the server takes what the client sends
+ *  and reports bytes, duration and throughput once the client closes.
+ *  Run "iperf -c <address>" on the peer. The dual and tradeoff modes
+ *  (-d, -r) need a connection back to the client and are not supported.
+ *
+ *  @note Must be called from the tcpip thread.
+ *
+ *  @return ERR_OK when the listener is up or already was, an lwIP error otherwise.
+ */
+extern err_t iperf_server_start(void);
+
+/**
+ *  @brief Stops listening and aborts a running test.
+ *
+ *  @note Must be called from the tcpip thread.
+ */
+extern void iperf_server_stop(void);
+
+/**
+ *  @return 1 while the server listens.
+ */
+extern uint8_t iperf_server_listening(void);
+
+/**
+ *  @brief Reads the progress of the running test.
+ *
+ *  @note Must be called from the tcpip thread.
+ *
+ *  @param report Receives the figures so far, type is left alone.
+ *
+ *  @return 1 if a test runs, 0 otherwise.
+ */
+extern uint8_t iperf_server_progress(iperf_server_report *report);
+
+/**
+ *  @brief Copies the report of the last finished test.
+ *
+ *  @note Must be called from the tcpip thread.
+ *
+ *  @return Number of tests finished since boot, 0 if report was not written.
+ */
+extern uint32_t iperf_server_last_report(iperf_server_report *report);
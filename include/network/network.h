@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/** Static addressing, there is no DHCP client */
+#define NETWORK_DEFAULT_ADDRESS         { 192U, 168U, 1U, 200U }
+#define NETWORK_DEFAULT_NETMASK         { 255U, 255U, 255U, 0U }
+#define NETWORK_DEFAULT_GATEWAY         { 192U, 168U, 1U, 1U }
+
+#define NETWORK_TASK_STACK_SIZE         configMINIMAL_STACK_SIZE
+
+/** Same as the tcpip thread, a burst of frames does not starve the stack processing them */
+#define NETWORK_TASK_PRIORITY           2U
+
+/*
+ *  The INT pin is not wired, so the device is polled. Polling every tick
+ *  keeps a request waiting at most a tick but wakes the CPU out of tickless
+ *  idle every tick too, so the task only does so while traffic is flowing
+ *  and falls back to a longer interval once the link went quiet. The price
+ *  is up to NETWORK_IDLE_POLL_INTERVAL_MS of extra latency for the first
+ *  frame after a pause; wiring INT to an interrupt that notifies the task
+ *  would remove it.
+ */
+
+/** Poll interval while frames arrived within the last NETWORK_IDLE_AFTER_MS */
+#define NETWORK_POLL_INTERVAL_MS        1U
+
+/** Poll interval of an idle device, lets tickless idle sleep between polls */
+#define NETWORK_IDLE_POLL_INTERVAL_MS   10U
+
+/** Time without a received frame after which the device counts as idle */
+#define NETWORK_IDLE_AFTER_MS           100U
+
+/**
+ *  @struct network_config
+ *  @brief Interface settings, addresses in network order as written (192.168.1.200 is { 192, 168, 1, 200 }).
+ */
+typedef struct {
+    uint8_t address[4];
+    uint8_t netmask[4];
+    uint8_t gateway[4];
+    uint8_t *mac_address;       /**< 6-byte custom MAC address or NULL for the factory address */
+} network_config;
+
+/**
+ *  @brief Starts the network task.
+ *
+ *  The task initializes the ENC624J600, waits for the link, adds the
+ *  interface to lwIP as the default netif and then polls the device for
+ *  received frames.
+ *
+ *  @note Call before vTaskStartScheduler(), tcpip_init() may come before or after.
+ *
+ *  @param config Settings, copied.
+ *
+ *  @return 0 on success, -1 if the task could not be created.
+ */
+extern int network_init(const network_config *config);
+
+/**
+ *  @return 1 once the interface is up in lwIP.
+ */
+extern uint8_t network_up(void);
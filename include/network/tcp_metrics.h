@@ -0,0 +1,120 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/prot/tcp.h"
+
+/** Connections watched at once, any pcb may be one of them */
+#define TCP_METRICS_CONNECTIONS         MEMP_NUM_TCP_PCB
+
+/** Buckets per histogram: below 128 us, one per doubling, the last from 2.1 s on */
+#define TCP_METRICS_BUCKETS             16U
+
+/** Upper bound of the first bucket */
+#define TCP_METRICS_FIRST_BUCKET_US     128U
+
+/**
+ *  @struct tcp_metrics_histogram
+ *  @brief Durations on a log2 scale with their extremes.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint16_t buckets[TCP_METRICS_BUCKETS];  /**< Saturate at 0xFFFF */
+} tcp_metrics_histogram;
+
+/**
+ *  @struct tcp_metrics
+ *  @brief Figures of one connection, updated by the lwIP hooks in the tcpip thread.
+ */
+typedef struct {
+    const struct tcp_pcb *pcb;          /**< NULL while detached */
+
+    tcp_metrics_histogram rtt;          /**< Data segment sent to the ACK covering it, retransmitted ones excluded */
+    tcp_metrics_histogram sndbuf_wait;  /**< Output held back because lwIP's send buffer or segment queue was full */
+
+    uint32_t retransmits;               /**< Segments sent again, after a timeout or fast */
+    uint32_t fast_retransmits;          /**< Of those, the ones triggered by duplicate ACKs */
+    uint32_t zero_windows;              /**< Times the peer closed its receive window */
+    uint32_t zero_window_ms;            /**< Time the window stayed closed, a stall still open not included */
+
+    uint32_t rtt_end;                   /**< Sequence number the timed segment ends at */
+    uint32_t rtt_start;                 /**< Core timer when the timed segment left */
+    uint32_t wait_start;                /**< Core timer when the current sndbuf wait began */
+    u32_t wait_start_ms;                /**< sys_now() of the same, for waits the core timer wraps in */
+    u32_t zero_window_start;            /**< sys_now() when the window closed */
+
+    uint8_t rtt_timing : 1;
+    uint8_t waiting : 1;
+    uint8_t zero_window : 1;
+} tcp_metrics;
+
+/**
+ *  @brief Starts collecting figures for a connection, from zero.
+ *
+ *  RTT is timed like lwIP does, one segment at a time and never across a
+ *  retransmission, but on the core timer instead of 500 ms ticks.
+ *
+ *  @note Must be called from the tcpip thread.
+ *
+ *  @param metrics Figures, owned by the caller until tcp_metrics_detach().
+ *  @param pcb Connection.
+ */
+extern void tcp_metrics_attach(tcp_metrics *metrics, const struct tcp_pcb *pcb);
+
+/**
+ *  @brief Stops collecting, the figures stay readable.
+ *
+ *  @note Must be called from the tcpip thread before the pcb is reused.
+ */
+extern void tcp_metrics_detach(tcp_metrics *metrics);
+
+/**
+ *  @brief Clears the figures of every attached connection, measurements under way restart.
+ *
+ *  @note Must be called from the tcpip thread.
+ */
+extern void tcp_metrics_reset(void);
+
+/**
+ *  @return Figures attached to pcb, NULL if there are none.
+ */
+extern tcp_metrics *tcp_metrics_find(const struct tcp_pcb *pcb);
+
+/**
+ *  @brief Reports whether output for pcb is held back by tcp_sndbuf() or the segment queue.
+ *
+ *  Called after every flush of an output path, a wait lasts from the
+ *  first call with 1 to the next call with 0.
+ *
+ *  @param pcb Connection, ignored when no figures are attached.
+ *  @param waiting 1 while output is pending that lwIP did not take.
+ */
+extern void tcp_metrics_sndbuf_wait(const struct tcp_pcb *pcb, uint8_t waiting);
+
+/**
+ *  @brief Lower bound of a histogram bucket.
+ *
+ *  @return Microseconds, 0 for the first bucket.
+ */
+extern uint32_t tcp_metrics_bucket_floor_us(uint8_t bucket);
+
+/**
+ *  @brief LWIP_HOOK_TCP_INPACKET_PCB: takes RTT samples from ACKs and watches the peer's window.
+ *
+ *  @return ERR_OK, the segment is never dropped.
+ */
+extern err_t tcp_metrics_segment_in(const struct tcp_pcb *pcb, const struct tcp_hdr *hdr);
+
+/**
+ *  @brief LWIP_HOOK_TCP_OUT_ADD_TCPOPTS: counts retransmissions and times new data.
+ *
+ *  @return opts, no options are added.
+ */
+extern u32_t *tcp_metrics_segment_out(const struct tcp_pcb *pcb, const struct tcp_hdr *hdr, const struct pbuf *p,
+        u32_t *opts);
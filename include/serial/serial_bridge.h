@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "lwip/err.h"
+
+/** TCP port of the bridge, the customary RFC 2217 port */
+#define SERIAL_BRIDGE_PORT              2217U
+
+/** Ring between the pump task and the tcpip thread, must be a power of 2 */
+#define SERIAL_BRIDGE_RING_SIZE         512U
+
+#define SERIAL_BRIDGE_PUMP_STACK_SIZE   configMINIMAL_STACK_SIZE
+
+/** Above the tcpip thread, received bytes reach the network without delay */
+#define SERIAL_BRIDGE_PUMP_PRIORITY     3U
+
+/** Line settings restored when the client disconnects, matches main() */
+#define SERIAL_BRIDGE_DEFAULT_BAUD      9600U
+
+/**
+ *  @brief Starts the pump task and listens for a bridge client.
+ *
+ *  One client at a time gets a transparent byte stream to UART1. RFC 2217
+ *  (COM-PORT-OPTION) lets it change baud rate, parity and stop bits.
+ *
+ *  @note Must be called from the tcpip thread (e.g. the tcpip_init() callback).
+ *
+ *  @return ERR_OK when the listener is up, an lwIP error otherwise.
+ */
+extern err_t serial_bridge_init(void);
+
+/**
+ *  @brief Tells whether a client owns UART1.
+ *
+ *  @return 1 while a client is connected, printf output is dropped then.
+ */
+extern uint8_t serial_bridge_connected(void);
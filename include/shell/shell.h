@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "telnet/telnet_server.h"
+
+/** Maximum number of words in a command line, including the command */
+#define SHELL_ARGS_MAX                  10U
+
+/** Output space for commands that print one line at most, also for error messages */
+#define SHELL_OUTPUT_LINE               TELNET_OUTPUT_PRINTF_MAX
+
+/** Output space for commands that print listings, they get the whole ring */
+#define SHELL_OUTPUT_RING               TELNET_OUTPUT_BUFFER_SIZE
+
+typedef void (*shell_handler)(telnet_session *session, int argc, char *argv[]);
+
+/**
+ *  @enum shell_mode
+ *  @brief Where a command handler runs.
+ */
+typedef enum {
+    SHELL_FAST = 0,             /**< Inline in the tcpip thread, must not block */
+    SHELL_SLOW                  /**< In the worker pool, may block or spin; must not close the session */
+} shell_mode;
+
+/**
+ *  @struct shell_command
+ *  @brief Command descriptor, one per SHELL_COMMAND() entry. Lives in flash.
+ */
+typedef struct {
+    const char *name;
+    shell_handler handler;
+    shell_mode mode;
+    uint16_t output;            /**< Free output space required before the line runs */
+    uint8_t min_args;           /**< Minimum number of arguments after the command word */
+    uint8_t max_args;           /**< Maximum number of arguments after the command word */
+    const char *usage;
+    const char *help;
+} shell_command;
+
+// prototypes of all registered handlers
+#define SHELL_COMMAND(name, handler, mode, output, min_args, max_args, usage, help) \
+    extern void handler(telnet_session *session, int argc, char *argv[]);
+#include "shell/shell_commands.def"
+#undef SHELL_COMMAND
+
+/**
+ *  @brief Tokenizes and runs one command line.
+ *
+ *  Matches the telnet_line_handler signature, so it can be passed to
+ *  telnet_server_init() directly.
+ *
+ *  @param session Session the line was received on, receives the output.
+ *  @param line NUL terminated line, modified in place by the tokenizer.
+ *  @param length Line length in bytes.
+ */
+extern void shell_execute(telnet_session *session, char *line, uint16_t length);
+
+/**
+ *  @brief Tells how much free output space a line needs before it runs.
+ *
+ *  Matches the telnet_line_reserve signature. A SHELL_FAST handler cannot
+ *  wait for the peer to acknowledge output, so the server holds the line
+ *  until the command's declared output fits.
+ *
+ *  @param line NUL terminated line, not modified.
+ *
+ *  @return Bytes of output ring space, SHELL_OUTPUT_LINE for unknown commands.
+ */
+extern uint16_t shell_output_reserve(const char *line);
+
+/**
+ *  @brief Looks up a command by name using the generated perfect hash.
+ *
+ *  @param name Command word.
+ *
+ *  @return Command descriptor or NULL if no such command is registered.
+ */
+extern const shell_command *shell_find(const char *name);
+
+/**
+ *  @brief Gives access to the command table, e.g. for help.
+ *
+ *  @param index Command index, 0 up to shell_command_count() - 1.
+ *
+ *  @return Command descriptor or NULL if index is out of range.
+ */
+extern const shell_command *shell_command_at(uint8_t index);
+
+extern uint8_t shell_command_count(void);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "telnet/telnet_server.h"
+
+/**
+ *  @struct chargen_stream
+ *  @brief State of one session running chargen, one per session. Only used
+ *  inside shell_chargen.c.
+ */
+typedef struct {
+    telnet_session *session;
+    uint32_t remaining;         /**< Bytes still to send, 0 runs until ^C */
+    uint8_t unlimited;
+    uint8_t line;               /**< First character of the next line */
+} chargen_stream;
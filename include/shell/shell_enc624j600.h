@@ -0,0 +1,10 @@
+#pragma once
+
+/**
+ *  @brief Creates the lock serializing the MII sequences of phy commands.
+ *
+ *  Called by shell_worker_init(), the workers run phy in parallel.
+ *
+ *  @return 0 on success, -1 if the lock could not be created.
+ */
+extern int shell_enc624j600_init(void);
@@ -0,0 +1,35 @@
+#pragma once
+
+/*
+ *  Generated by tools/shell_hash_gen.py from shell_commands.def, do not edit.
+ *
+ *  Commands: help echo exit phy spitrace log top mem pools netstat iperf chargen
+ */
+
+#define SHELL_HASH_SEED         0x00000039U
+#define SHELL_HASH_SLOTS        32U
+#define SHELL_HASH_COMMANDS     12U
+#define SHELL_HASH_NAME_MAX     8U
+#define SHELL_HASH_EMPTY        0xFFU
+
+/** Position of every command in shell_commands.def, checked against it at compile time */
+#define SHELL_HASH_INDEX_help      0U
+#define SHELL_HASH_INDEX_echo      1U
+#define SHELL_HASH_INDEX_exit      2U
+#define SHELL_HASH_INDEX_phy       3U
+#define SHELL_HASH_INDEX_spitrace  4U
+#define SHELL_HASH_INDEX_log       5U
+#define SHELL_HASH_INDEX_top       6U
+#define SHELL_HASH_INDEX_mem       7U
+#define SHELL_HASH_INDEX_pools     8U
+#define SHELL_HASH_INDEX_netstat   9U
+#define SHELL_HASH_INDEX_iperf     10U
+#define SHELL_HASH_INDEX_chargen   11U
+
+/** Command index for every hash slot, SHELL_HASH_EMPTY when unused */
+#define SHELL_HASH_TABLE { \
+    0xFFU, 0x05U, 0xFFU, 0x08U, 0xFFU, 0xFFU, 0xFFU, 0x03U, \
+    0xFFU, 0xFFU, 0x09U, 0xFFU, 0xFFU, 0xFFU, 0x0BU, 0xFFU, \
+    0x04U, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0x0AU, \
+    0x02U, 0x07U, 0xFFU, 0xFFU, 0x00U, 0x01U, 0x06U, 0xFFU \
+}
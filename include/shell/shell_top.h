@@ -0,0 +1,43 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "telnet/telnet_server.h"
+#include "telnet/telnet_screen.h"
+
+/** Refresh interval of the live view */
+#define TOP_INTERVAL_MS     1000U
+
+/** Tasks shown, uxTaskGetSystemState() fails if more exist */
+#define TOP_TASKS_MAX       (TELNET_SCREEN_ROWS - 3U)
+
+typedef struct {
+    UBaseType_t number;         /**< xTaskNumber, stable for the life of the task */
+    configRUN_TIME_COUNTER_TYPE counter;
+} top_sample;
+
+/**
+ *  @struct top_view
+ *  @brief State of one session following top, one per session. Only used
+ *  inside shell_top.c.
+ */
+typedef struct {
+    telnet_session *session;
+    telnet_screen screen;       /**< Shows top_monitor.shown while valid */
+} top_view;
+
+/**
+ *  @struct top_monitor
+ *  @brief Sample and frames shared by all views, every view shows the same
+ *  frame. Only used inside shell_top.c.
+ */
+typedef struct {
+    TickType_t refreshed;       /**< Tick count of the last frame */
+    configRUN_TIME_COUNTER_TYPE total;
+    uint8_t count;              /**< Valid entries in previous, 0 before the first frame */
+    uint8_t composed;           /**< shown holds a frame */
+    top_sample previous[TOP_TASKS_MAX];
+    TaskStatus_t tasks[TOP_TASKS_MAX];
+    telnet_screen_frame frame;  /**< Frame being composed */
+    telnet_screen_frame shown;  /**< Last frame, what every valid view's terminal shows */
+} top_monitor;
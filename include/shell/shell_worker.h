@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "shell/shell.h"
+
+/** Number of worker tasks running slow commands, one per session so a stalled client only blocks its own */
+#define SHELL_WORKER_COUNT              TELNET_MAX_SESSIONS
+
+/**
+ *  Slow commands accepted but not finished yet, over all sessions. A
+ *  session stays detached until its job finished, so it never has more
+ *  than one.
+ */
+#define SHELL_WORKER_QUEUE_DEPTH        TELNET_MAX_SESSIONS
+
+#define SHELL_WORKER_STACK_SIZE         (configMINIMAL_STACK_SIZE + 160U)
+
+#define SHELL_WORKER_PRIORITY           1U
+
+/** Output collected by a worker before it is posted to the tcpip thread */
+#define SHELL_WORKER_OUTPUT_SIZE        128U
+
+/**
+ *  @struct shell_job
+ *  @brief A slow command line and the output on its way back, one of
+ *  SHELL_WORKER_QUEUE_DEPTH slots. Only used inside shell_worker.c.
+ */
+typedef struct {
+    telnet_session *session;
+    const shell_command *command;
+    int argc;
+    char *argv[SHELL_ARGS_MAX];
+    char line[TELNET_LINE_MAX + 1U];
+
+    TaskHandle_t worker;        /**< Task running the job, notified when a chunk was delivered */
+    uint8_t output[SHELL_WORKER_OUTPUT_SIZE];
+    uint16_t output_length;
+
+    uint8_t in_use : 1;
+} shell_job;
+
+/**
+ *  @brief Creates the job queue, the worker tasks and the locks of the
+ *  commands they run.
+ *
+ *  @note Must be called before the telnet server accepts connections.
+ *
+ *  @return 0 on success, -1 if the tasks or the queue could not be created.
+ */
+extern int shell_worker_init(void);
+
+/**
+ *  @brief Queues a slow command for the worker pool and detaches the session.
+ *
+ *  The line is copied, argv may point into the caller's buffer. Output the
+ *  handler writes through the telnet_session_* functions is posted back to
+ *  the session in order, the prompt follows when the handler returned.
+ *
+ *  @note Must be called from the tcpip thread.
+ *
+ *  @return 0 if the job was queued, -1 if all job slots are taken.
+ */
+extern int shell_worker_submit(telnet_session *session, const shell_command *command, int argc, char *argv[]);
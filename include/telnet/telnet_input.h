@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "telnet/telnet_output.h"
+
+/** Longest input line in bytes, without the terminating NUL */
+#define TELNET_LINE_MAX                 80U
+
+/** Longest subnegotiation that is parsed, longer ones are truncated */
+#define TELNET_SUBNEGOTIATION_MAX       64U
+
+/** Highest supported SLC function code (SLC_FORW2) */
+#define TELNET_SLC_COUNT                18U
+
+typedef enum {
+    TELNET_INPUT_DATA,
+    TELNET_INPUT_IAC,
+    TELNET_INPUT_OPTION,
+    TELNET_INPUT_SUBNEGOTIATION,
+    TELNET_INPUT_SUBNEGOTIATION_IAC
+} telnet_input_state;
+
+/**
+ *  @enum telnet_edit_mode
+ *  @brief Side of the connection that edits input lines.
+ */
+typedef enum {
+    TELNET_EDIT_NEGOTIATING = 0,    /**< DO LINEMODE sent, no answer yet */
+    TELNET_EDIT_CLIENT,             /**< LINEMODE EDIT, client sends whole lines */
+    TELNET_EDIT_SERVER              /**< Client refused LINEMODE, server echoes and edits */
+} telnet_edit_mode;
+
+/**
+ *  @enum telnet_input_result
+ *  @brief Returned values by telnet_input_process().
+ */
+typedef enum {
+    TELNET_INPUT_NONE = 0,          /**< Byte consumed, nothing to do */
+    TELNET_INPUT_LINE,              /**< A complete line is in telnet_input.line */
+    TELNET_INPUT_CANCEL             /**< Line discarded by interrupt (^C or IAC IP) */
+} telnet_input_result;
+
+/**
+ *  @struct telnet_input
+ *  @brief Telnet protocol parser and line editor of one session.
+ */
+typedef struct {
+    telnet_input_state state;
+    telnet_edit_mode edit_mode;
+
+    uint8_t echo : 1;               /**< Server echoes input (WILL ECHO) */
+    uint8_t last_byte_cr : 1;       /**< Previous data byte was CR, a following LF is not a new line */
+
+    uint8_t verb;                   /**< WILL/WONT/DO/DONT waiting for its option byte */
+    uint8_t mode;                   /**< LINEMODE MODE mask acknowledged by the client */
+
+    uint8_t slc[TELNET_SLC_COUNT + 1U];     /**< Special characters, indexed by SLC function */
+
+    uint8_t subnegotiation[TELNET_SUBNEGOTIATION_MAX];
+    uint8_t subnegotiation_length;
+
+    char line[TELNET_LINE_MAX + 1U];
+    uint16_t line_length;
+} telnet_input;
+
+/**
+ *  @brief Resets the parser and starts LINEMODE negotiation.
+ *
+ *  Queues IAC DO LINEMODE into the output. Should the client refuse, the
+ *  session falls back to character mode with a server side line editor.
+ *
+ *  @param input Parser state.
+ *  @param output Output ring of the same session, used for replies and echo.
+ */
+extern void telnet_input_init(telnet_input *input, telnet_output *output);
+
+/**
+ *  @brief Feeds one received byte to the parser.
+ *
+ *  Negotiation replies and echo are written to the output but not
+ *  flushed, the caller flushes once per received segment.
+ *
+ *  @param input Parser state.
+ *  @param output Output ring of the same session.
+ *  @param byte Received byte.
+ *
+ *  @return telnet_input_result
+ *      See @ref telnet_input_result for possible return values.
+ */
+extern telnet_input_result telnet_input_process(telnet_input *input, telnet_output *output, uint8_t byte);
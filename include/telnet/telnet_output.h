@@ -0,0 +1,170 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "lwip/tcp.h"
+
+/**
+ *  Size of the per-session output ring in bytes. Must be a power of two.
+ *
+ *  The ring holds both bytes that are still waiting to be handed to lwIP
+ *  and bytes that are queued in lwIP but not acknowledged yet, because
+ *  they are passed to tcp_write() without TCP_WRITE_FLAG_COPY.
+ */
+#define TELNET_OUTPUT_BUFFER_SIZE       1024U
+
+/** Longest single telnet_output_printf() expansion in bytes */
+#define TELNET_OUTPUT_PRINTF_MAX        128U
+
+/** Number of constant data references that can be queued per session */
+#define TELNET_OUTPUT_REFERENCES        4U
+
+/**
+ *  Constant data shorter than this is copied into the ring instead of
+ *  being referenced, each reference costs lwIP a MEMP_PBUF and a slot in
+ *  the segment queue.
+ */
+#define TELNET_OUTPUT_REFERENCE_MIN     32U
+
+/**
+ *  @struct telnet_output_reference
+ *  @brief Constant data sent in place from flash.
+ */
+typedef struct {
+    const uint8_t *data;
+    uint16_t length;
+    uint16_t position;      /**< Ring index the data is inserted before */
+    uint16_t queued;        /**< Bytes passed to tcp_write() */
+    uint16_t acked;         /**< Bytes acknowledged by the peer */
+} telnet_output_reference;
+
+/**
+ *  @struct telnet_output
+ *  @brief Per-session output coalescing ring.
+ *
+ *  Small writes are gathered in the ring and handed to lwIP in chunks of
+ *  a full MSS, on an explicit flush (prompt boundary) or when the flush
+ *  timer expires. A tail that cannot grow to a full MSS before the peer
+ *  acknowledges, because the ring is full, is never held. Ring space is released only when the peer acknowledges
+ *  the data (tcp_sent callback), so no copy into the lwIP heap is needed.
+ *
+ *  Indexes are free-running and masked on access:
+ *      acked <= queued <= head
+ *
+ *  Constant data (banners, help text) is not copied at all. It is queued
+ *  as a reference at the current ring position and written from flash
+ *  with tcp_write() when the stream reaches that position.
+ *
+ *  @note All functions must be called from the tcpip thread.
+ */
+typedef struct {
+    struct tcp_pcb *pcb;
+
+    uint16_t acked;         /**< Oldest byte not yet acknowledged by the peer */
+    uint16_t queued;        /**< Oldest byte not yet passed to tcp_write() */
+    uint16_t head;          /**< Next free byte */
+
+    telnet_output_reference references[TELNET_OUTPUT_REFERENCES];
+    uint8_t reference_first;    /**< Oldest queued reference */
+    uint8_t reference_count;
+
+    uint16_t dropped;       /**< Bytes refused for lack of ring space, see telnet_output_take_dropped() */
+
+    uint8_t buffer[TELNET_OUTPUT_BUFFER_SIZE];
+} telnet_output;
+
+/**
+ *  @brief Binds an output ring to a connection and empties it.
+ *
+ *  @param output Output ring.
+ *  @param pcb Connection the ring will be flushed to.
+ */
+extern void telnet_output_init(telnet_output *output, struct tcp_pcb *pcb);
+
+/**
+ *  @brief Copies data into the output ring.
+ *
+ *  Full MSS sized chunks are handed to lwIP right away, the remainder
+ *  waits for more data, a flush or the flush timer.
+ *
+ *  @param output Output ring.
+ *  @param data Bytes to be sent.
+ *  @param length Number of bytes.
+ *
+ *  @return Number of bytes accepted. Less than length when the ring is
+ *          full, the rest is counted in telnet_output_take_dropped().
+ */
+extern uint16_t telnet_output_write(telnet_output *output, const void *data, uint16_t length);
+
+/**
+ *  @brief Queues constant data without copying it.
+ *
+ *  The data is handed to lwIP by reference, so it must stay valid and
+ *  unchanged until acknowledged, which holds for const data in flash.
+ *  Short data that fits into the ring, or data arriving while all
+ *  references are in use, is copied into the ring instead.
+ *
+ *  @param output Output ring.
+ *  @param data Constant bytes to be sent.
+ *  @param length Number of bytes.
+ *
+ *  @return Number of bytes accepted.
+ */
+extern uint16_t telnet_output_write_static(telnet_output *output, const void *data, uint16_t length);
+
+/**
+ *  @brief Formats a string into the output ring.
+ *
+ *  The expansion is truncated to TELNET_OUTPUT_PRINTF_MAX bytes.
+ *
+ *  @return Number of bytes accepted.
+ */
+extern uint16_t telnet_output_printf(telnet_output *output, const char *format, ...);
+
+extern uint16_t telnet_output_vprintf(telnet_output *output, const char *format, va_list args);
+
+/**
+ *  @brief Hands pending bytes to lwIP.
+ *
+ *  Writes are limited by tcp_sndbuf() and by the segment queue length, so
+ *  the flush never fails because lwIP is out of buffers. Every chunk
+ *  except the last one is written with TCP_WRITE_FLAG_MORE so PSH is set
+ *  only at the end of the burst.
+ *
+ *  @param output Output ring.
+ *  @param push 1 to send a partial MSS as well (prompt boundary, timer),
+ *              0 to send full MSS chunks only, and a partial one only
+ *              when the free ring space cannot complete it.
+ */
+extern void telnet_output_flush(telnet_output *output, uint8_t push);
+
+/**
+ *  @brief Releases acknowledged bytes. Called from the tcp_sent callback.
+ *
+ *  @param output Output ring.
+ *  @param length Number of bytes acknowledged by the peer.
+ */
+extern void telnet_output_acknowledged(telnet_output *output, uint16_t length);
+
+/**
+ *  @brief Reports output lost to a full ring since the last call.
+ *
+ *  @return Number of bytes telnet_output_write() refused, the count restarts at 0.
+ */
+extern uint16_t telnet_output_take_dropped(telnet_output *output);
+
+/**
+ *  @return Number of bytes that can be written into the ring.
+ */
+extern uint16_t telnet_output_free_space(const telnet_output *output);
+
+/**
+ *  @return Number of bytes, copied or referenced, not yet passed to lwIP.
+ */
+extern uint16_t telnet_output_pending(const telnet_output *output);
+
+/**
+ *  @return Number of bytes, copied or referenced, passed to lwIP but not yet acknowledged.
+ */
+extern uint16_t telnet_output_unacknowledged(const telnet_output *output);
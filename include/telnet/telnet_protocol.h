@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ *  @defgroup Telnet_Commands Telnet commands (RFC 854)
+ *  @{
+ */
+
+#define TELNET_SE       240U    /**< End of subnegotiation parameters */
+#define TELNET_IP       244U    /**< Interrupt process */
+#define TELNET_SB       250U    /**< Subnegotiation of the indicated option follows */
+#define TELNET_WILL     251U    /**< Sender wants to enable an option */
+#define TELNET_WONT     252U    /**< Sender refuses to enable an option */
+#define TELNET_DO       253U    /**< Sender wants the receiver to enable an option */
+#define TELNET_DONT     254U    /**< Sender wants the receiver to disable an option */
+#define TELNET_IAC      255U    /**< Interpret as command */
+
+/** @} */
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "telnet/telnet_server.h"
+
+/** Width of a screen view in characters */
+#define TELNET_SCREEN_COLUMNS           40U
+
+/** Height of a screen view in lines */
+#define TELNET_SCREEN_ROWS              16U
+
+/**
+ *  Output of the most expensive update: clear, every row positioned and
+ *  rewritten, cursor parked below the view. Callers check the free output
+ *  space against it, an update is never split.
+ */
+#define TELNET_SCREEN_RENDER_MAX        (7U + TELNET_SCREEN_ROWS * (TELNET_SCREEN_COLUMNS + 8U) + 8U)
+
+/**
+ *  @struct telnet_screen_frame
+ *  @brief Contents of a view being composed. Not NUL terminated, blank cells are spaces.
+ */
+typedef struct {
+    char cells[TELNET_SCREEN_ROWS][TELNET_SCREEN_COLUMNS];
+} telnet_screen_frame;
+
+/**
+ *  @struct telnet_screen
+ *  @brief State of the peer's terminal, one per session and live view. The
+ *  contents are the frame of the last update, which the caller keeps, so
+ *  views showing the same frame share it.
+ */
+typedef struct {
+    uint8_t cursor_row;
+    uint8_t cursor_column;
+    uint8_t valid : 1;          /**< The terminal shows the last frame, 0 repaints everything */
+    uint8_t cursor_known : 1;   /**< cursor_row and cursor_column are where the terminal's cursor is */
+} telnet_screen;
+
+/**
+ *  @brief Forgets the terminal contents, the next update clears and repaints.
+ */
+extern void telnet_screen_init(telnet_screen *screen);
+
+/**
+ *  @brief Blanks a frame before composing it.
+ */
+extern void telnet_screen_frame_clear(telnet_screen_frame *frame);
+
+/**
+ *  @brief Formats one row of a frame, the text is cut at the right edge.
+ *
+ *  @param frame Frame being composed.
+ *  @param row Row, 0 up to TELNET_SCREEN_ROWS - 1.
+ *  @param format printf style format string.
+ */
+extern void telnet_screen_frame_printf(telnet_screen_frame *frame, uint8_t row, const char *format, ...);
+
+/**
+ *  @brief Brings the terminal from what it shows to the frame.
+ *
+ *  Only changed cells are written. Runs separated by a few unchanged
+ *  cells are merged, since rewriting them is cheaper than a cursor move,
+ *  and cleared row ends are erased with EL instead of spaces. The caller
+ *  keeps the frame as the next update's shown.
+ *
+ *  @note Must be called from the tcpip thread with TELNET_SCREEN_RENDER_MAX bytes of output space.
+ *
+ *  @param screen Terminal state of the session, updated to the frame.
+ *  @param shown Frame of the last update, not read while the screen is invalid.
+ *  @param frame New contents.
+ *  @param session Receives the escape sequences and text.
+ *
+ *  @return Number of bytes written.
+ */
+extern uint16_t telnet_screen_update(telnet_screen *screen, const telnet_screen_frame *shown,
+        const telnet_screen_frame *frame, telnet_session *session);
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lwip/tcp.h"
+#include "network/tcp_metrics.h"
+#include "telnet/telnet_input.h"
+#include "telnet/telnet_output.h"
+
+#define TELNET_SERVER_PORT              23U
+
+/** Number of concurrent sessions, one TCP PCB each, one PCB is left for the serial bridge */
+#define TELNET_MAX_SESSIONS             (MEMP_NUM_TCP_PCB - 1)
+
+/**
+ *  Interval of the flush timer for partial segments. While a pump or a
+ *  detached line is producing, a partial segment waits for the first
+ *  timer run that found no new output.
+ */
+#define TELNET_FLUSH_INTERVAL_MS        20U
+
+/** Complete lines parsed ahead of execution per session */
+#define TELNET_PIPELINE_DEPTH           4U
+
+/** Sessions without input for this long are closed, following sessions are exempt */
+#define TELNET_IDLE_TIMEOUT_MS          600000U
+
+/**
+ *  Free output space required before the next queued line is executed,
+ *  for servers without a telnet_line_reserve. A line handler runs to
+ *  completion in the tcpip thread and cannot wait for acknowledgements,
+ *  so it gets the whole ring.
+ */
+#define TELNET_PIPELINE_OUTPUT_RESERVE  TELNET_OUTPUT_BUFFER_SIZE
+
+/**
+ *  @brief Receives the output of a detached session.
+ *
+ *  @param context Pointer given to telnet_session_detach().
+ *  @param data Output bytes.
+ *  @param length Number of bytes.
+ *
+ *  @return Number of bytes accepted.
+ */
+typedef uint16_t (*telnet_session_sink)(void *context, const void *data, uint16_t length);
+
+struct telnet_session;
+
+/**
+ *  @brief Fills the output of a following session from a shared source.
+ *
+ *  Called in the tcpip thread after the peer acknowledged output and every
+ *  TELNET_FLUSH_INTERVAL_MS. Writes only what fits into the output ring,
+ *  the rest stays with the source until the next call.
+ *
+ *  @param session Following session.
+ *  @param context Pointer given to telnet_session_follow().
+ *
+ *  @return 1 to keep following, 0 when done.
+ */
+typedef uint8_t (*telnet_session_pump)(struct telnet_session *session, void *context);
+
+/**
+ *  @struct telnet_session
+ *  @brief State of one telnet connection.
+ */
+typedef struct telnet_session {
+    struct tcp_pcb *pcb;
+
+    uint8_t in_use : 1;         /**< Slot is taken by a connection */
+    uint8_t closing : 1;        /**< Close requested, waiting for output to be acknowledged */
+    uint8_t peer_closed : 1;    /**< FIN received, close once the queued lines ran */
+    uint8_t detached : 1;       /**< A line is executed outside the tcpip thread */
+    uint8_t produced : 1;       /**< Output was written since the last flush timer run */
+
+    telnet_session_sink sink;   /**< Output of the detached line, NULL when attached */
+    void *sink_context;
+
+    telnet_session_pump pump;   /**< Source of a following session, NULL otherwise */
+    void *pump_context;
+
+    struct pbuf *received;      /**< Received data not parsed yet, held while the line queue is full */
+    u32_t last_input;           /**< sys_now() of the last received segment */
+
+    char lines[TELNET_PIPELINE_DEPTH][TELNET_LINE_MAX + 1U];    /**< Parsed lines waiting for execution */
+    uint8_t line_first;         /**< Oldest queued line */
+    uint8_t line_count;
+
+    telnet_input input;
+    telnet_output output;
+
+    tcp_metrics metrics;        /**< RTT, retransmits and stalls of the connection, see netstat -v */
+} telnet_session;
+
+/**
+ *  @brief Called for every complete input line.
+ *
+ *  @param session Session the line was received on.
+ *  @param line NUL terminated line without the line terminator.
+ *  @param length Line length in bytes.
+ */
+typedef void (*telnet_line_handler)(telnet_session *session, char *line, uint16_t length);
+
+/**
+ *  @brief Tells how much free output space a line needs before its handler runs.
+ *
+ *  Lines wait in the queue until that much of the output ring is free,
+ *  at most TELNET_OUTPUT_BUFFER_SIZE. Short responses keep pipelining,
+ *  long ones wait for the previous output to be acknowledged.
+ *
+ *  @param line NUL terminated line, must not be modified.
+ *
+ *  @return Bytes of output ring space.
+ */
+typedef uint16_t (*telnet_line_reserve)(const char *line);
+
+/**
+ *  @brief Starts listening for telnet connections.
+ *
+ *  @note Must be called from the tcpip thread (e.g. the tcpip_init() callback).
+ *
+ *  @param handler Function invoked for each received line.
+ *  @param reserve Output space each line needs, NULL for TELNET_PIPELINE_OUTPUT_RESERVE.
+ *
+ *  @return ERR_OK when the listener is up, an lwIP error otherwise.
+ */
+extern err_t telnet_server_init(telnet_line_handler handler, telnet_line_reserve reserve);
+
+/**
+ *  @brief Closes sessions that received nothing for TELNET_IDLE_TIMEOUT_MS.
+ *
+ *  @note Must be called from the tcpip thread, e.g. through tcpip_try_callback().
+ *
+ *  @param arg Unused, matches tcpip_callback_fn.
+ */
+extern void telnet_server_close_idle(void *arg);
+
+/**
+ *  @brief Queues bytes for the session and arms the flush timer.
+ *
+ *  @return Number of bytes accepted.
+ */
+extern uint16_t telnet_session_write(telnet_session *session, const void *data, uint16_t length);
+
+/**
+ *  @brief Queues constant data (banners, help text) for the session without copying it.
+ *
+ *  @see telnet_output_write_static()
+ *
+ *  @return Number of bytes accepted.
+ */
+extern uint16_t telnet_session_write_static(telnet_session *session, const void *data, uint16_t length);
+
+/**
+ *  @brief Formats into the session output and arms the flush timer.
+ *
+ *  @return Number of bytes accepted.
+ */
+extern uint16_t telnet_session_printf(telnet_session *session, const char *format, ...);
+
+/**
+ *  @brief Pushes all buffered output, e.g. after the prompt.
+ */
+extern void telnet_session_flush(telnet_session *session);
+
+/**
+ *  @brief Closes the session once its buffered output has been acknowledged.
+ */
+extern void telnet_session_close(telnet_session *session);
+
+/**
+ *  @brief Hands the current line over to another task.
+ *
+ *  Called by the line handler in the tcpip thread. Until the session is
+ *  attached again no further queued line is executed and no prompt is
+ *  written, input is still parsed ahead. Meanwhile telnet_session_write(),
+ *  telnet_session_write_static() and telnet_session_printf() pass their
+ *  data to the sink, so the other task can use them.
+ *
+ *  If the connection is lost while detached, the slot stays reserved until
+ *  the session is attached again.
+ *
+ *  @param sink Receives the output of the detached line, called from the other task.
+ *  @param context Passed to the sink.
+ */
+extern void telnet_session_detach(telnet_session *session, telnet_session_sink sink, void *context);
+
+/**
+ *  @brief Completes a detached line: writes the prompt and continues with the queued lines.
+ *
+ *  @note Must be called from the tcpip thread.
+ */
+extern void telnet_session_attach(telnet_session *session);
+
+/**
+ *  @brief Lets the session pull its output from a shared source, e.g. tail -f.
+ *
+ *  Called by the line handler in the tcpip thread. Like a detached line,
+ *  following holds back the prompt and the queued lines. It ends when the
+ *  pump returns 0 or the peer interrupts with ^C; nothing is buffered per
+ *  session beyond the output ring.
+ *
+ *  @param pump Called whenever output space may be available.
+ *  @param context Passed to the pump.
+ */
+extern void telnet_session_follow(telnet_session *session, telnet_session_pump pump, void *context);
+
+/**
+ *  @brief Copies output of a detached line into the session and flushes it.
+ *
+ *  @note Must be called from the tcpip thread.
+ *
+ *  @return Number of bytes accepted, all of them if the connection is already gone.
+ */
+extern uint16_t telnet_session_deliver(telnet_session *session, const void *data, uint16_t length);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "peripheral/uart/plib_uart1.h"
+
+/** Transmit stream buffer size in bytes */
+#define UART1_DRIVER_TX_SIZE                512U
+
+/** Receive stream buffer size in bytes, covers 44 ms at 115200 baud for the bridge pump to drain it */
+#define UART1_DRIVER_RX_SIZE                512U
+
+/** Must not exceed configMAX_SYSCALL_INTERRUPT_PRIORITY, the handler uses FromISR calls */
+#define UART1_DRIVER_INTERRUPT_PRIORITY     2U
+
+/**
+ *  @brief Creates the stream buffers and enables the UART1 interrupts.
+ *
+ *  Call after UART1_SerialSetup(). Interrupts are taken once the scheduler
+ *  enables them, data written before is kept in the buffer.
+ *
+ *  @return 0 on success, -1 if the stream buffers could not be created.
+ */
+extern int uart1_driver_init(void);
+
+/**
+ *  @brief Queues bytes for transmission.
+ *
+ *  Writers are serialized by a mutex, the interrupt handler feeds the FIFO.
+ *
+ *  @param data Bytes to send.
+ *  @param length Number of bytes.
+ *  @param timeout Ticks to wait for the lock and for buffer space.
+ *
+ *  @return Number of bytes queued.
+ */
+extern size_t uart1_driver_write(const void *data, size_t length, TickType_t timeout);
+
+/**
+ *  @brief Takes received bytes, blocking until at least one is available.
+ *
+ *  @note Only one task may read.
+ *
+ *  @return Number of bytes copied, 0 on timeout.
+ */
+extern size_t uart1_driver_read(void *buffer, size_t length, TickType_t timeout);
+
+/**
+ *  @return Bytes uart1_driver_write() can queue without waiting.
+ */
+extern size_t uart1_driver_write_space(void);
+
+/**
+ *  @brief Changes the line settings with the UART interrupts masked.
+ *
+ *  @return 1 if the settings were applied, 0 if UART1_SerialSetup() refused them.
+ */
+extern uint8_t uart1_driver_setup(UART_SERIAL_SETUP *setup);
+
+/**
+ *  @brief Discards received bytes not read yet.
+ */
+extern void uart1_driver_purge_rx(void);
+
+/**
+ *  @brief Discards queued bytes not sent yet.
+ */
+extern void uart1_driver_purge_tx(void);
+
+/**
+ *  @return Received bytes lost to FIFO overruns or a full receive buffer.
+ */
+extern uint32_t uart1_driver_dropped(void);
+
+/**
+ *  @brief UART1 interrupt service, called from the vector wrapper in interrupts_a.S.
+ */
+extern void uart1_driver_interrupt_handler(void);
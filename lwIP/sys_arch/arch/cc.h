@@ -22,8 +22,10 @@ typedef uintptr_t mem_ptr_t;
 #define X32_F "X"
 #define SZT_F "uz"
 
-/* Byte order */
+/* Byte order, a host C library may already have it */
+#ifndef BYTE_ORDER
 #define BYTE_ORDER LITTLE_ENDIAN
+#endif
 
 // Define macros for efficient byte swapping
 
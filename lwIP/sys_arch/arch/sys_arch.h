@@ -40,6 +40,63 @@
  */
 #define ERR_NEED_SCHED 123
 
+/** Set this to 1 if you want the stack size passed to sys_thread_new() to be
+ * interpreted as number of stack words (FreeRTOS-like).
+ * Default is that they are interpreted as byte count (lwIP-like).
+ */
+#ifndef LWIP_FREERTOS_THREAD_STACKSIZE_IS_STACKWORDS
+#define LWIP_FREERTOS_THREAD_STACKSIZE_IS_STACKWORDS  0
+#endif
+
+/** Set this to 1 to create threads, mailboxes, semaphores and mutexes from
+ * fixed pools of statically allocated FreeRTOS objects instead of the FreeRTOS
+ * heap. Taking and returning a pool entry is constant-time, a pool that runs
+ * dry fails the creation with ERR_MEM. Requires configSUPPORT_STATIC_ALLOCATION.
+ */
+#ifndef LWIP_FREERTOS_STATIC_POOLS
+#define LWIP_FREERTOS_STATIC_POOLS                    0
+#endif
+
+#if LWIP_FREERTOS_STATIC_POOLS
+
+/** Mailboxes that can exist at the same time: the tcpip thread's plus the
+ * receive and accept mailboxes of every netconn. */
+#ifndef LWIP_FREERTOS_STATIC_MBOXES
+#define LWIP_FREERTOS_STATIC_MBOXES                   (1 + 2 * MEMP_NUM_NETCONN)
+#endif
+
+/** Capacity of every pooled mailbox in messages, larger sys_mbox_new() requests fail */
+#ifndef LWIP_FREERTOS_STATIC_MBOX_SIZE
+#define LWIP_FREERTOS_STATIC_MBOX_SIZE                TCPIP_MBOX_SIZE
+#endif
+
+/** Semaphores and mutexes that can exist at the same time. They share one
+ * pool: the core lock and heap mutexes, one semaphore per netconn and one for
+ * a caller waiting in tcpip_callback_wait(). */
+#ifndef LWIP_FREERTOS_STATIC_SEMS
+#define LWIP_FREERTOS_STATIC_SEMS                     (2 + MEMP_NUM_NETCONN + 1)
+#endif
+
+/** Threads created with sys_thread_new(), they are never deleted */
+#ifndef LWIP_FREERTOS_STATIC_THREADS
+#define LWIP_FREERTOS_STATIC_THREADS                  1
+#endif
+
+/** Stack of every pooled thread in the unit of sys_thread_new(), larger requests fail */
+#ifndef LWIP_FREERTOS_STATIC_THREAD_STACKSIZE
+#define LWIP_FREERTOS_STATIC_THREAD_STACKSIZE         TCPIP_THREAD_STACKSIZE
+#endif
+
+/** sys_thread_new() stack size in FreeRTOS stack words. Needs StackType_t, so it
+ * can only be evaluated where the FreeRTOS headers are included. */
+#if LWIP_FREERTOS_THREAD_STACKSIZE_IS_STACKWORDS
+#define LWIP_FREERTOS_STACK_WORDS(stacksize)          ((size_t)(stacksize))
+#else
+#define LWIP_FREERTOS_STACK_WORDS(stacksize)          (((size_t)(stacksize) + sizeof(StackType_t) - 1) / sizeof(StackType_t))
+#endif
+
+#endif /* LWIP_FREERTOS_STATIC_POOLS */
+
 /* This port includes FreeRTOS headers in sys_arch.c only.
  *  FreeRTOS uses pointers as object types. We use wrapper structs instead of
  * void pointers directly to get a tiny bit of type safety.
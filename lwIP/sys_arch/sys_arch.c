@@ -41,14 +41,6 @@
 #include "semphr.h"
 #include "task.h"
 
-/** Set this to 1 if you want the stack size passed to sys_thread_new() to be
- * interpreted as number of stack words (FreeRTOS-like).
- * Default is that they are interpreted as byte count (lwIP-like).
- */
-#ifndef LWIP_FREERTOS_THREAD_STACKSIZE_IS_STACKWORDS
-#define LWIP_FREERTOS_THREAD_STACKSIZE_IS_STACKWORDS  0
-#endif
-
 /** Set this to 1 to use a mutex for SYS_ARCH_PROTECT() critical regions.
  * Default is 0 and locks interrupts/scheduler for SYS_ARCH_PROTECT().
  */
@@ -82,8 +74,12 @@
 #define LWIP_FREERTOS_SYS_NOW_FROM_FREERTOS           1
 #endif
 
-#if !configSUPPORT_DYNAMIC_ALLOCATION
-# error "lwIP FreeRTOS port requires configSUPPORT_DYNAMIC_ALLOCATION"
+#if LWIP_FREERTOS_STATIC_POOLS
+#if !configSUPPORT_STATIC_ALLOCATION
+# error "LWIP_FREERTOS_STATIC_POOLS requires configSUPPORT_STATIC_ALLOCATION"
+#endif
+#elif !configSUPPORT_DYNAMIC_ALLOCATION
+# error "lwIP FreeRTOS port requires configSUPPORT_DYNAMIC_ALLOCATION or LWIP_FREERTOS_STATIC_POOLS"
 #endif
 #if !INCLUDE_vTaskDelay
 # error "lwIP FreeRTOS port requires INCLUDE_vTaskDelay"
@@ -99,18 +95,104 @@
 
 #if SYS_LIGHTWEIGHT_PROT && LWIP_FREERTOS_SYS_ARCH_PROTECT_USES_MUTEX
 static SemaphoreHandle_t sys_arch_protect_mutex;
+#if LWIP_FREERTOS_STATIC_POOLS
+static StaticSemaphore_t sys_arch_protect_mutex_buffer;
+#endif
 #endif
 #if SYS_LIGHTWEIGHT_PROT && LWIP_FREERTOS_SYS_ARCH_PROTECT_SANITY_CHECK
 static sys_prot_t sys_arch_protect_nesting;
 #endif
 
+#if LWIP_FREERTOS_STATIC_POOLS
+
+/* A free pool entry holds the link to the next free one in its own first
+ * bytes, like a memp element, so taking and returning are a pointer swap. */
+struct sys_arch_pool_entry {
+  struct sys_arch_pool_entry *next;
+};
+
+struct sys_arch_pool {
+  struct sys_arch_pool_entry *free;
+};
+
+/* The queue comes first: the handle FreeRTOS returns is the entry itself */
+struct sys_arch_mbox_entry {
+  StaticQueue_t queue;
+  u8_t storage[LWIP_FREERTOS_STATIC_MBOX_SIZE * sizeof(void *)];
+};
+
+struct sys_arch_thread_entry {
+  StaticTask_t tcb;
+  StackType_t stack[LWIP_FREERTOS_STACK_WORDS(LWIP_FREERTOS_STATIC_THREAD_STACKSIZE)];
+};
+
+static struct sys_arch_mbox_entry sys_arch_mboxes[LWIP_FREERTOS_STATIC_MBOXES];
+static StaticSemaphore_t sys_arch_sems[LWIP_FREERTOS_STATIC_SEMS];
+static struct sys_arch_thread_entry sys_arch_threads[LWIP_FREERTOS_STATIC_THREADS];
+
+static struct sys_arch_pool sys_arch_mbox_pool;
+static struct sys_arch_pool sys_arch_sem_pool;
+static u8_t sys_arch_threads_used;
+
+static void
+sys_arch_pool_init(struct sys_arch_pool *pool, void *entries, size_t entry_size, size_t count)
+{
+  u8_t *base = (u8_t *)entries;
+  size_t i;
+
+  pool->free = NULL;
+  for (i = count; i > 0; i--) {
+    struct sys_arch_pool_entry *entry = (struct sys_arch_pool_entry *)(void *)(base + (i - 1) * entry_size);
+    entry->next = pool->free;
+    pool->free = entry;
+  }
+}
+
+static void *
+sys_arch_pool_take(struct sys_arch_pool *pool)
+{
+  struct sys_arch_pool_entry *entry;
+
+  taskENTER_CRITICAL();
+  entry = pool->free;
+  if (entry != NULL) {
+    pool->free = entry->next;
+  }
+  taskEXIT_CRITICAL();
+
+  return entry;
+}
+
+static void
+sys_arch_pool_give(struct sys_arch_pool *pool, void *object)
+{
+  struct sys_arch_pool_entry *entry = (struct sys_arch_pool_entry *)object;
+
+  taskENTER_CRITICAL();
+  entry->next = pool->free;
+  pool->free = entry;
+  taskEXIT_CRITICAL();
+}
+
+#endif /* LWIP_FREERTOS_STATIC_POOLS */
+
 /* Initialize this module (see description in sys.h) */
 void
 sys_init(void)
 {
+#if LWIP_FREERTOS_STATIC_POOLS
+  sys_arch_pool_init(&sys_arch_mbox_pool, sys_arch_mboxes, sizeof(sys_arch_mboxes[0]), LWIP_FREERTOS_STATIC_MBOXES);
+  sys_arch_pool_init(&sys_arch_sem_pool, sys_arch_sems, sizeof(sys_arch_sems[0]), LWIP_FREERTOS_STATIC_SEMS);
+  sys_arch_threads_used = 0;
+#endif /* LWIP_FREERTOS_STATIC_POOLS */
+
 #if SYS_LIGHTWEIGHT_PROT && LWIP_FREERTOS_SYS_ARCH_PROTECT_USES_MUTEX
   /* initialize sys_arch_protect global mutex */
+#if LWIP_FREERTOS_STATIC_POOLS
+  sys_arch_protect_mutex = xSemaphoreCreateRecursiveMutexStatic(&sys_arch_protect_mutex_buffer);
+#else
   sys_arch_protect_mutex = xSemaphoreCreateRecursiveMutex();
+#endif
   LWIP_ASSERT("failed to create sys_arch_protect mutex",
     sys_arch_protect_mutex != NULL);
 #endif /* SYS_LIGHTWEIGHT_PROT && LWIP_FREERTOS_SYS_ARCH_PROTECT_USES_MUTEX */
@@ -201,7 +283,14 @@ sys_mutex_new(sys_mutex_t *mutex)
 {
   LWIP_ASSERT("mutex != NULL", mutex != NULL);
 
+#if LWIP_FREERTOS_STATIC_POOLS
+  {
+    StaticSemaphore_t *buffer = (StaticSemaphore_t *)sys_arch_pool_take(&sys_arch_sem_pool);
+    mutex->mut = (buffer != NULL) ? xSemaphoreCreateRecursiveMutexStatic(buffer) : NULL;
+  }
+#else
   mutex->mut = xSemaphoreCreateRecursiveMutex();
+#endif
   if(mutex->mut == NULL) {
     SYS_STATS_INC(mutex.err);
     return ERR_MEM;
@@ -240,6 +329,9 @@ sys_mutex_free(sys_mutex_t *mutex)
 
   SYS_STATS_DEC(mutex.used);
   vSemaphoreDelete(mutex->mut);
+#if LWIP_FREERTOS_STATIC_POOLS
+  sys_arch_pool_give(&sys_arch_sem_pool, mutex->mut);
+#endif
   mutex->mut = NULL;
 }
 
@@ -252,7 +344,14 @@ sys_sem_new(sys_sem_t *sem, u8_t initial_count)
   LWIP_ASSERT("initial_count invalid (not 0 or 1)",
     (initial_count == 0) || (initial_count == 1));
 
+#if LWIP_FREERTOS_STATIC_POOLS
+  {
+    StaticSemaphore_t *buffer = (StaticSemaphore_t *)sys_arch_pool_take(&sys_arch_sem_pool);
+    sem->sem = (buffer != NULL) ? xSemaphoreCreateBinaryStatic(buffer) : NULL;
+  }
+#else
   sem->sem = xSemaphoreCreateBinary();
+#endif
   if(sem->sem == NULL) {
     SYS_STATS_INC(sem.err);
     return ERR_MEM;
@@ -314,6 +413,9 @@ sys_sem_free(sys_sem_t *sem)
 
   SYS_STATS_DEC(sem.used);
   vSemaphoreDelete(sem->sem);
+#if LWIP_FREERTOS_STATIC_POOLS
+  sys_arch_pool_give(&sys_arch_sem_pool, sem->sem);
+#endif
   sem->sem = NULL;
 }
 
@@ -323,7 +425,19 @@ sys_mbox_new(sys_mbox_t *mbox, int size)
   LWIP_ASSERT("mbox != NULL", mbox != NULL);
   LWIP_ASSERT("size > 0", size > 0);
 
+#if LWIP_FREERTOS_STATIC_POOLS
+  {
+    struct sys_arch_mbox_entry *entry = NULL;
+
+    LWIP_ASSERT("size <= LWIP_FREERTOS_STATIC_MBOX_SIZE", size <= LWIP_FREERTOS_STATIC_MBOX_SIZE);
+    if (size <= LWIP_FREERTOS_STATIC_MBOX_SIZE) {
+      entry = (struct sys_arch_mbox_entry *)sys_arch_pool_take(&sys_arch_mbox_pool);
+    }
+    mbox->mbx = (entry != NULL) ? xQueueCreateStatic((UBaseType_t)size, sizeof(void *), entry->storage, &entry->queue) : NULL;
+  }
+#else
   mbox->mbx = xQueueCreate((UBaseType_t)size, sizeof(void *));
+#endif
   if(mbox->mbx == NULL) {
     SYS_STATS_INC(mbox.err);
     return ERR_MEM;
@@ -454,6 +568,9 @@ sys_mbox_free(sys_mbox_t *mbox)
 #endif
 
   vQueueDelete(mbox->mbx);
+#if LWIP_FREERTOS_STATIC_POOLS
+  sys_arch_pool_give(&sys_arch_mbox_pool, mbox->mbx);
+#endif
 
   SYS_STATS_DEC(mbox.used);
 }
@@ -462,7 +579,9 @@ sys_thread_t
 sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize, int prio)
 {
   TaskHandle_t rtos_task;
+#if !LWIP_FREERTOS_STATIC_POOLS
   BaseType_t ret;
+#endif
   sys_thread_t lwip_thread;
   size_t rtos_stacksize;
 
@@ -475,8 +594,30 @@ sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize
 
   /* lwIP's lwip_thread_fn matches FreeRTOS' TaskFunction_t, so we can pass the
      thread function without adaption here. */
+#if LWIP_FREERTOS_STATIC_POOLS
+  {
+    struct sys_arch_thread_entry *entry = NULL;
+
+    LWIP_ASSERT("stacksize <= LWIP_FREERTOS_STATIC_THREAD_STACKSIZE",
+      rtos_stacksize <= LWIP_FREERTOS_STACK_WORDS(LWIP_FREERTOS_STATIC_THREAD_STACKSIZE));
+
+    /* threads are never deleted, so the pool only grows */
+    taskENTER_CRITICAL();
+    if (sys_arch_threads_used < LWIP_FREERTOS_STATIC_THREADS) {
+      entry = &sys_arch_threads[sys_arch_threads_used++];
+    }
+    taskEXIT_CRITICAL();
+
+    rtos_task = NULL;
+    if ((entry != NULL) && (rtos_stacksize <= LWIP_FREERTOS_STACK_WORDS(LWIP_FREERTOS_STATIC_THREAD_STACKSIZE))) {
+      rtos_task = xTaskCreateStatic(thread, name, (configSTACK_DEPTH_TYPE)rtos_stacksize, arg, prio, entry->stack, &entry->tcb);
+    }
+    LWIP_ASSERT("task creation failed", rtos_task != NULL);
+  }
+#else
   ret = xTaskCreate(thread, name, (configSTACK_DEPTH_TYPE)rtos_stacksize, arg, prio, &rtos_task);
   LWIP_ASSERT("task creation failed", ret == pdTRUE);
+#endif
 
   lwip_thread.thread_handle = rtos_task;
   return lwip_thread;
@@ -0,0 +1,423 @@
+#!/usr/bin/env python3
+"""Benchmarks the telnet server of the host build.
+
+Starts one simulated device and the client endpoint on a virtual wire,
+then measures through the client from the host:
+
+    echo      keystroke to echo latency, one character at a time
+    bulk      output throughput of a large response (chargen)
+    paste     input throughput of many command lines sent at once
+    sessions  concurrent sessions that get a prompt before the pools run out
+
+Around every phase the counters of the device are reset and read over its
+control socket. Each phase reports its own figures plus the cost per frame
+(device frames sent and received): simulated SPI time, bytes and
+transactions on the bus, and CPU cycles of the firmware tasks. CPU cycles
+are host run time at the PIC32 clock rate, good for comparing commits on
+the same machine, not for absolute figures. For those the cycle cost
+model of the host build (sim/host/sim_cost.c) counts checksums, copies,
+parser bytes, pbuf and driver calls and SPI bytes and prices them in M4K
+cycles: per frame, as a share of the 76 MHz CPU over the phase and per
+operation. A share above 100% means the board could not keep the pace
+the host ran the phase at. The high-water mark and the allocation failures of every lwIP
+pool close each phase.
+
+    make -C sim FREERTOS_POSIX_PORT=...
+    python3 sim/bench/telnet_bench.py --json bench.json
+
+--json writes the results as one JSON object ("-" for stdout), with the
+commit and the parameters, so runs can be tracked per commit. The wire
+options (--rate, --latency, --loss, --seed, --pcap) are passed on to
+pic32-telnet-wire.
+"""
+
+import argparse
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+
+IAC = 255
+DONT = 254
+DO = 253
+WONT = 252
+WILL = 251
+SB = 250
+SE = 240
+
+OPTION_ECHO = 1
+OPTION_SGA = 3
+
+PROMPT = b"> "
+
+# tasks of the host build that are not firmware
+HOST_TASKS = ("IDLE", "wire", "uart", "control")
+
+
+class Control(object):
+    """Client of the device's control socket."""
+
+    def __init__(self, path, directory):
+        self.local = os.path.join(directory, "bench.sock")
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+        self.sock.bind(self.local)
+        self.sock.settimeout(5.0)
+        self.path = path
+
+    def request(self, command):
+        self.sock.sendto(command.encode("ascii"), self.path)
+        return json.loads(self.sock.recv(65536).decode("ascii"))
+
+    def reset(self):
+        return self.request("reset")
+
+    def stats(self):
+        return self.request("stats")
+
+
+class Session(object):
+    """A telnet connection through the client endpoint in character mode.
+
+    LINEMODE is refused, so the server edits and echoes every keystroke;
+    its offer to echo and to suppress go-ahead is accepted, everything else
+    refused.
+    """
+
+    def __init__(self, port, timeout):
+        self.sock = socket.create_connection(("127.0.0.1", port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.text = bytearray()
+        self.state = 0
+        self.verb = 0
+
+    def close(self):
+        self.sock.close()
+
+    def send(self, data):
+        self.sock.sendall(data)
+
+    def _negotiate(self, verb, option):
+        if verb == WILL:
+            answer = DO if option in (OPTION_ECHO, OPTION_SGA) else DONT
+        elif verb == DO:
+            answer = WONT
+        else:
+            return
+        self.sock.sendall(bytes((IAC, answer, option)))
+
+    def _strip(self, data):
+        # answers and drops IAC commands and subnegotiations, keeps the text
+        for byte in data:
+            if self.state == 0:
+                if byte == IAC:
+                    self.state = 1
+                else:
+                    self.text.append(byte)
+            elif self.state == 1:
+                if byte == IAC:
+                    self.text.append(byte)
+                    self.state = 0
+                elif byte == SB:
+                    self.state = 3
+                elif byte >= WILL:
+                    self.verb = byte
+                    self.state = 2
+                else:
+                    self.state = 0
+            elif self.state == 2:
+                self._negotiate(self.verb, byte)
+                self.state = 0
+            elif self.state == 3:
+                if byte == IAC:
+                    self.state = 4
+            elif self.state == 4:
+                self.state = 0 if byte == SE else 3
+
+    def read_until(self, predicate):
+        """Reads until predicate(text) is true, returns the time of the last read."""
+        while not predicate(self.text):
+            data = self.sock.recv(65536)
+            if not data:
+                raise EOFError("connection closed")
+            self._strip(data)
+        return time.monotonic()
+
+    def wait_prompt(self):
+        self.read_until(lambda text: text.endswith(PROMPT))
+        self.text.clear()
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    index = max(0, min(len(ordered) - 1, int(round(fraction * len(ordered) + 0.5)) - 1))
+    return ordered[index]
+
+
+def costs(stats):
+    """Cost per frame and pool usage from the counters of one phase."""
+    device = stats["device"]
+    frames = device["frames_sent"] + device["frames_received"]
+    ticks = sum(value for name, value in stats["tasks"].items() if name not in HOST_TASKS)
+    cycles = ticks * stats["cpu_clock_hz"] // stats["core_timer_hz"]
+    per_frame = max(frames, 1)
+    m4k = sum(figures["cycles"] for figures in stats["cost"].values())
+    seconds = stats["elapsed"] / float(stats["core_timer_hz"])
+
+    return {
+        "frames_sent": device["frames_sent"],
+        "frames_received": device["frames_received"],
+        "frames_dropped": device["frames_dropped"],
+        "spi_us_per_frame": round(device["spi_ps"] / 1e6 / per_frame, 2),
+        "spi_bytes_per_frame": round(device["bytes"] / per_frame, 1),
+        "spi_transactions_per_frame": round(device["transactions"] / per_frame, 1),
+        "cpu_cycles_per_frame": cycles // per_frame,
+        "m4k_cycles_per_frame": m4k // per_frame,
+        "m4k_cpu_percent": round(100.0 * m4k / max(seconds * stats["cpu_clock_hz"], 1), 2),
+        "m4k_cycles": dict((name, figures["cycles"]) for name, figures in
+                           sorted(stats["cost"].items(), key=lambda item: -item[1]["cycles"]) if figures["cycles"]),
+        "heap": {"max": stats["heap"]["max"], "avail": stats["heap"]["avail"], "err": stats["heap"]["err"]},
+        "pools": dict((name, {"max": pool["max"], "avail": pool["avail"], "err": pool["err"]})
+                      for name, pool in stats["pools"].items()),
+    }
+
+
+def bench_echo(port, control, keystrokes, timeout):
+    session = Session(port, timeout)
+    session.wait_prompt()
+    control.reset()
+
+    latencies = []
+    typed = 0
+
+    while typed < keystrokes:
+        char = b"abcdefghijklmnopqrstuvwxyz"[typed % 26:typed % 26 + 1]
+        start = time.monotonic()
+        session.send(char)
+        end = session.read_until(lambda text: text.endswith(char))
+        latencies.append((end - start) * 1e6)
+        typed += 1
+
+        # keeps the line short, the rest of the line is not timed
+        if typed % 60 == 0 or typed == keystrokes:
+            session.send(b"\r\n")
+            session.wait_prompt()
+
+    result = costs(control.stats())
+    session.close()
+
+    result.update({
+        "keystrokes": keystrokes,
+        "latency_us_p50": round(percentile(latencies, 0.50), 1),
+        "latency_us_p90": round(percentile(latencies, 0.90), 1),
+        "latency_us_p99": round(percentile(latencies, 0.99), 1),
+        "latency_us_max": round(max(latencies), 1),
+        "latency_us_mean": round(sum(latencies) / len(latencies), 1),
+    })
+    return result
+
+
+def bench_bulk(port, control, length, timeout):
+    session = Session(port, timeout)
+    session.wait_prompt()
+    control.reset()
+
+    start = time.monotonic()
+    session.send(b"chargen %d\r\n" % length)
+    # the command line echo, the pattern and the prompt
+    end = session.read_until(lambda text: len(text) >= length and text.endswith(PROMPT))
+    received = len(session.text)
+
+    result = costs(control.stats())
+    session.close()
+
+    result.update({
+        "bytes": received,
+        "seconds": round(end - start, 4),
+        "bytes_per_second": int(received / (end - start)),
+    })
+    return result
+
+
+def bench_paste(port, control, lines, timeout):
+    session = Session(port, timeout)
+    session.wait_prompt()
+    control.reset()
+
+    line = b"echo " + b"0123456789" * 6 + b"\r\n"
+    paste = line * lines
+
+    start = time.monotonic()
+    session.send(paste)
+    end = session.read_until(lambda text: text.count(PROMPT) >= lines)
+
+    result = costs(control.stats())
+    session.close()
+
+    result.update({
+        "lines": lines,
+        "bytes": len(paste),
+        "seconds": round(end - start, 4),
+        "bytes_per_second": int(len(paste) / (end - start)),
+        "lines_per_second": round(lines / (end - start), 1),
+    })
+    return result
+
+
+def bench_sessions(port, control, limit, timeout):
+    control.reset()
+
+    sessions = []
+    refused = None
+
+    while len(sessions) < limit:
+        try:
+            session = Session(port, timeout)
+            session.wait_prompt()
+        except (EOFError, OSError) as error:
+            refused = str(error) or type(error).__name__
+            break
+        sessions.append(session)
+
+    result = costs(control.stats())
+
+    for session in sessions:
+        session.close()
+
+    result.update({
+        "max_sessions": len(sessions),
+        "limit_reached": refused is None,
+        "first_failure": refused,
+    })
+    return result
+
+
+def commit():
+    try:
+        return subprocess.check_output(["git", "-C", ROOT, "rev-parse", "HEAD"],
+                                       stderr=subprocess.DEVNULL).decode("ascii").strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def free_port():
+    probe = socket.socket()
+    probe.bind(("127.0.0.1", 0))
+    port = probe.getsockname()[1]
+    probe.close()
+    return port
+
+
+def wait_ready(port, timeout):
+    deadline = time.monotonic() + timeout
+
+    while True:
+        try:
+            session = Session(port, 2.0)
+            session.wait_prompt()
+            session.close()
+            return
+        except (EOFError, OSError):
+            if time.monotonic() > deadline:
+                raise
+            time.sleep(0.2)
+
+
+def print_summary(results):
+    for phase, figures in results.items():
+        print("%s:" % phase)
+        for name, value in figures.items():
+            if name == "pools":
+                used = ", ".join("%s %d/%d%s" % (pool, usage["max"], usage["avail"],
+                                                 " err %d" % usage["err"] if usage["err"] else "")
+                                 for pool, usage in value.items() if usage["max"] or usage["err"])
+                print("  %-28s %s" % ("pools (max/avail)", used))
+            elif name == "m4k_cycles":
+                print("  %-28s %s" % (name, ", ".join("%s %d" % item for item in value.items())))
+            elif name == "heap":
+                print("  %-28s %d/%d%s" % ("heap (max/avail)", value["max"], value["avail"],
+                                            " err %d" % value["err"] if value["err"] else ""))
+            else:
+                print("  %-28s %s" % (name, value))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--build", default=os.path.join(ROOT, "sim", "build"), help="directory of the host build")
+    parser.add_argument("--json", help="write the results to this file, - for stdout")
+    parser.add_argument("--phases", default="echo,bulk,paste,sessions", help="comma separated phases to run")
+    parser.add_argument("--keystrokes", type=int, default=300)
+    parser.add_argument("--bulk-bytes", type=int, default=65536)
+    parser.add_argument("--paste-lines", type=int, default=100)
+    parser.add_argument("--session-limit", type=int, default=16)
+    parser.add_argument("--timeout", type=float, default=10.0, help="seconds to wait for any reply")
+    parser.add_argument("--rate", help="wire link rate in bits per second")
+    parser.add_argument("--latency", help="wire latency in microseconds")
+    parser.add_argument("--loss", help="wire loss in percent")
+    parser.add_argument("--seed", help="wire loss seed")
+    parser.add_argument("--pcap", help="capture the wire to this file")
+    args = parser.parse_args()
+
+    directory = tempfile.mkdtemp(prefix="telnet-bench-")
+    control_path = os.path.join(directory, "sim.sock")
+    port = free_port()
+
+    wire = [os.path.join(args.build, "pic32-telnet-wire")]
+    for option in ("rate", "latency", "loss", "seed", "pcap"):
+        if getattr(args, option) is not None:
+            wire += ["--" + option, getattr(args, option)]
+
+    wire += [os.path.join(args.build, "pic32-telnet-sim"), "--control", control_path, "--",
+             os.path.join(args.build, "pic32-telnet-client"), "--listen", str(port)]
+
+    log = open(os.path.join(directory, "wire.log"), "wb")
+    process = subprocess.Popen(wire, stdin=subprocess.DEVNULL, stdout=log, stderr=log)
+
+    phases = {
+        "echo": lambda control: bench_echo(port, control, args.keystrokes, args.timeout),
+        "bulk": lambda control: bench_bulk(port, control, args.bulk_bytes, args.timeout),
+        "paste": lambda control: bench_paste(port, control, args.paste_lines, args.timeout),
+        "sessions": lambda control: bench_sessions(port, control, args.session_limit, min(args.timeout, 3.0)),
+    }
+
+    results = {}
+
+    try:
+        wait_ready(port, args.timeout)
+        control = Control(control_path, directory)
+
+        for phase in args.phases.split(","):
+            if phase not in phases:
+                sys.exit("telnet_bench: unknown phase %s" % phase)
+            results[phase] = phases[phase](control)
+            # lets closed sessions leave TIME_WAIT free slots behind
+            time.sleep(0.5)
+    finally:
+        process.terminate()
+        process.wait()
+        log.close()
+
+    report = {
+        "schema": 1,
+        "commit": commit(),
+        "parameters": dict((name, value) for name, value in vars(args).items() if name not in ("build", "json")),
+        "results": results,
+    }
+
+    if args.json == "-":
+        json.dump(report, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+    else:
+        print_summary(results)
+        if args.json:
+            with open(args.json, "w") as f:
+                json.dump(report, f, indent=2)
+                f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
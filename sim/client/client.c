@@ -0,0 +1,538 @@
+/*
+ *  Userspace TCP/IP endpoint on the virtual wire.
+ *
+ *      pic32-telnet-client [--address A.B.C.D] [--server A.B.C.D] [--port N] [--listen N] --wire FD
+ *
+ *  A second lwIP instance, raw API in one thread, with its own MAC and IP
+ *  address on the simulated segment. It listens on 127.0.0.1:--listen
+ *  (2323) and opens one lwIP connection to --server:--port (the firmware
+ *  telnet server, 192.168.1.200:23) per accepted host connection, then
+ *  relays both ways. A normal Linux telnet client on the host talks to the
+ *  simulated device this way:
+ *
+ *      pic32-telnet-wire --pcap run.pcap pic32-telnet-sim -- pic32-telnet-client
+ *      telnet 127.0.0.1 2323
+ *
+ *  Nagle is off on the lwIP side so keystrokes go out as they come. Data
+ *  from the device is only acknowledged to it once the host socket took
+ *  it, a slow host reader closes the TCP window like a slow peer would.
+ */
+
+// lwIP first, its cc.h defines BYTE_ORDER before the C library does
+#include "lwip/init.h"
+#include "lwip/etharp.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/timeouts.h"
+#include "netif/ethernet.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SESSIONS_MAX        32U
+
+#define FRAME_MAX           1536U
+
+/** Padded length without FCS */
+#define FRAME_MIN           60U
+
+/** Longest wait for the host side, the lwIP timers run at least this often */
+#define POLL_MS_MAX         100U
+
+typedef struct {
+    int fd;                 /**< Host connection, -1 for a free slot */
+    struct tcp_pcb *pcb;    /**< NULL once lwIP let go of the connection */
+    struct pbuf *unsent;    /**< Received from the device, not yet taken by the host socket */
+    uint16_t offset;        /**< Bytes of the first pbuf in unsent already sent */
+    uint8_t connected;
+    uint8_t remote_closed;
+} session;
+
+static struct netif netif;
+static int wire = -1;
+static int listener = -1;
+static session sessions[SESSIONS_MAX];
+
+static ip4_addr_t server;
+static uint16_t server_port = 23U;
+
+
+static void usage(const char *program) {
+
+    fprintf(stderr, "usage: %s [--address A.B.C.D] [--server A.B.C.D] [--port N] [--listen N] --wire FD\n", program);
+    exit(EXIT_FAILURE);
+}
+
+u32_t sys_now(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (u32_t) ((uint64_t) now.tv_sec * 1000U + (uint64_t) now.tv_nsec / 1000000U);
+}
+
+static err_t link_output(struct netif *interface, struct pbuf *p) {
+
+    static uint8_t frame[FRAME_MAX];
+    uint16_t length;
+
+    if (p->tot_len > sizeof(frame)) {
+        return ERR_IF;
+    }
+
+    length = pbuf_copy_partial(p, frame, p->tot_len, 0U);
+
+    // the device drops runts, pad like a MAC would
+    if (length < FRAME_MIN) {
+        memset(&frame[length], 0, FRAME_MIN - length);
+        length = FRAME_MIN;
+    }
+
+    // a full socket is a busy wire, TCP recovers
+    send(wire, frame, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    return ERR_OK;
+}
+
+static err_t interface_init(struct netif *interface) {
+
+    interface->name[0] = 'w';
+    interface->name[1] = 'r';
+    interface->output = etharp_output;
+    interface->linkoutput = link_output;
+    interface->mtu = 1500U;
+    interface->hwaddr_len = ETH_HWADDR_LEN;
+    interface->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET | NETIF_FLAG_LINK_UP;
+
+    return ERR_OK;
+}
+
+// every frame waiting on the wire, returns -1 once the wire is gone
+static int receive_frames(void) {
+
+    static uint8_t frame[FRAME_MAX];
+
+    for (;;) {
+
+        ssize_t length = recv(wire, frame, sizeof(frame), MSG_DONTWAIT | MSG_TRUNC);
+        struct pbuf *p;
+
+        if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return 0;
+        }
+
+        if (length <= 0) {
+            return -1;
+        }
+
+        if ((size_t) length > sizeof(frame)) {
+            continue;
+        }
+
+        p = pbuf_alloc(PBUF_RAW, (u16_t) length, PBUF_POOL);
+
+        if (p == NULL) {
+            continue;
+        }
+
+        pbuf_take(p, frame, (u16_t) length);
+
+        if (netif.input(p, &netif) != ERR_OK) {
+            pbuf_free(p);
+        }
+    }
+}
+
+static void session_free(session *s) {
+
+    if (s->pcb != NULL) {
+
+        tcp_arg(s->pcb, NULL);
+        tcp_recv(s->pcb, NULL);
+        tcp_err(s->pcb, NULL);
+
+        if (tcp_close(s->pcb) != ERR_OK) {
+            tcp_abort(s->pcb);
+        }
+
+        s->pcb = NULL;
+    }
+
+    if (s->unsent != NULL) {
+        pbuf_free(s->unsent);
+        s->unsent = NULL;
+    }
+
+    if (s->fd >= 0) {
+        close(s->fd);
+        s->fd = -1;
+    }
+}
+
+// hands what the device sent to the host socket, acknowledges what it took
+static void session_flush(session *s) {
+
+    while (s->unsent != NULL) {
+
+        struct pbuf *head = s->unsent;
+        ssize_t sent = send(s->fd, (const uint8_t *) head->payload + s->offset, head->len - s->offset,
+                MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if (sent <= 0) {
+
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+
+            session_free(s);
+            return;
+        }
+
+        s->offset = (uint16_t) (s->offset + sent);
+
+        if (s->pcb != NULL) {
+            tcp_recved(s->pcb, (u16_t) sent);
+        }
+
+        if (s->offset == head->len) {
+
+            s->unsent = head->next;
+
+            if (s->unsent != NULL) {
+                pbuf_ref(s->unsent);
+            }
+
+            s->offset = 0U;
+            pbuf_free(head);
+        }
+    }
+
+    if (s->remote_closed == 1U) {
+        session_free(s);
+    }
+}
+
+static err_t session_receive(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+
+    session *s = arg;
+
+    if (s == NULL) {
+
+        if (p != NULL) {
+            pbuf_free(p);
+        }
+
+        return ERR_OK;
+    }
+
+    if (p == NULL) {
+        s->remote_closed = 1U;
+    } else if (s->unsent == NULL) {
+        s->unsent = p;
+    } else {
+        pbuf_cat(s->unsent, p);
+    }
+
+    session_flush(s);
+
+    return ERR_OK;
+}
+
+static err_t session_connected(void *arg, struct tcp_pcb *pcb, err_t err) {
+
+    session *s = arg;
+
+    if (s != NULL) {
+        s->connected = 1U;
+    }
+
+    return ERR_OK;
+}
+
+static void session_error(void *arg, err_t err) {
+
+    session *s = arg;
+
+    // lwIP already freed the pcb
+    if (s != NULL) {
+        s->pcb = NULL;
+        session_free(s);
+    }
+}
+
+static void session_open(void) {
+
+    int fd = accept(listener, NULL, NULL);
+    session *s = NULL;
+    unsigned i;
+
+    if (fd < 0) {
+        return;
+    }
+
+    for (i = 0U; i < SESSIONS_MAX && s == NULL; i++) {
+
+        if (sessions[i].fd < 0) {
+            s = &sessions[i];
+        }
+    }
+
+    if (s == NULL) {
+        close(fd);
+        return;
+    }
+
+    memset(s, 0, sizeof(*s));
+    s->fd = fd;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    s->pcb = tcp_new();
+
+    if (s->pcb == NULL) {
+        session_free(s);
+        return;
+    }
+
+    tcp_nagle_disable(s->pcb);
+    tcp_arg(s->pcb, s);
+    tcp_recv(s->pcb, session_receive);
+    tcp_err(s->pcb, session_error);
+
+    if (tcp_connect(s->pcb, &server, server_port, session_connected) != ERR_OK) {
+        session_free(s);
+    }
+}
+
+// what tcp_write() takes now: the send buffer, and a pbuf on the send queue per segment
+static u16_t session_room(struct tcp_pcb *pcb) {
+
+    u32_t room = tcp_sndbuf(pcb);
+    u32_t segments;
+
+    // one more pbuf may go to the tail of the last queued segment
+    if (tcp_sndqueuelen(pcb) + 2U > TCP_SND_QUEUELEN) {
+        return 0U;
+    }
+
+    segments = TCP_SND_QUEUELEN - tcp_sndqueuelen(pcb) - 1U;
+
+    if (room > segments * tcp_mss(pcb)) {
+        room = segments * tcp_mss(pcb);
+    }
+
+    return (u16_t) room;
+}
+
+// moves what the host wrote into the connection, as much as the send buffer takes
+static void session_forward(session *s) {
+
+    uint8_t data[TCP_MSS];
+    u16_t room = session_room(s->pcb);
+    ssize_t length;
+
+    if (room > sizeof(data)) {
+        room = sizeof(data);
+    }
+
+    length = recv(s->fd, data, room, MSG_DONTWAIT);
+
+    if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+
+    if (length <= 0) {
+        session_free(s);
+        return;
+    }
+
+    if (tcp_write(s->pcb, data, (u16_t) length, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        session_free(s);
+        return;
+    }
+
+    tcp_output(s->pcb);
+}
+
+static int open_listener(uint16_t port) {
+
+    struct sockaddr_in address;
+    int one = 1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(fd, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(fd, (int) SESSIONS_MAX) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void run(void) {
+
+    struct pollfd fds[2U + SESSIONS_MAX];
+    session *polled[SESSIONS_MAX];
+    unsigned i;
+
+    for (;;) {
+
+        nfds_t count = 2U;
+        u32_t sleep = sys_timeouts_sleeptime();
+        unsigned n;
+
+        fds[0].fd = wire;
+        fds[0].events = POLLIN;
+        fds[1].fd = listener;
+        fds[1].events = POLLIN;
+
+        for (i = 0U; i < SESSIONS_MAX; i++) {
+
+            session *s = &sessions[i];
+            short events = 0;
+
+            if (s->fd < 0) {
+                continue;
+            }
+
+            if (s->connected == 1U && s->pcb != NULL && session_room(s->pcb) > 0U) {
+                events |= POLLIN;
+            }
+
+            if (s->unsent != NULL) {
+                events |= POLLOUT;
+            }
+
+            polled[count - 2U] = s;
+            fds[count].fd = s->fd;
+            fds[count].events = events;
+            count++;
+        }
+
+        if (poll(fds, count, (sleep > POLL_MS_MAX) ? (int) POLL_MS_MAX : (int) sleep) < 0 && errno != EINTR) {
+            perror("poll");
+            return;
+        }
+
+        if ((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && receive_frames() != 0) {
+            return;
+        }
+
+        if ((fds[1].revents & POLLIN) != 0) {
+            session_open();
+        }
+
+        for (n = 2U; n < count; n++) {
+
+            session *s = polled[n - 2U];
+
+            if ((fds[n].revents & POLLOUT) != 0 && s->fd >= 0) {
+                session_flush(s);
+            }
+
+            if ((fds[n].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && s->fd >= 0 && s->pcb != NULL) {
+                session_forward(s);
+            }
+        }
+
+        sys_check_timeouts();
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    ip4_addr_t address;
+    ip4_addr_t netmask;
+    ip4_addr_t gateway;
+    unsigned long listen_port = 2323UL;
+    int i;
+
+    IP4_ADDR(&address, 192, 168, 1, 100);
+    IP4_ADDR(&server, 192, 168, 1, 200);
+    IP4_ADDR(&netmask, 255, 255, 255, 0);
+    IP4_ADDR(&gateway, 192, 168, 1, 1);
+
+    for (i = 1; i + 1 < argc; i += 2) {
+
+        if (strcmp(argv[i], "--address") == 0) {
+            if (ip4addr_aton(argv[i + 1], &address) == 0) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--server") == 0) {
+            if (ip4addr_aton(argv[i + 1], &server) == 0) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--port") == 0) {
+            server_port = (uint16_t) strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--listen") == 0) {
+            listen_port = strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--wire") == 0) {
+            wire = (int) strtol(argv[i + 1], NULL, 0);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (i != argc || wire < 0) {
+        usage(argv[0]);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    for (i = 0; i < (int) SESSIONS_MAX; i++) {
+        sessions[i].fd = -1;
+    }
+
+    listener = open_listener((uint16_t) listen_port);
+
+    if (listener < 0) {
+        perror("listen");
+        return EXIT_FAILURE;
+    }
+
+    lwip_init();
+
+    // locally administered, next to the devices' 02:04:A3:00:00:xx
+    netif.hwaddr[0] = 0x02U;
+    netif.hwaddr[1] = 0x04U;
+    netif.hwaddr[2] = 0xA3U;
+    netif.hwaddr[3] = 0x00U;
+    netif.hwaddr[4] = 0x01U;
+    netif.hwaddr[5] = ip4_addr4(&address);
+
+    if (netif_add(&netif, &address, &netmask, &gateway, NULL, interface_init, ethernet_input) == NULL) {
+        fprintf(stderr, "netif_add failed\n");
+        return EXIT_FAILURE;
+    }
+
+    netif_set_default(&netif);
+    netif_set_up(&netif);
+
+    fprintf(stderr, "client: %s, 127.0.0.1:%lu to ", ip4addr_ntoa(&address), listen_port);
+    fprintf(stderr, "%s:%u\n", ip4addr_ntoa(&server), server_port);
+
+    run();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+#ifndef LWIPOPTS_H
+#define LWIPOPTS_H
+
+/*
+ *  lwIP configuration of the host client endpoint: raw API in a single
+ *  thread, sized like a desktop peer rather than the firmware so the
+ *  device is the bottleneck of every measurement.
+ */
+
+/* ===============================================================
+ * System
+ * =============================================================== */
+#define NO_SYS                         1
+#define SYS_LIGHTWEIGHT_PROT           0
+
+#define LWIP_PROVIDE_ERRNO             0
+#define LWIP_ERRNO_STDINCLUDE          1
+
+/* The host C library has htons() and friends */
+#define LWIP_DONT_PROVIDE_BYTEORDER_FUNCTIONS  1
+
+/* ===============================================================
+ * Memory
+ * =============================================================== */
+#define MEM_ALIGNMENT                  4
+#define MEM_SIZE                       (256 * 1024)
+
+#define MEM_LIBC_MALLOC                0
+#define MEMP_MEM_MALLOC                0
+
+/* ===============================================================
+ * Pbufs
+ * =============================================================== */
+#define PBUF_POOL_SIZE                 256
+
+/* ===============================================================
+ * Pools
+ * =============================================================== */
+#define MEMP_NUM_PBUF                  64
+#define MEMP_NUM_TCP_PCB               64
+#define MEMP_NUM_TCP_PCB_LISTEN        1
+#define MEMP_NUM_TCP_SEG               512
+
+/* ===============================================================
+ * Network
+ * =============================================================== */
+#define LWIP_ARP                       1
+#define ARP_TABLE_SIZE                 8
+#define ARP_QUEUEING                   1
+
+#define LWIP_IPV4                      1
+#define LWIP_IPV6                      0
+
+#define IP_REASSEMBLY                  0
+#define IP_FRAG                        0
+
+#define LWIP_ICMP                      1
+#define LWIP_UDP                       1
+#define LWIP_TCP                       1
+
+/* ===============================================================
+ * TCP
+ * =============================================================== */
+#define TCP_MSS                        1460
+#define TCP_WND                        (8 * TCP_MSS)
+#define TCP_SND_BUF                    (16 * TCP_MSS)
+#define TCP_SND_QUEUELEN               64
+
+#define LWIP_TCP_KEEPALIVE             0
+
+/* ===============================================================
+ * APIs
+ * =============================================================== */
+#define LWIP_SOCKET                    0
+#define LWIP_NETCONN                   0
+#define LWIP_RAW                       0
+
+#define LWIP_DHCP                      0
+#define LWIP_DNS                       0
+#define LWIP_AUTOIP                    0
+
+/* ===============================================================
+ * Statistics & Debug
+ * =============================================================== */
+#define LWIP_STATS                     0
+#define LWIP_DEBUG                     0
+#define LWIP_NOASSERT                  1
+
+#endif /* LWIPOPTS_H */
@@ -0,0 +1,1027 @@
+/*
+ *  Behavioral model of the ENC624J600 for host builds.
+ *
+ *  A host HAL forwards the enc624j600_hal_* calls to the model, so the
+ *  unchanged driver talks to it byte by byte as it would to the chip.
+ *  Every chip select bounded transaction is decoded like the SPI
+ *  interface does:
+ *
+ *      - single byte instructions (bank select, reset, TXRTS, PKTDEC,
+ *        RXEN, DMA start and stop, flow control, INT enable)
+ *      - RBSEL
+ *      - the three byte pointer reads and writes (EGPRDPT ... EUDAWRPT)
+ *      - RCR/WCR/BFS/BFC on the selected bank and RCRU/WCRU/BFSU/BFCU
+ *      - the SRAM window reads and writes through EGPDATA, ERXDATA and
+ *        EUDADATA with the pointer wrapping rules of each area
+ *
+ *  Behind it sit the 24 KB SRAM, the receive ring with its next packet
+ *  pointer and receive status vector, PKTCNT, the transmitter with padding,
+ *  FCS accounting in ETXWIRE and TXMAC source insertion, the MII
+ *  management interface to the PHY registers and the DMA copy and
+ *  checksum engine.
+ *
+ *  Time is simulated: every byte clocked costs 8 periods of the configured
+ *  SPI clock, chip select costs its setup and disable time and delays are
+ *  added as they are requested. TXRTS stays set for the wire time of the
+ *  frame at 100 Mb/s and MISTAT.BUSY for an MII cycle, so polling loops
+ *  in the driver cost what they would on the board. Comparing the SPI time
+ *  before and after a frame gives the driver's cost in SPI microseconds.
+ *
+ *  Not modeled: the crypto engines, pattern match, hash table and magic
+ *  packet filters, half duplex collisions and PAUSE frames, DMA duration
+ *  and the interrupt pin. Instructions outside the decoded set are
+ *  counted and ignored.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "enc624j600/enc624j600_registers.h"
+#include "enc624j600_model.h"
+
+/** @name Unbanked SRAM window and pointer registers */
+/** @{ */
+#define EGPDATA_SFR     0x80U
+#define ERXDATA_SFR     0x82U
+#define EUDADATA_SFR    0x84U
+#define EGPRDPT_SFR     0x86U
+#define EGPWRPT_SFR     0x88U
+#define ERXRDPT_SFR     0x8AU
+#define ERXWRPT_SFR     0x8CU
+#define EUDARDPT_SFR    0x8EU
+#define EUDAWRPT_SFR    0x90U
+/** @} */
+
+#define ERXHEAD_RESET   0x5340U
+#define POINTER_RESET   0x05FAU
+
+/** Chip select setup and disable time */
+#define CS_SETUP_PS     50000ULL
+#define CS_DISABLE_PS   20000ULL
+
+/** One MII management cycle */
+#define MII_CYCLE_PS    25600000ULL
+
+/** One byte on the wire at 100 Mb/s */
+#define WIRE_BYTE_PS    80000ULL
+
+/** Preamble, start of frame delimiter and inter-packet gap around every frame */
+#define WIRE_OVERHEAD   20U
+
+#define FCS_SIZE        4U
+#define MIN_FRAME       60U     /**< Without FCS */
+#define RSV_SIZE        6U
+
+typedef enum {
+    AREA_GENERAL,
+    AREA_RECEIVE,
+    AREA_USER
+} sram_area;
+
+typedef enum {
+    KIND_SINGLE,
+    KIND_RBSEL,
+    KIND_POINTER,
+    KIND_REGISTER,
+    KIND_WINDOW,
+    KIND_UNKNOWN
+} instruction_kind;
+
+// pointer register behind each pair of the 0x60 - 0x76 instructions
+static const uint8_t pointer_registers[6] = {
+    EGPRDPT_SFR, ERXRDPT_SFR, EUDARDPT_SFR, EGPWRPT_SFR, ERXWRPT_SFR, EUDAWRPT_SFR
+};
+
+
+static uint16_t sfr_get(const enc624j600_model *model, uint8_t address) {
+    return (uint16_t) (model->sfr[address] | ((uint16_t) model->sfr[address + 1U] << 8));
+}
+
+static void sfr_put(enc624j600_model *model, uint8_t address, uint16_t value) {
+
+    model->sfr[address] = (uint8_t) (value & 0xFFU);
+    model->sfr[address + 1U] = (uint8_t) (value >> 8);
+}
+
+static void advance(enc624j600_model *model, uint64_t ps) {
+    model->now_ps += ps;
+}
+
+static uint32_t crc32(const uint8_t *data, uint16_t length) {
+
+    uint32_t crc = 0xFFFFFFFFUL;
+    uint16_t i;
+    uint8_t bit;
+
+    for (i = 0; i < length; i++) {
+
+        crc ^= data[i];
+
+        for (bit = 0; bit < 8U; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1U) ? 0xEDB88320UL : 0U);
+        }
+    }
+
+    return ~crc;
+}
+
+/* SRAM areas */
+
+static sram_area area_of(const enc624j600_model *model, uint16_t address) {
+    return (address >= sfr_get(model, ERXST)) ? AREA_RECEIVE : AREA_GENERAL;
+}
+
+// address after a window access, each area wraps differently
+static uint16_t next_address(const enc624j600_model *model, sram_area area, uint16_t address) {
+
+    uint16_t receive_start = sfr_get(model, ERXST);
+
+    switch (area) {
+
+        case AREA_GENERAL:
+            // the general purpose buffer ends below the receive buffer
+            address++;
+            return (address == receive_start) ? 0U : address;
+
+        case AREA_RECEIVE:
+            address++;
+            return (address >= ENC624J600_MODEL_SRAM_SIZE) ? receive_start : address;
+
+        case AREA_USER:
+            if (address == sfr_get(model, EUDAND)) {
+                return sfr_get(model, EUDAST);
+            }
+            address++;
+            return (address >= ENC624J600_MODEL_SRAM_SIZE) ? 0U : address;
+    }
+
+    return address;
+}
+
+// the receive ring wraps to ERXST, the rest of the SRAM to 0
+static uint16_t next_linear(const enc624j600_model *model, uint16_t address) {
+
+    address++;
+
+    if (address >= ENC624J600_MODEL_SRAM_SIZE) {
+        return (area_of(model, address - 1U) == AREA_RECEIVE) ? sfr_get(model, ERXST) : 0U;
+    }
+
+    return address;
+}
+
+/* PHY */
+
+static void phy_update_link(enc624j600_model *model) {
+
+    uint16_t status = model->phy[PHSTAT1] & (uint16_t) ~(LLSTAT | ANDONE);
+    uint16_t speed = model->phy[PHSTAT3] & (uint16_t) ~(SPDDPX0 | SPDDPX1 | SPDDPX2);
+
+    if (model->link_up == 1U && (model->phy[PHCON1] & PSLEEP) == 0U) {
+
+        status |= LLSTAT;
+
+        if ((model->phy[PHCON1] & ANEN) != 0U) {
+            status |= ANDONE;
+        }
+
+        // 100 Mb/s, full or half duplex
+        speed |= (model->full_duplex == 1U) ? (SPDDPX1 | SPDDPX2) : SPDDPX1;
+        model->phy[PHANLPA] = LP100FD | LP100 | LP10FD | LP10 | LPIEEE0 | LPPAUS0 | LPACK;
+    } else {
+        model->phy[PHANLPA] = 0U;
+    }
+
+    model->phy[PHSTAT1] = status;
+    model->phy[PHSTAT3] = speed;
+}
+
+static void phy_reset(enc624j600_model *model) {
+
+    memset(model->phy, 0, sizeof(model->phy));
+
+    model->phy[PHCON1] = ANEN;
+    model->phy[PHSTAT1] = FULL100 | HALF100 | FULL10 | HALF10 | ANABLE | EXTREGS;
+    model->phy[PHANA] = ADPAUS0 | AD100FD | AD100 | AD10FD | AD10 | ADIEEE0;
+    model->phy[PHCON2] = EDSTAT;
+    model->phy[PHSTAT3] = 0x0040U;
+
+    phy_update_link(model);
+}
+
+static void phy_write(enc624j600_model *model, uint8_t address, uint16_t value) {
+
+    address &= 0x1FU;
+
+    if (address == PHCON1 && (value & PRST) != 0U) {
+        phy_reset(model);
+        return;
+    }
+
+    // read-only status registers
+    if (address == PHSTAT1 || address == PHANLPA || address == PHANE || address == PHSTAT2 || address == PHSTAT3) {
+        return;
+    }
+
+    model->phy[address] = value & (uint16_t) ~RENEG;
+    phy_update_link(model);
+}
+
+/* Reset */
+
+static void system_reset(enc624j600_model *model) {
+
+    uint8_t i;
+
+    memset(model->sfr, 0, sizeof(model->sfr));
+
+    sfr_put(model, ERXST, ERXHEAD_RESET);
+    sfr_put(model, ERXTAIL, 0x5FFEU);
+    sfr_put(model, ERXHEAD, ERXHEAD_RESET);
+    sfr_put(model, ERXFCON, CRCEN | RUNTEN | UCEN | BCEN);
+    sfr_put(model, MACON1, 0x800DU);
+    sfr_put(model, MACON2, 0x40B2U);
+    sfr_put(model, MABBIPG, 0x0012U);
+    sfr_put(model, MAIPG, 0x0C12U);
+    sfr_put(model, MACLCON, 0x370FU);
+    sfr_put(model, MAMXFL, 0x05EEU);
+    sfr_put(model, MIREGADR, 0x0100U);
+    sfr_put(model, EPAUS, 0x1000U);
+    sfr_put(model, ECON2, ETHEN | STRCH | COCON1 | COCON0 | COCON3);
+    sfr_put(model, ERXWM, 0x100FU);
+    sfr_put(model, EIE, INTIE | 0x0010U);
+    sfr_put(model, EIDLED, LACFG2 | LACFG1 | LBCFG2 | DEVIDO | REVID1);
+
+    for (i = 0; i < 6U; i += 2U) {
+        sfr_put(model, MAADR1 - i, (uint16_t) (model->factory_mac[i] | ((uint16_t) model->factory_mac[i + 1U] << 8)));
+    }
+
+    sfr_put(model, EGPRDPT_SFR, POINTER_RESET);
+    sfr_put(model, ERXRDPT_SFR, POINTER_RESET);
+    sfr_put(model, EUDARDPT_SFR, POINTER_RESET);
+
+    model->bank = 0U;
+    model->packet_count = 0U;
+    model->transmit_done_ps = 0U;
+    model->mii_done_ps = 0U;
+
+    phy_reset(model);
+}
+
+/* Transmitter */
+
+static void transmit(enc624j600_model *model) {
+
+    uint8_t frame[ENC624J600_MODEL_FRAME_MAX + 6U];
+    uint16_t start = sfr_get(model, ETXST);
+    uint16_t length = sfr_get(model, ETXLEN);
+    uint16_t macon2 = sfr_get(model, MACON2);
+    uint16_t address = start;
+    uint16_t size = 0U;
+    uint16_t i;
+
+    if (length > ENC624J600_MODEL_FRAME_MAX) {
+        length = ENC624J600_MODEL_FRAME_MAX;
+    }
+
+    for (i = 0; i < length; i++) {
+
+        // the source address goes in after the destination
+        if (i == 6U && (sfr_get(model, ECON2) & TXMAC) != 0U) {
+            frame[size + 0U] = model->sfr[MAADR1];
+            frame[size + 1U] = model->sfr[MAADR1 + 1U];
+            frame[size + 2U] = model->sfr[MAADR2];
+            frame[size + 3U] = model->sfr[MAADR2 + 1U];
+            frame[size + 4U] = model->sfr[MAADR3];
+            frame[size + 5U] = model->sfr[MAADR3 + 1U];
+            size += 6U;
+        }
+
+        frame[size++] = model->sram[address];
+        address = next_linear(model, address);
+    }
+
+    if ((macon2 & (PADCFG0 | PADCFG1 | PADCFG2)) != 0U && size < MIN_FRAME) {
+        memset(&frame[size], 0, MIN_FRAME - size);
+        size = MIN_FRAME;
+    }
+
+    uint16_t wire = size;
+
+    if ((macon2 & (TXCRCEN | PADCFG0 | PADCFG1 | PADCFG2)) != 0U) {
+        wire += FCS_SIZE;
+    }
+
+    sfr_put(model, ETXWIRE, wire);
+    sfr_put(model, ETXSTAT, 0U);
+    model->transmit_done_ps = model->now_ps + (uint64_t) (wire + WIRE_OVERHEAD) * WIRE_BYTE_PS;
+    model->stats.frames_sent++;
+
+    if ((sfr_get(model, MACON1) & LOOPBK) != 0U || (model->phy[PHCON1] & PLOOPBK) != 0U) {
+        enc624j600_model_receive(model, frame, size);
+    } else if (model->link_up == 1U && model->transmit != NULL) {
+        model->transmit(model->transmit_context, frame, size);
+    }
+}
+
+/* DMA */
+
+static void dma(enc624j600_model *model) {
+
+    uint16_t econ1 = sfr_get(model, ECON1);
+    uint16_t source = sfr_get(model, EDMAST);
+    uint16_t destination = sfr_get(model, EDMADST);
+    uint16_t length = sfr_get(model, EDMALEN);
+    uint32_t sum = 0U;
+    uint16_t i;
+
+    if ((econ1 & DMACSSD) != 0U) {
+        // the seed is a previous result, EDMACSL holds its first byte
+        uint16_t seed = (uint16_t) ((model->sfr[EDMACS] << 8) | model->sfr[EDMACS + 1U]);
+        sum = (uint16_t) ~seed;
+    }
+
+    for (i = 0; i < length; i++) {
+
+        uint8_t byte = model->sram[source];
+
+        if ((econ1 & DMACPY) != 0U) {
+            model->sram[destination] = byte;
+            destination = next_linear(model, destination);
+        }
+
+        // big endian 16 bit words, an odd last byte is padded with zero
+        sum += ((i & 1U) == 0U) ? ((uint32_t) byte << 8) : byte;
+        source = next_linear(model, source);
+    }
+
+    if ((econ1 & DMANOCS) == 0U || (econ1 & DMACPY) == 0U) {
+
+        while ((sum >> 16) != 0U) {
+            sum = (sum & 0xFFFFU) + (sum >> 16);
+        }
+
+        // stored in packet order so it can be copied into a header as is
+        uint16_t checksum = (uint16_t) ~sum;
+        model->sfr[EDMACS] = (uint8_t) (checksum >> 8);
+        model->sfr[EDMACS + 1U] = (uint8_t) (checksum & 0xFFU);
+    }
+
+    sfr_put(model, ECON1, econ1 & (uint16_t) ~DMAST);
+    sfr_put(model, EIR, sfr_get(model, EIR) | DMAIF);
+}
+
+/* Register file */
+
+// brings time dependent state up to date before a register is read
+static void settle(enc624j600_model *model) {
+
+    uint16_t econ1 = sfr_get(model, ECON1);
+
+    if ((econ1 & TXRTS) != 0U && model->now_ps >= model->transmit_done_ps) {
+        sfr_put(model, ECON1, econ1 & (uint16_t) ~TXRTS);
+        sfr_put(model, EIR, sfr_get(model, EIR) | TXIF);
+    }
+
+    uint16_t mistat = sfr_get(model, MISTAT) & (uint16_t) ~BUSY;
+
+    if (model->now_ps < model->mii_done_ps) {
+        mistat |= BUSY;
+    }
+
+    sfr_put(model, MISTAT, mistat);
+
+    uint16_t estat = CLKRDY | model->packet_count;
+
+    if (model->link_up == 1U) {
+        estat |= PHYLNK;
+
+        if (model->full_duplex == 1U) {
+            estat |= PHYDPX;
+        }
+    }
+
+    sfr_put(model, ESTAT, estat);
+}
+
+static uint8_t register_read(enc624j600_model *model, uint8_t address) {
+
+    if (address >= ENC624J600_MODEL_SFR_SIZE) {
+        return 0U;
+    }
+
+    settle(model);
+    return model->sfr[address];
+}
+
+static uint8_t read_only(uint8_t address) {
+
+    switch (address & 0xFEU) {
+        case ERXHEAD:
+        case ETXSTAT:
+        case ETXWIRE:
+        case ESTAT:
+        case MIRD:
+        case MISTAT:
+            return 1U;
+    }
+
+    return (address == EIDLED) ? 1U : 0U;
+}
+
+// acts on a byte that just changed, control bits start their operation
+static void register_written(enc624j600_model *model, uint8_t address, uint8_t previous) {
+
+    uint8_t value = model->sfr[address];
+    uint8_t raised = (uint8_t) (value & ~previous);
+
+    switch (address) {
+
+        case ECON1:
+            if ((raised & TXRTS) != 0U) {
+                transmit(model);
+            }
+            if ((raised & DMAST) != 0U) {
+                dma(model);
+            }
+            break;
+
+        case ECON1 + 1U:
+            if ((raised & (PKTDEC >> 8)) != 0U) {
+                if (model->packet_count > 0U) {
+                    model->packet_count--;
+                }
+                model->sfr[address] &= (uint8_t) ~(PKTDEC >> 8);
+            }
+            break;
+
+        case ECON2:
+            if ((raised & ETHRST) != 0U) {
+                system_reset(model);
+            }
+            break;
+
+        case ERXST + 1U:
+            // the head follows the start of the receive buffer
+            sfr_put(model, ERXHEAD, sfr_get(model, ERXST));
+            break;
+
+        case MICMD:
+            if ((raised & MIIRD) != 0U) {
+                sfr_put(model, MIRD, model->phy[model->sfr[MIREGADR] & 0x1FU]);
+                model->mii_done_ps = model->now_ps + MII_CYCLE_PS;
+            }
+            break;
+
+        case MIWR + 1U:
+            // writing the high byte starts the MII write
+            phy_write(model, model->sfr[MIREGADR], sfr_get(model, MIWR));
+            model->mii_done_ps = model->now_ps + MII_CYCLE_PS;
+            break;
+    }
+}
+
+typedef enum {
+    WRITE_VALUE,
+    WRITE_SET,
+    WRITE_CLEAR
+} write_mode;
+
+static void register_write(enc624j600_model *model, uint8_t address, uint8_t data, write_mode mode) {
+
+    if (address >= ENC624J600_MODEL_SFR_SIZE || read_only(address) == 1U) {
+        return;
+    }
+
+    // bit field operations have no effect on the MAC and MII registers or the unbanked block
+    if (mode != WRITE_VALUE && ((address >= MACON1 && address < EPAUS) || address >= EGPDATA_SFR)) {
+        return;
+    }
+
+    settle(model);
+
+    uint8_t previous = model->sfr[address];
+
+    switch (mode) {
+        case WRITE_VALUE:
+            model->sfr[address] = data;
+            break;
+        case WRITE_SET:
+            model->sfr[address] |= data;
+            break;
+        case WRITE_CLEAR:
+            model->sfr[address] &= (uint8_t) ~data;
+            break;
+    }
+
+    register_written(model, address, previous);
+}
+
+/* SRAM windows */
+
+static void window_registers(uint8_t opcode, uint8_t *pointer, sram_area *area) {
+
+    switch (opcode) {
+        case RGPDATA:   *pointer = EGPRDPT_SFR;  *area = AREA_GENERAL; break;
+        case WGPDATA:   *pointer = EGPWRPT_SFR;  *area = AREA_GENERAL; break;
+        case RRXDATA:   *pointer = ERXRDPT_SFR;  *area = AREA_RECEIVE; break;
+        case WRXDATA:   *pointer = ERXWRPT_SFR;  *area = AREA_RECEIVE; break;
+        case RUDADATA:  *pointer = EUDARDPT_SFR; *area = AREA_USER;    break;
+        default:        *pointer = EUDAWRPT_SFR; *area = AREA_USER;    break;
+    }
+}
+
+static uint8_t window_access(enc624j600_model *model, uint8_t opcode, uint8_t data) {
+
+    uint8_t pointer;
+    sram_area area;
+    uint8_t result = 0U;
+
+    window_registers(opcode, &pointer, &area);
+
+    uint16_t address = sfr_get(model, pointer);
+
+    if (address < ENC624J600_MODEL_SRAM_SIZE) {
+
+        // the low opcode bit selects the write
+        if ((opcode & 0x02U) != 0U) {
+            model->sram[address] = data;
+        } else {
+            result = model->sram[address];
+        }
+    }
+
+    sfr_put(model, pointer, next_address(model, area, address));
+    return result;
+}
+
+/* Instruction decoding */
+
+static instruction_kind classify(uint8_t opcode) {
+
+    if (opcode >= B0SEL && opcode <= CLREIE && (opcode & 1U) == 0U && opcode != RBSEL) {
+        return KIND_SINGLE;
+    }
+
+    if (opcode == RBSEL) {
+        return KIND_RBSEL;
+    }
+
+    if (opcode >= WGPRDPT && opcode <= RUDAWRPT && (opcode & 1U) == 0U) {
+        return KIND_POINTER;
+    }
+
+    if (opcode >= RCRU && opcode <= BFCU && (opcode & 1U) == 0U) {
+        return KIND_REGISTER;
+    }
+
+    if (opcode >= RGPDATA && opcode <= WUDADATA && (opcode & 1U) == 0U) {
+        return KIND_WINDOW;
+    }
+
+    // banked RCR, WCR, BFS and BFC carry a 5 bit address
+    if (opcode < 0x20U || (opcode >= 0x40U && opcode < 0x60U) || (opcode >= 0x80U && opcode < 0xC0U)) {
+        return KIND_REGISTER;
+    }
+
+    return KIND_UNKNOWN;
+}
+
+static void set_econ1(enc624j600_model *model, uint16_t set, uint16_t clear) {
+
+    uint8_t previous = model->sfr[ECON1];
+
+    sfr_put(model, ECON1, (uint16_t) ((sfr_get(model, ECON1) & ~clear) | set));
+    register_written(model, ECON1, previous);
+}
+
+static void execute_single(enc624j600_model *model, uint8_t opcode) {
+
+    switch (opcode) {
+
+        case B0SEL:
+        case B1SEL:
+        case B2SEL:
+        case B3SEL:
+            model->bank = (uint8_t) ((opcode - B0SEL) >> 1);
+            break;
+
+        case SETETHRST:
+            system_reset(model);
+            break;
+
+        case SETPKTDEC:
+            if (model->packet_count > 0U) {
+                model->packet_count--;
+            }
+            break;
+
+        case SETTXRTS:
+            settle(model);
+            set_econ1(model, TXRTS, 0U);
+            break;
+
+        case ENABLERX:
+            set_econ1(model, RXEN, 0U);
+            break;
+
+        case DISABLERX:
+            set_econ1(model, 0U, RXEN);
+            break;
+
+        case DMASTOP:
+            set_econ1(model, 0U, DMAST);
+            break;
+
+        case DMACKSUM:
+            set_econ1(model, DMAST, DMACPY | DMANOCS | DMACSSD);
+            break;
+
+        case DMACKSUMS:
+            set_econ1(model, DMAST | DMACSSD, DMACPY | DMANOCS);
+            break;
+
+        case DMACOPY:
+            set_econ1(model, DMAST | DMACPY, DMANOCS | DMACSSD);
+            break;
+
+        case DMACOPYS:
+            set_econ1(model, DMAST | DMACPY | DMACSSD, DMANOCS);
+            break;
+
+        case FCDISABLE:
+        case FCSINGLE:
+        case FCCLEAR:
+            // single pause frames complete at once, PAUSE is not put on the wire
+            set_econ1(model, 0U, FCOP0 | FCOP1);
+            break;
+
+        case FCMULTIPLE:
+            set_econ1(model, FCOP1, FCOP0);
+            break;
+
+        case SETEIE:
+            sfr_put(model, EIE, sfr_get(model, EIE) | INTIE);
+            break;
+
+        case CLREIE:
+            sfr_put(model, EIE, sfr_get(model, EIE) & (uint16_t) ~INTIE);
+            break;
+
+        default:
+            model->stats.unknown_opcodes++;
+            break;
+    }
+}
+
+static uint8_t banked_address(const enc624j600_model *model, uint8_t opcode) {
+
+    uint8_t offset = opcode & 0x1FU;
+
+    // the last six addresses of every bank map to ESTAT, EIR and ECON1
+    if (offset >= ESTAT) {
+        return offset;
+    }
+
+    return (uint8_t) (model->bank * 0x20U + offset);
+}
+
+static write_mode register_mode(uint8_t opcode) {
+
+    switch (opcode) {
+        case WCRU:
+            return WRITE_VALUE;
+        case BFSU:
+            return WRITE_SET;
+        case BFCU:
+            return WRITE_CLEAR;
+    }
+
+    switch (opcode & 0xE0U) {
+        case 0x40U:
+            return WRITE_VALUE;
+        case 0x80U:
+            return WRITE_SET;
+        default:
+            return WRITE_CLEAR;
+    }
+}
+
+static uint8_t is_register_read(uint8_t opcode) {
+    return (opcode == RCRU || opcode < 0x20U) ? 1U : 0U;
+}
+
+static uint8_t start_instruction(enc624j600_model *model, uint8_t opcode) {
+
+    switch (classify(opcode)) {
+
+        case KIND_SINGLE:
+            execute_single(model, opcode);
+            break;
+
+        case KIND_REGISTER:
+            if (opcode < RCRU || opcode > BFCU) {
+                model->address = banked_address(model, opcode);
+            }
+            break;
+
+        case KIND_UNKNOWN:
+            model->stats.unknown_opcodes++;
+            break;
+
+        default:
+            break;
+    }
+
+    return 0U;
+}
+
+static uint8_t continue_instruction(enc624j600_model *model, uint16_t position, uint8_t data) {
+
+    uint8_t opcode = model->opcode;
+    uint8_t result = 0U;
+
+    switch (classify(opcode)) {
+
+        case KIND_RBSEL:
+            if (position == 1U) {
+                result = (uint8_t) (B0SEL + (model->bank << 1));
+            }
+            break;
+
+        case KIND_POINTER: {
+
+            uint8_t pointer = pointer_registers[(opcode - WGPRDPT) >> 2];
+
+            if (position <= 2U) {
+
+                if ((opcode & 0x02U) != 0U) {
+                    result = model->sfr[pointer + position - 1U];
+                } else {
+                    model->sfr[pointer + position - 1U] = data;
+                }
+            }
+            break;
+        }
+
+        case KIND_REGISTER:
+            // unbanked instructions send the address first
+            if (opcode >= RCRU && opcode <= BFCU && position == 1U) {
+                model->address = data;
+                break;
+            }
+
+            if (is_register_read(opcode) == 1U) {
+                result = register_read(model, model->address);
+            } else {
+                register_write(model, model->address, data, register_mode(opcode));
+            }
+
+            model->address++;
+            break;
+
+        case KIND_WINDOW:
+            result = window_access(model, opcode, data);
+            break;
+
+        default:
+            break;
+    }
+
+    return result;
+}
+
+/* SPI interface */
+
+uint8_t enc624j600_model_spi_transfer(enc624j600_model *model, uint8_t data) {
+
+    advance(model, model->ps_per_byte);
+    model->stats.spi_ps += model->ps_per_byte;
+    model->stats.bytes++;
+
+    // the SO pin floats without chip select
+    if (model->selected == 0U) {
+        return 0xFFU;
+    }
+
+    uint16_t position = model->position++;
+
+    if (position == 0U) {
+        model->opcode = data;
+        return start_instruction(model, data);
+    }
+
+    return continue_instruction(model, position, data);
+}
+
+void enc624j600_model_cs_assert(enc624j600_model *model) {
+
+    advance(model, CS_SETUP_PS);
+    model->stats.spi_ps += CS_SETUP_PS;
+    model->stats.transactions++;
+
+    model->selected = 1U;
+    model->position = 0U;
+}
+
+void enc624j600_model_cs_deassert(enc624j600_model *model) {
+
+    advance(model, CS_DISABLE_PS);
+    model->stats.spi_ps += CS_DISABLE_PS;
+
+    model->selected = 0U;
+}
+
+void enc624j600_model_delay(enc624j600_model *model, uint8_t us) {
+
+    advance(model, (uint64_t) us * 1000000ULL);
+    model->stats.delay_ps += (uint64_t) us * 1000000ULL;
+}
+
+/* Model control */
+
+void enc624j600_model_init(enc624j600_model *model, const uint8_t mac[6]) {
+
+    memset(model, 0, sizeof(*model));
+    memcpy(model->factory_mac, mac, 6U);
+
+    model->link_up = 1U;
+    model->full_duplex = 1U;
+
+    enc624j600_model_set_spi_clock(model, ENC624J600_MODEL_SPI_HZ);
+    system_reset(model);
+}
+
+void enc624j600_model_set_spi_clock(enc624j600_model *model, uint32_t hz) {
+    model->ps_per_byte = 8000000000000ULL / hz;
+}
+
+void enc624j600_model_set_link(enc624j600_model *model, uint8_t up, uint8_t full_duplex) {
+
+    if (model->link_up != up) {
+        sfr_put(model, EIR, sfr_get(model, EIR) | LINKIF);
+    }
+
+    model->link_up = up;
+    model->full_duplex = full_duplex;
+
+    phy_update_link(model);
+}
+
+void enc624j600_model_set_transmit_handler(enc624j600_model *model, enc624j600_model_transmit_handler handler,
+        void *context) {
+
+    model->transmit = handler;
+    model->transmit_context = context;
+}
+
+static uint8_t accepted(const enc624j600_model *model, const uint8_t *frame, uint16_t length) {
+
+    static const uint8_t broadcast[6] = { 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU };
+    uint16_t filters = sfr_get(model, ERXFCON);
+    uint16_t maximum = sfr_get(model, MAMXFL);
+    uint8_t own[6];
+
+    if (length + FCS_SIZE < 64U && (filters & RUNTEN) != 0U) {
+        return 0U;
+    }
+
+    if (length + FCS_SIZE > maximum && (sfr_get(model, MACON2) & HFRMEN) == 0U) {
+        return 0U;
+    }
+
+    if ((sfr_get(model, MACON1) & PASSALL) != 0U && (filters & (UCEN | NOTMEEN | MCEN | BCEN)) == (UCEN | NOTMEEN | MCEN | BCEN)) {
+        return 1U;
+    }
+
+    if (memcmp(frame, broadcast, 6U) == 0) {
+        return ((filters & BCEN) != 0U) ? 1U : 0U;
+    }
+
+    if ((frame[0] & 0x01U) != 0U) {
+        return ((filters & MCEN) != 0U) ? 1U : 0U;
+    }
+
+    own[0] = model->sfr[MAADR1];
+    own[1] = model->sfr[MAADR1 + 1U];
+    own[2] = model->sfr[MAADR2];
+    own[3] = model->sfr[MAADR2 + 1U];
+    own[4] = model->sfr[MAADR3];
+    own[5] = model->sfr[MAADR3 + 1U];
+
+    if (memcmp(frame, own, 6U) == 0) {
+        return ((filters & UCEN) != 0U) ? 1U : 0U;
+    }
+
+    return ((filters & NOTMEEN) != 0U) ? 1U : 0U;
+}
+
+static uint16_t ring_write(enc624j600_model *model, uint16_t address, const uint8_t *data, uint16_t length) {
+
+    uint16_t i;
+
+    for (i = 0; i < length; i++) {
+        model->sram[address] = data[i];
+        address = next_address(model, AREA_RECEIVE, address);
+    }
+
+    return address;
+}
+
+int enc624j600_model_receive(enc624j600_model *model, const uint8_t *frame, uint16_t length) {
+
+    uint16_t start = sfr_get(model, ERXST);
+    uint16_t head = sfr_get(model, ERXHEAD);
+    uint16_t tail = sfr_get(model, ERXTAIL);
+    uint16_t ring = ENC624J600_MODEL_SRAM_SIZE - start;
+    uint16_t stored = (uint16_t) (2U + RSV_SIZE + length + FCS_SIZE);
+    uint16_t space;
+
+    if (length > ENC624J600_MODEL_FRAME_MAX || (sfr_get(model, ECON1) & RXEN) == 0U
+            || accepted(model, frame, length) == 0U) {
+        model->stats.frames_dropped++;
+        return -1;
+    }
+
+    // a tail left just below ERXST stands for the last even address of the ring
+    if (tail < start) {
+        tail = (uint16_t) (tail + ring);
+    }
+
+    // frames start on even addresses
+    stored = (uint16_t) ((stored + 1U) & ~1U);
+    space = (tail > head) ? (uint16_t) (tail - head) : (uint16_t) (ring - (head - tail));
+
+    // the head must never reach the tail, that reads as an empty ring
+    if (stored >= space || model->packet_count == 0xFFU) {
+
+        sfr_put(model, EIR, sfr_get(model, EIR) | RXABTIF);
+
+        if (model->packet_count == 0xFFU) {
+            sfr_put(model, EIR, sfr_get(model, EIR) | PCFULIF);
+        }
+
+        model->stats.frames_dropped++;
+        return -1;
+    }
+
+    uint16_t next = (uint16_t) (head + stored);
+
+    if (next >= ENC624J600_MODEL_SRAM_SIZE) {
+        next = (uint16_t) (next - ring);
+    }
+
+    uint32_t fcs = crc32(frame, length);
+    uint16_t wire_length = (uint16_t) (length + FCS_SIZE);
+    uint8_t header[2U + RSV_SIZE];
+    uint8_t trailer[FCS_SIZE];
+
+    header[0] = (uint8_t) (next & 0xFFU);
+    header[1] = (uint8_t) (next >> 8);
+    header[2] = (uint8_t) (wire_length & 0xFFU);
+    header[3] = (uint8_t) (wire_length >> 8);
+    header[4] = 0x80U;      // received ok
+    header[5] = 0U;
+    header[6] = 0U;
+    header[7] = 0U;
+
+    if ((frame[0] & 0x01U) != 0U) {
+        header[5] |= (frame[0] == 0xFFU) ? 0x02U : 0x01U;   // broadcast or multicast
+    }
+
+    trailer[0] = (uint8_t) (fcs & 0xFFU);
+    trailer[1] = (uint8_t) ((fcs >> 8) & 0xFFU);
+    trailer[2] = (uint8_t) ((fcs >> 16) & 0xFFU);
+    trailer[3] = (uint8_t) (fcs >> 24);
+
+    uint16_t address = ring_write(model, head, header, sizeof(header));
+    address = ring_write(model, address, frame, length);
+    ring_write(model, address, trailer, FCS_SIZE);
+
+    sfr_put(model, ERXHEAD, next);
+    sfr_put(model, EIR, sfr_get(model, EIR) | PKTIF);
+
+    model->packet_count++;
+    model->stats.frames_received++;
+
+    return 0;
+}
+
+void enc624j600_model_reset_stats(enc624j600_model *model) {
+    memset(&model->stats, 0, sizeof(model->stats));
+}
+
+void enc624j600_model_get_stats(const enc624j600_model *model, enc624j600_model_stats *stats) {
+    *stats = model->stats;
+}
+
+uint64_t enc624j600_model_now_us(const enc624j600_model *model) {
+    return model->now_ps / 1000000ULL;
+}
+
+void enc624j600_model_idle_until(enc624j600_model *model, uint64_t ps) {
+
+    if (ps > model->now_ps) {
+        model->now_ps = ps;
+    }
+}
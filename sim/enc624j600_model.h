@@ -0,0 +1,178 @@
+#pragma once
+
+#include <stdint.h>
+
+/** Size of the ENC624J600 SRAM, general purpose and receive buffer */
+#define ENC624J600_MODEL_SRAM_SIZE      0x6000U
+
+/** SFR address space reachable with RCRU/WCRU, banked registers and the unbanked block at 0x80 */
+#define ENC624J600_MODEL_SFR_SIZE       0xA0U
+
+/** SPI clock main.c asks SPI2_TransferSetup() for */
+#define ENC624J600_MODEL_SPI_REQUEST_HZ 10000000UL
+
+/** Clock SPI2_TransferSetup() divides when passed 0, the PBCLK (SYSCLK / 1) set in the project */
+#define ENC624J600_MODEL_SPI_SOURCE_HZ  76000000UL
+
+/** SPI2BRG SPI2_TransferSetup() picks, the divider whose clock is closest to the requested one */
+#define ENC624J600_MODEL_SPI_BRG_BELOW  (((ENC624J600_MODEL_SPI_SOURCE_HZ / ENC624J600_MODEL_SPI_REQUEST_HZ) / 2UL) - 1UL)
+#define ENC624J600_MODEL_SPI_BRG        ((((ENC624J600_MODEL_SPI_SOURCE_HZ / (2UL * (ENC624J600_MODEL_SPI_BRG_BELOW + 1UL))) - \
+                                            ENC624J600_MODEL_SPI_REQUEST_HZ) > \
+                                          (ENC624J600_MODEL_SPI_REQUEST_HZ - \
+                                            (ENC624J600_MODEL_SPI_SOURCE_HZ / (2UL * (ENC624J600_MODEL_SPI_BRG_BELOW + 2UL))))) ? \
+                                         ENC624J600_MODEL_SPI_BRG_BELOW + 1UL : ENC624J600_MODEL_SPI_BRG_BELOW)
+
+/** SPI clock the target runs SPI2 at: 9.5 MHz, SPI2BRG 3 */
+#define ENC624J600_MODEL_SPI_HZ         (ENC624J600_MODEL_SPI_SOURCE_HZ / (2UL * (ENC624J600_MODEL_SPI_BRG + 1UL)))
+
+/** Longest frame the model moves, MAMXFL with huge frames enabled is not supported */
+#define ENC624J600_MODEL_FRAME_MAX      1536U
+
+/**
+ *  @brief Called for every frame the MAC puts on the wire.
+ *
+ *  @param context Pointer passed to enc624j600_model_set_transmit_handler().
+ *  @param frame Destination address up to the end of the padding, without FCS.
+ *  @param length Frame length in bytes, at least 60 when padding is enabled.
+ */
+typedef void (*enc624j600_model_transmit_handler)(void *context, const uint8_t *frame, uint16_t length);
+
+/**
+ *  @struct enc624j600_model_stats
+ *  @brief Cost counters, zeroed with enc624j600_model_reset_stats().
+ */
+typedef struct {
+    uint64_t spi_ps;            /**< Simulated time the SPI bus was clocking or chip select was held, picoseconds */
+    uint64_t delay_ps;          /**< Simulated time spent in enc624j600_model_delay() */
+    uint32_t transactions;      /**< Chip select bounded transactions */
+    uint32_t bytes;             /**< Bytes clocked on the bus, opcodes included */
+    uint32_t frames_sent;
+    uint32_t frames_received;   /**< Frames from the wire stored in the receive buffer */
+    uint32_t frames_dropped;    /**< Frames from the wire that were filtered or did not fit */
+    uint32_t unknown_opcodes;   /**< Instructions the model does not decode, they are ignored */
+} enc624j600_model_stats;
+
+/**
+ *  @struct enc624j600_model
+ *  @brief State of one simulated ENC624J600. Treat the members as private.
+ */
+typedef struct {
+    uint8_t sram[ENC624J600_MODEL_SRAM_SIZE];
+    uint8_t sfr[ENC624J600_MODEL_SFR_SIZE];
+    uint16_t phy[32];
+    uint8_t factory_mac[6];
+
+    uint8_t link_up : 1;
+    uint8_t full_duplex : 1;
+    uint8_t selected : 1;
+    uint8_t bank;
+    uint8_t packet_count;
+
+    // instruction in progress
+    uint8_t opcode;
+    uint8_t address;
+    uint16_t position;
+
+    // simulated time, advanced by the bus and by delays
+    uint64_t now_ps;
+    uint64_t transmit_done_ps;
+    uint64_t mii_done_ps;
+    uint64_t ps_per_byte;
+
+    enc624j600_model_transmit_handler transmit;
+    void *transmit_context;
+
+    enc624j600_model_stats stats;
+} enc624j600_model;
+
+/**
+ *  @brief Powers the device on: registers at their reset values, link up in
+ *  100 Mb/s full duplex, SPI clock at ENC624J600_MODEL_SPI_HZ.
+ *
+ *  @param model Device to initialize.
+ *  @param mac Factory MAC address, loaded into MAADR on every reset.
+ */
+extern void enc624j600_model_init(enc624j600_model *model, const uint8_t mac[6]);
+
+/**
+ *  @brief Clocks one byte through the SPI interface, enc624j600_hal_spi_transfer() of a host HAL.
+ *
+ *  @note The model is not thread safe, the HAL serializes the driver and
+ *        the enc624j600_model_* calls on one device.
+ *
+ *  @return Byte on SO, 0xFF while chip select is deasserted.
+ */
+extern uint8_t enc624j600_model_spi_transfer(enc624j600_model *model, uint8_t data);
+
+/**
+ *  @brief Starts a transaction, enc624j600_hal_cs_assert() of a host HAL.
+ */
+extern void enc624j600_model_cs_assert(enc624j600_model *model);
+
+/**
+ *  @brief Ends a transaction, enc624j600_hal_cs_deassert() of a host HAL.
+ */
+extern void enc624j600_model_cs_deassert(enc624j600_model *model);
+
+/**
+ *  @brief Advances the simulated time, enc624j600_hal_delay() of a host HAL.
+ */
+extern void enc624j600_model_delay(enc624j600_model *model, uint8_t us);
+
+/**
+ *  @brief Sets the simulated SPI clock used for the time counters.
+ */
+extern void enc624j600_model_set_spi_clock(enc624j600_model *model, uint32_t hz);
+
+/**
+ *  @brief Changes the link state the PHY and ESTAT report.
+ *
+ *  @param up 1 for link up.
+ *  @param full_duplex 1 if auto-negotiation resolved to full duplex.
+ */
+extern void enc624j600_model_set_link(enc624j600_model *model, uint8_t up, uint8_t full_duplex);
+
+/**
+ *  @brief Registers the receiver of transmitted frames, NULL discards them.
+ */
+extern void enc624j600_model_set_transmit_handler(enc624j600_model *model, enc624j600_model_transmit_handler handler,
+        void *context);
+
+/**
+ *  @brief Delivers a frame from the wire to the receive logic.
+ *
+ *  The frame passes the ERXFCON filters and is written to the receive
+ *  ring with the next packet pointer, the receive status vector and an
+ *  FCS, PKTCNT is incremented.
+ *
+ *  @param frame Destination address up to the end of the payload, without FCS.
+ *  @param length Frame length in bytes.
+ *
+ *  @return 0 if the frame was stored, -1 if reception is disabled, it was filtered or did not fit.
+ */
+extern int enc624j600_model_receive(enc624j600_model *model, const uint8_t *frame, uint16_t length);
+
+/**
+ *  @brief Zeroes the cost counters.
+ */
+extern void enc624j600_model_reset_stats(enc624j600_model *model);
+
+/**
+ *  @brief Copies the cost counters.
+ */
+extern void enc624j600_model_get_stats(const enc624j600_model *model, enc624j600_model_stats *stats);
+
+/**
+ *  @return Simulated time since power on in microseconds.
+ */
+extern uint64_t enc624j600_model_now_us(const enc624j600_model *model);
+
+/**
+ *  @brief Lets the simulated time run to ps while the driver does nothing.
+ *
+ *  The idle time is not added to the cost counters. A time already
+ *  passed leaves the clock alone.
+ *
+ *  @param ps Simulated time since power on in picoseconds.
+ */
+extern void enc624j600_model_idle_until(enc624j600_model *model, uint64_t ps);
@@ -0,0 +1,31 @@
+/*
+ *  FreeRTOS configuration of the host build.
+ *
+ *  The firmware configuration is used as is, only what the POSIX port
+ *  cannot provide is replaced.
+ */
+
+#ifndef SIM_FREERTOS_CONFIG_H
+#define SIM_FREERTOS_CONFIG_H
+
+#include <stdint.h>
+
+#include "../../include/FreeRTOSConfig.h"
+
+// the tick comes from a host timer, there is nothing to suppress
+#undef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE                 0
+
+// the host monotonic clock at the core timer rate, top and the CPU load read the same units as on the target
+extern uint32_t sim_core_timer(void);
+
+#undef portGET_RUN_TIME_COUNTER_VALUE
+#define portGET_RUN_TIME_COUNTER_VALUE()        sim_core_timer()
+
+// report and stop instead of spinning with the tick masked
+extern void sim_assert_failed(const char *file, int line);
+
+#undef configASSERT
+#define configASSERT(x)     do { if ((x) == 0) { sim_assert_failed(__FILE__, __LINE__); } } while (0)
+
+#endif /* SIM_FREERTOS_CONFIG_H */
@@ -0,0 +1,24 @@
+#pragma once
+
+/*
+ *  Host stand-in for the Harmony definitions.h: the types of the real
+ *  UART plib header and GPIO functions that record the pin state.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "peripheral/uart/plib_uart1.h"
+
+typedef uint32_t GPIO_PIN;
+
+#define GPIO_PIN_RD0    (48)
+#define GPIO_PIN_RD1    (49)
+#define GPIO_PIN_RD2    (50)
+#define GPIO_PIN_RF12   (92)
+
+extern void GPIO_PinSet(GPIO_PIN pin);
+extern void GPIO_PinClear(GPIO_PIN pin);
+extern void GPIO_PinToggle(GPIO_PIN pin);
+extern bool GPIO_PinRead(GPIO_PIN pin);
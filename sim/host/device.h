@@ -0,0 +1,10 @@
+#pragma once
+
+/*
+ *  Host stand-in for the Harmony device header. Nothing in the host build
+ *  touches PIC32 registers, plib headers only need it to exist.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
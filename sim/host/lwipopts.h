@@ -0,0 +1,16 @@
+/*
+ *  lwIP configuration of the host build.
+ *
+ *  The firmware configuration with pool statistics on: the benchmark reads
+ *  the high-water mark and the allocation failures of every pool through
+ *  the control socket, see sim_control.c.
+ */
+
+#ifndef SIM_LWIPOPTS_H
+#define SIM_LWIPOPTS_H
+
+#define LWIP_POOL_STATS                1
+
+#include "../../include/lwipopts.h"
+
+#endif /* SIM_LWIPOPTS_H */
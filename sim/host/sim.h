@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "enc624j600_model.h"
+
+/** Core timer rate the run time counter is scaled to, SYSCLK / 2 */
+#define SIM_CORE_TIMER_HZ               (configCPU_CLOCK_HZ / 2U)
+
+#define SIM_WIRE_TASK_STACK_SIZE        configMINIMAL_STACK_SIZE
+
+/** Above the network task, a frame is in the device before the driver looks */
+#define SIM_WIRE_TASK_PRIORITY          3U
+
+#define SIM_UART_TASK_STACK_SIZE        configMINIMAL_STACK_SIZE
+
+#define SIM_UART_TASK_PRIORITY          1U
+
+/** stdin polling interval */
+#define SIM_UART_POLL_MS                10U
+
+#define SIM_CONTROL_TASK_STACK_SIZE     configMINIMAL_STACK_SIZE
+
+/** Below everything of the firmware, a request waits for a quiet moment */
+#define SIM_CONTROL_TASK_PRIORITY       1U
+
+/** Control socket polling interval */
+#define SIM_CONTROL_POLL_MS             10U
+
+/** Tasks the control socket reports, the rest are left out */
+#define SIM_CONTROL_TASKS_MAX           24U
+
+#define SIM_CONTROL_REPLY_MAX           6144U
+
+/** Device behind the host HAL */
+extern enc624j600_model sim_device;
+
+/**
+ *  @brief Powers the device on and creates the lock the HAL holds for a transaction.
+ *
+ *  @param mac Factory MAC address of the device.
+ *
+ *  @return 0 on success, -1 if the lock could not be created.
+ */
+extern int sim_hal_init(const uint8_t mac[6]);
+
+/**
+ *  @brief Takes the device for anything that is not the driver, e.g. a frame arriving from the wire.
+ *
+ *  The same lock the HAL holds from chip select assert to deassert.
+ */
+extern void sim_device_lock(void);
+
+extern void sim_device_unlock(void);
+
+/**
+ *  @brief Connects the device to a frame socket.
+ *
+ *  Transmitted frames are sent as one datagram each, a task moves
+ *  datagrams from the socket into the receive logic of the device.
+ *
+ *  @param fd SOCK_SEQPACKET or SOCK_DGRAM socket, -1 leaves the device unconnected.
+ *
+ *  @return 0 on success, -1 if the task could not be created.
+ */
+extern int sim_wire_init(int fd);
+
+/**
+ *  @return Frames the socket did not take, the peer was not reading.
+ */
+extern uint32_t sim_wire_dropped(void);
+
+/**
+ *  @brief Sets the text put in front of every line written to UART1, NULL for none.
+ */
+extern void sim_uart_set_prefix(const char *prefix);
+
+/**
+ *  @brief Opens the control socket the benchmark reads the counters from, see sim_control.c.
+ *
+ *  @param path Unix datagram socket to bind, replaced if it exists. NULL for none.
+ *
+ *  @return 0 on success, -1 if the socket or its task could not be created.
+ */
+extern int sim_control_init(const char *path);
+
+/**
+ *  @struct sim_cost_figures
+ *  @brief Counters of one operation of the cycle cost model.
+ */
+typedef struct {
+    const char *name;
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t cycles;            /**< Estimated M4K cycles for the calls and bytes */
+} sim_cost_figures;
+
+/**
+ *  @brief Zeroes the operation counters of the cycle cost model, see sim_cost.c.
+ */
+extern void sim_cost_reset(void);
+
+/**
+ *  @return Number of operations the cost model counts.
+ */
+extern uint8_t sim_cost_operation_count(void);
+
+/**
+ *  @brief Copies the counters of an operation and prices them.
+ *
+ *  @param index 0 to sim_cost_operation_count() - 1.
+ */
+extern void sim_cost_get(uint8_t index, sim_cost_figures *figures);
@@ -0,0 +1,261 @@
+/*
+ *  Control socket of the host build.
+ *
+ *  A Unix datagram socket the benchmark talks to while the firmware runs.
+ *  Every request is one datagram, every reply one JSON object:
+ *
+ *      stats   counters since the last reset
+ *      reset   starts a new measurement, replies like stats
+ *
+ *  The reply has the cost counters of the device model, the frames the
+ *  wire socket did not take, the time since the reset and the run time of
+ *  every task in core timer ticks, and the usage, high-water mark and
+ *  allocation failures of the lwIP heap and of every memp pool, and the
+ *  operation counts of the cycle cost model with their M4K cycles (see
+ *  sim_cost.c). A reset zeroes the counters and lowers the high-water
+ *  marks to what is in use right now.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/tcpip.h"
+#include "sim.h"
+
+static const char *const pool_names[] = {
+#define LWIP_MEMPOOL(name, num, size, desc)     #name,
+#include "lwip/priv/memp_std.h"
+};
+
+typedef struct {
+    TaskHandle_t task;
+    configRUN_TIME_COUNTER_TYPE run_time;
+} task_baseline;
+
+static int control = -1;
+
+static task_baseline baselines[SIM_CONTROL_TASKS_MAX];
+static UBaseType_t baseline_count = 0U;
+static uint32_t baseline_time = 0U;
+
+static TaskStatus_t tasks[SIM_CONTROL_TASKS_MAX];
+static char reply[SIM_CONTROL_REPLY_MAX];
+
+static StaticTask_t control_tcb;
+static StackType_t control_stack[SIM_CONTROL_TASK_STACK_SIZE];
+
+
+static configRUN_TIME_COUNTER_TYPE baseline_of(TaskHandle_t task) {
+
+    UBaseType_t i;
+
+    for (i = 0U; i < baseline_count; i++) {
+
+        if (baselines[i].task == task) {
+            return baselines[i].run_time;
+        }
+    }
+
+    return 0U;
+}
+
+static void reset(void) {
+
+    UBaseType_t count = uxTaskGetSystemState(tasks, SIM_CONTROL_TASKS_MAX, NULL);
+    UBaseType_t i;
+
+    sim_device_lock();
+    enc624j600_model_reset_stats(&sim_device);
+    sim_device_unlock();
+
+    taskENTER_CRITICAL();
+    sim_cost_reset();
+    taskEXIT_CRITICAL();
+
+    LOCK_TCPIP_CORE();
+
+    lwip_stats.mem.max = lwip_stats.mem.used;
+    lwip_stats.mem.err = 0U;
+
+    for (i = 0U; i < MEMP_MAX; i++) {
+        lwip_stats.memp[i]->max = lwip_stats.memp[i]->used;
+        lwip_stats.memp[i]->err = 0U;
+    }
+
+    UNLOCK_TCPIP_CORE();
+
+    for (i = 0U; i < count; i++) {
+        baselines[i].task = tasks[i].xHandle;
+        baselines[i].run_time = tasks[i].ulRunTimeCounter;
+    }
+
+    baseline_count = count;
+    baseline_time = portGET_RUN_TIME_COUNTER_VALUE();
+}
+
+static size_t append(size_t length, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static size_t append(size_t length, const char *format, ...) {
+
+    va_list args;
+    int written;
+
+    if (length >= sizeof(reply)) {
+        return length;
+    }
+
+    va_start(args, format);
+    written = vsnprintf(&reply[length], sizeof(reply) - length, format, args);
+    va_end(args);
+
+    return (written < 0) ? length : length + (size_t) written;
+}
+
+// formats the reply, returns its length
+static size_t report(void) {
+
+    enc624j600_model_stats device;
+    struct stats_mem heap;
+    struct stats_mem pools[MEMP_MAX];
+    UBaseType_t count = uxTaskGetSystemState(tasks, SIM_CONTROL_TASKS_MAX, NULL);
+    uint32_t elapsed = portGET_RUN_TIME_COUNTER_VALUE() - baseline_time;
+    size_t length = 0U;
+    UBaseType_t i;
+
+    sim_device_lock();
+    enc624j600_model_get_stats(&sim_device, &device);
+    sim_device_unlock();
+
+    LOCK_TCPIP_CORE();
+
+    heap = lwip_stats.mem;
+
+    for (i = 0U; i < MEMP_MAX; i++) {
+        pools[i] = *lwip_stats.memp[i];
+    }
+
+    UNLOCK_TCPIP_CORE();
+
+    taskENTER_CRITICAL();
+
+    length = append(length, "{\"cpu_clock_hz\":%lu,\"core_timer_hz\":%lu,\"elapsed\":%lu,",
+            (unsigned long) configCPU_CLOCK_HZ, (unsigned long) SIM_CORE_TIMER_HZ, (unsigned long) elapsed);
+
+    length = append(length, "\"device\":{\"spi_ps\":%llu,\"delay_ps\":%llu,\"transactions\":%lu,\"bytes\":%lu,"
+            "\"frames_sent\":%lu,\"frames_received\":%lu,\"frames_dropped\":%lu},",
+            (unsigned long long) device.spi_ps, (unsigned long long) device.delay_ps,
+            (unsigned long) device.transactions, (unsigned long) device.bytes,
+            (unsigned long) device.frames_sent, (unsigned long) device.frames_received,
+            (unsigned long) device.frames_dropped);
+
+    length = append(length, "\"wire_dropped\":%lu,\"tasks\":{", (unsigned long) sim_wire_dropped());
+
+    for (i = 0U; i < count; i++) {
+        length = append(length, "%s\"%s\":%lu", (i == 0U) ? "" : ",", tasks[i].pcTaskName,
+                (unsigned long) (tasks[i].ulRunTimeCounter - baseline_of(tasks[i].xHandle)));
+    }
+
+    length = append(length, "},\"heap\":{\"avail\":%lu,\"used\":%lu,\"max\":%lu,\"err\":%lu},\"pools\":{",
+            (unsigned long) heap.avail, (unsigned long) heap.used, (unsigned long) heap.max,
+            (unsigned long) heap.err);
+
+    for (i = 0U; i < MEMP_MAX; i++) {
+        length = append(length, "%s\"%s\":{\"avail\":%lu,\"used\":%lu,\"max\":%lu,\"err\":%lu}",
+                (i == 0U) ? "" : ",", pool_names[i], (unsigned long) pools[i].avail,
+                (unsigned long) pools[i].used, (unsigned long) pools[i].max, (unsigned long) pools[i].err);
+    }
+
+    length = append(length, "},\"cost\":{");
+
+    for (i = 0U; i < sim_cost_operation_count(); i++) {
+
+        sim_cost_figures figures;
+
+        sim_cost_get((uint8_t) i, &figures);
+        length = append(length, "%s\"%s\":{\"calls\":%llu,\"bytes\":%llu,\"cycles\":%llu}", (i == 0U) ? "" : ",",
+                figures.name, (unsigned long long) figures.calls, (unsigned long long) figures.bytes,
+                (unsigned long long) figures.cycles);
+    }
+
+    length = append(length, "}}\n");
+
+    taskEXIT_CRITICAL();
+
+    return (length < sizeof(reply)) ? length : sizeof(reply) - 1U;
+}
+
+static void control_task(void *parameter) {
+
+    for (;;) {
+
+        char request[16];
+        struct sockaddr_un peer;
+        socklen_t peer_length = sizeof(peer);
+        ssize_t length;
+
+        taskENTER_CRITICAL();
+        length = recvfrom(control, request, sizeof(request) - 1U, MSG_DONTWAIT, (struct sockaddr *) &peer,
+                &peer_length);
+        taskEXIT_CRITICAL();
+
+        if (length <= 0) {
+            vTaskDelay(pdMS_TO_TICKS(SIM_CONTROL_POLL_MS));
+            continue;
+        }
+
+        request[length] = '\0';
+
+        if (strncmp(request, "reset", 5U) == 0) {
+            reset();
+        }
+
+        length = (ssize_t) report();
+
+        taskENTER_CRITICAL();
+        sendto(control, reply, (size_t) length, MSG_DONTWAIT, (struct sockaddr *) &peer, peer_length);
+        taskEXIT_CRITICAL();
+    }
+}
+
+int sim_control_init(const char *path) {
+
+    struct sockaddr_un address;
+
+    if (path == NULL) {
+        return 0;
+    }
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+
+    control = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    if (control < 0) {
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    if (bind(control, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        return -1;
+    }
+
+    if (xTaskCreateStatic(control_task, "control", SIM_CONTROL_TASK_STACK_SIZE, NULL, SIM_CONTROL_TASK_PRIORITY,
+            control_stack, &control_tcb) == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
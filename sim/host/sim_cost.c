@@ -0,0 +1,263 @@
+/*
+ *  Cycle cost model of the host build.
+ *
+ *  Host run time says little about the PIC32: an x86 core runs the same
+ *  code tens of times faster and with other bottlenecks. Instead the host
+ *  build counts the operations that dominate the firmware's hot paths and
+ *  prices them in M4K cycles:
+ *
+ *      checksum        lwIP Internet checksums, per call and byte
+ *      memcpy          memcpy and memmove anywhere in the firmware, per byte
+ *      telnet_parse    bytes through the telnet input state machine
+ *      shell_line      command lines through the shell parser
+ *      output_write    writes into a session's output ring (bytes are in memcpy)
+ *      pbuf_alloc      pbuf_alloc() calls
+ *      pbuf_free       pbuf_free() calls
+ *      pbuf_header     pbuf_add_header() and pbuf_remove_header() calls
+ *      driver_rx       enc624j600_receive() calls (SPI bytes are in spi_byte)
+ *      driver_tx       enc624j600_transmit() calls
+ *      spi_byte        bytes through enc624j600_hal_spi_transfer()
+ *
+ *  No source of the firmware or of lwIP changes for it: the Makefile links
+ *  the simulator with --wrap for every counted function, the wrappers here
+ *  count and call the real one. Calls inside the file that defines a
+ *  function are not wrapped, e.g. pbuf_free() from pbuf_realloc(). The
+ *  objects are built with -fno-builtin-memcpy so every copy is a call.
+ *
+ *  The table prices each operation with cycles per call and cycles per
+ *  byte. The figures are estimates from the instruction counts of the
+ *  routines and their inner loops as XC32 compiles them for the M4K: one
+ *  instruction per cycle, code in the prefetch cache, a critical section
+ *  for every pool operation. The exception is spi_byte: the Harmony
+ *  SPI2_WriteRead() busy-waits for each byte, so it costs the wire time
+ *  at ENC624J600_MODEL_SPI_HZ, the SPI2 clock plib_spi2_master.c sets up
+ *  for the 10 MHz main.c asks for, plus the call. To calibrate a row, time the routine on the
+ *  board with the core timer and correct it.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/pbuf.h"
+#include "enc624j600/enc624j600_driver.h"
+#include "shell/shell.h"
+#include "telnet/telnet_input.h"
+#include "telnet/telnet_output.h"
+#include "enc624j600_model.h"
+#include "sim.h"
+
+// the same SPI2 clock the device model moves bytes at
+#define SPI_WIRE_CYCLES     (8.0 * configCPU_CLOCK_HZ / ENC624J600_MODEL_SPI_HZ)
+
+// the model derives the SPI2 clock without the kernel config, PBCLK runs at SYSCLK
+typedef char spi_source_is_sysclk[(ENC624J600_MODEL_SPI_SOURCE_HZ == configCPU_CLOCK_HZ) ? 1 : -1];
+
+// name, cycles per call, cycles per byte
+#define SIM_COST_OPERATIONS(X) \
+    X(checksum,     70.0,   2.5) \
+    X(memcpy,       30.0,   1.0) \
+    X(telnet_parse, 40.0,   0.0) \
+    X(shell_line,   400.0,  8.0) \
+    X(output_write, 60.0,   0.0) \
+    X(pbuf_alloc,   250.0,  0.0) \
+    X(pbuf_free,    200.0,  0.0) \
+    X(pbuf_header,  40.0,   0.0) \
+    X(driver_rx,    300.0,  0.0) \
+    X(driver_tx,    350.0,  0.0) \
+    X(spi_byte,     100.0 + SPI_WIRE_CYCLES, 0.0)
+
+typedef enum {
+#define OPERATION_ID(name, call, byte)      COST_##name,
+    SIM_COST_OPERATIONS(OPERATION_ID)
+    COST_COUNT
+} cost_operation;
+
+typedef struct {
+    const char *name;
+    double call_cycles;
+    double byte_cycles;
+} cost_price;
+
+static const cost_price prices[COST_COUNT] = {
+#define OPERATION_PRICE(name, call, byte)   { #name, call, byte },
+    SIM_COST_OPERATIONS(OPERATION_PRICE)
+};
+
+// firmware tasks run one at a time on the POSIX port, plain counters do
+static uint64_t calls[COST_COUNT];
+static uint64_t bytes[COST_COUNT];
+
+
+static void count(cost_operation operation, uint32_t length) {
+
+    calls[operation]++;
+    bytes[operation] += length;
+}
+
+void sim_cost_reset(void) {
+
+    uint8_t i;
+
+    for (i = 0U; i < COST_COUNT; i++) {
+        calls[i] = 0U;
+        bytes[i] = 0U;
+    }
+}
+
+uint8_t sim_cost_operation_count(void) {
+    return (uint8_t) COST_COUNT;
+}
+
+void sim_cost_get(uint8_t index, sim_cost_figures *figures) {
+
+    figures->name = prices[index].name;
+    figures->calls = calls[index];
+    figures->bytes = bytes[index];
+    figures->cycles = (uint64_t) (prices[index].call_cycles * (double) calls[index] +
+                                  prices[index].byte_cycles * (double) bytes[index] + 0.5);
+}
+
+extern void *__real_memcpy(void *destination, const void *source, size_t length);
+extern void *__real_memmove(void *destination, const void *source, size_t length);
+
+void *__wrap_memcpy(void *destination, const void *source, size_t length) {
+
+    count(COST_memcpy, (uint32_t) length);
+
+    return __real_memcpy(destination, source, length);
+}
+
+void *__wrap_memmove(void *destination, const void *source, size_t length) {
+
+    count(COST_memcpy, (uint32_t) length);
+
+    return __real_memmove(destination, source, length);
+}
+
+extern u16_t __real_inet_chksum(const void *dataptr, u16_t len);
+extern u16_t __real_inet_chksum_pbuf(struct pbuf *p);
+extern u16_t __real_ip_chksum_pseudo(struct pbuf *p, u8_t proto, u16_t proto_len, const ip_addr_t *src,
+        const ip_addr_t *dest);
+extern u16_t __real_ip_chksum_pseudo_partial(struct pbuf *p, u8_t proto, u16_t proto_len, u16_t chksum_len,
+        const ip_addr_t *src, const ip_addr_t *dest);
+
+u16_t __wrap_inet_chksum(const void *dataptr, u16_t len) {
+
+    count(COST_checksum, len);
+
+    return __real_inet_chksum(dataptr, len);
+}
+
+u16_t __wrap_inet_chksum_pbuf(struct pbuf *p) {
+
+    count(COST_checksum, p->tot_len);
+
+    return __real_inet_chksum_pbuf(p);
+}
+
+u16_t __wrap_ip_chksum_pseudo(struct pbuf *p, u8_t proto, u16_t proto_len, const ip_addr_t *src,
+        const ip_addr_t *dest) {
+
+    count(COST_checksum, proto_len);
+
+    return __real_ip_chksum_pseudo(p, proto, proto_len, src, dest);
+}
+
+u16_t __wrap_ip_chksum_pseudo_partial(struct pbuf *p, u8_t proto, u16_t proto_len, u16_t chksum_len,
+        const ip_addr_t *src, const ip_addr_t *dest) {
+
+    count(COST_checksum, chksum_len);
+
+    return __real_ip_chksum_pseudo_partial(p, proto, proto_len, chksum_len, src, dest);
+}
+
+extern telnet_input_result __real_telnet_input_process(telnet_input *input, telnet_output *output, uint8_t byte);
+
+telnet_input_result __wrap_telnet_input_process(telnet_input *input, telnet_output *output, uint8_t byte) {
+
+    count(COST_telnet_parse, 1U);
+
+    return __real_telnet_input_process(input, output, byte);
+}
+
+extern void __real_shell_execute(telnet_session *session, char *line, uint16_t length);
+
+void __wrap_shell_execute(telnet_session *session, char *line, uint16_t length) {
+
+    count(COST_shell_line, length);
+
+    __real_shell_execute(session, line, length);
+}
+
+extern uint16_t __real_telnet_output_write(telnet_output *output, const void *data, uint16_t length);
+
+uint16_t __wrap_telnet_output_write(telnet_output *output, const void *data, uint16_t length) {
+
+    count(COST_output_write, 0U);
+
+    return __real_telnet_output_write(output, data, length);
+}
+
+extern struct pbuf *__real_pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type);
+extern u8_t __real_pbuf_free(struct pbuf *p);
+extern u8_t __real_pbuf_add_header(struct pbuf *p, size_t header_size_increment);
+extern u8_t __real_pbuf_remove_header(struct pbuf *p, size_t header_size);
+
+struct pbuf *__wrap_pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type) {
+
+    count(COST_pbuf_alloc, 0U);
+
+    return __real_pbuf_alloc(layer, length, type);
+}
+
+u8_t __wrap_pbuf_free(struct pbuf *p) {
+
+    count(COST_pbuf_free, 0U);
+
+    return __real_pbuf_free(p);
+}
+
+u8_t __wrap_pbuf_add_header(struct pbuf *p, size_t header_size_increment) {
+
+    count(COST_pbuf_header, 0U);
+
+    return __real_pbuf_add_header(p, header_size_increment);
+}
+
+u8_t __wrap_pbuf_remove_header(struct pbuf *p, size_t header_size) {
+
+    count(COST_pbuf_header, 0U);
+
+    return __real_pbuf_remove_header(p, header_size);
+}
+
+extern enc624j600_receive_result __real_enc624j600_receive(uint8_t *destination_mac, uint8_t *source_mac,
+        uint8_t *length_type, uint8_t *buffer, uint16_t *received_bytes);
+extern enc624j600_transmit_result __real_enc624j600_transmit(uint8_t *destination_mac, uint8_t *length_type,
+        uint8_t *data, uint16_t length);
+extern uint8_t __real_enc624j600_hal_spi_transfer(uint8_t data);
+
+enc624j600_receive_result __wrap_enc624j600_receive(uint8_t *destination_mac, uint8_t *source_mac,
+        uint8_t *length_type, uint8_t *buffer, uint16_t *received_bytes) {
+
+    count(COST_driver_rx, 0U);
+
+    return __real_enc624j600_receive(destination_mac, source_mac, length_type, buffer, received_bytes);
+}
+
+enc624j600_transmit_result __wrap_enc624j600_transmit(uint8_t *destination_mac, uint8_t *length_type,
+        uint8_t *data, uint16_t length) {
+
+    count(COST_driver_tx, 0U);
+
+    return __real_enc624j600_transmit(destination_mac, length_type, data, length);
+}
+
+uint8_t __wrap_enc624j600_hal_spi_transfer(uint8_t data) {
+
+    count(COST_spi_byte, 0U);
+
+    return __real_enc624j600_hal_spi_transfer(data);
+}
@@ -0,0 +1,71 @@
+/*
+ *  ENC624J600 HAL of the host build.
+ *
+ *  Same contract as the PIC32 HAL in main.c: a transaction holds the SPI
+ *  lock from chip select assert to deassert once the scheduler runs. The
+ *  bytes go to the device model instead of SPI2, delays only advance the
+ *  simulated time.
+ */
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "enc624j600/enc624j600_driver_hal.h"
+#include "enc624j600/enc624j600_trace.h"
+#include "sim.h"
+
+enc624j600_model sim_device;
+
+static SemaphoreHandle_t lock = NULL;
+static StaticSemaphore_t lock_control;
+
+
+int sim_hal_init(const uint8_t mac[6]) {
+
+    enc624j600_model_init(&sim_device, mac);
+
+    lock = xSemaphoreCreateMutexStatic(&lock_control);
+
+    return (lock == NULL) ? -1 : 0;
+}
+
+void sim_device_lock(void) {
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+    }
+}
+
+void sim_device_unlock(void) {
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreGive(lock);
+    }
+}
+
+uint8_t enc624j600_hal_spi_transfer(uint8_t data) {
+
+    ENC624J600_TRACE_BYTE(data);
+
+    return enc624j600_model_spi_transfer(&sim_device, data);
+}
+
+void enc624j600_hal_cs_assert(void) {
+
+    sim_device_lock();
+    enc624j600_model_cs_assert(&sim_device);
+    ENC624J600_TRACE_BEGIN();
+}
+
+void enc624j600_hal_cs_deassert(void) {
+
+    ENC624J600_TRACE_END();
+    enc624j600_model_cs_deassert(&sim_device);
+    sim_device_unlock();
+}
+
+void enc624j600_hal_delay(uint8_t us) {
+    enc624j600_model_delay(&sim_device, us);
+}
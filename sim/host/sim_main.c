@@ -0,0 +1,214 @@
+/*
+ *  Host entry point of the firmware.
+ *
+ *  Brings the modules up in the order main.c does, on the FreeRTOS POSIX
+ *  port and with the ENC624J600 model behind the HAL. Each instance has
+ *  its own MAC address (02:04:A3:00:00:01 + index) and IP address
+ *  (192.168.1.200 + index).
+ *
+ *      pic32-telnet-sim [--index N] [--control PATH] [--wire FD]
+ *      pic32-telnet-sim --pair
+ *
+ *  --wire connects the device to an already open frame socket, --control
+ *  opens the socket the benchmark reads the counters from. --pair
+ *  creates a socket pair and forks: instance 0 and instance 1 run in two
+ *  processes and talk over it, their UART lines are prefixed with [0] and
+ *  [1].
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "definitions.h"
+#include "lwip/tcpip.h"
+#include "housekeeping/housekeeping.h"
+#include "log/log.h"
+#include "network/iperf_server.h"
+#include "network/network.h"
+#include "serial/serial_bridge.h"
+#include "shell/shell.h"
+#include "shell/shell_worker.h"
+#include "telnet/telnet_server.h"
+#include "uart/uart1_driver.h"
+#include "sim.h"
+
+#define INSTANCES_MAX   16U
+
+static void network_init_done(void *parameter);
+
+static uint32_t pins = 0U;
+static char prefix[8];
+
+
+static void usage(const char *program) {
+
+    fprintf(stderr, "usage: %s [--index N] [--control PATH] [--wire FD]\n", program);
+    fprintf(stderr, "       %s --pair\n", program);
+    exit(EXIT_FAILURE);
+}
+
+static void fail(const char *what) {
+
+    fprintf(stderr, "%s failed\n", what);
+    exit(EXIT_FAILURE);
+}
+
+static void run(uint8_t index, int wire, const char *control) {
+
+    uint8_t mac[6] = { 0x02U, 0x04U, 0xA3U, 0x00U, 0x00U, (uint8_t) (0x01U + index) };
+    network_config network = { NETWORK_DEFAULT_ADDRESS, NETWORK_DEFAULT_NETMASK, NETWORK_DEFAULT_GATEWAY, NULL };
+
+    network.address[3] = (uint8_t) (network.address[3] + index);
+
+    if (uart1_driver_init() != 0) {
+        fail("uart1_driver_init");
+    }
+
+    if (sim_hal_init(mac) != 0) {
+        fail("sim_hal_init");
+    }
+
+    if (housekeeping_init() != 0) {
+        fail("housekeeping_init");
+    }
+
+    if (network_init(&network) != 0) {
+        fail("network_init");
+    }
+
+    if (log_init() != 0) {
+        fail("log_init");
+    }
+
+    if (shell_worker_init() != 0) {
+        fail("shell_worker_init");
+    }
+
+    if (sim_wire_init(wire) != 0) {
+        fail("sim_wire_init");
+    }
+
+    if (sim_control_init(control) != 0) {
+        fail("sim_control_init");
+    }
+
+    tcpip_init(network_init_done, NULL);
+
+    vTaskStartScheduler();
+}
+
+int main(int argc, char *argv[]) {
+
+    unsigned long index = 0UL;
+    int wire = -1;
+    const char *control = NULL;
+    int pair = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+
+        if (strcmp(argv[i], "--pair") == 0) {
+            pair = 1;
+        } else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc) {
+            index = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--wire") == 0 && i + 1 < argc) {
+            wire = (int) strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--control") == 0 && i + 1 < argc) {
+            control = argv[++i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (index >= INSTANCES_MAX) {
+        usage(argv[0]);
+    }
+
+    if (pair == 1) {
+
+        int sockets[2];
+
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0) {
+            fail("socketpair");
+        }
+
+        pid_t child = fork();
+
+        if (child < 0) {
+            fail("fork");
+        }
+
+        index = (child == 0) ? 1UL : 0UL;
+        wire = sockets[index];
+        close(sockets[1UL - index]);
+
+        snprintf(prefix, sizeof(prefix), "[%lu] ", index);
+        sim_uart_set_prefix(prefix);
+
+        // the terminal belongs to instance 0
+        if (child == 0) {
+            close(STDIN_FILENO);
+        }
+    }
+
+    // every write goes out as it is made, stdout is shared with the UART
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    run((uint8_t) index, wire, control);
+
+    return EXIT_FAILURE;
+}
+
+static void network_init_done(void *parameter) {
+
+    telnet_server_init(shell_execute, shell_output_reserve);
+    serial_bridge_init();
+
+    if (IPERF_SERVER_AT_BOOT == 1) {
+        iperf_server_start();
+    }
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+
+    fprintf(stderr, "stack overflow in %s\n", pcTaskName);
+    abort();
+}
+
+void sim_assert_failed(const char *file, int line) {
+
+    fprintf(stderr, "assertion failed at %s:%d\n", file, line);
+    abort();
+}
+
+uint32_t sim_core_timer(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t) ((uint64_t) now.tv_sec * SIM_CORE_TIMER_HZ
+            + ((uint64_t) now.tv_nsec * (SIM_CORE_TIMER_HZ / 1000000U)) / 1000U);
+}
+
+void GPIO_PinSet(GPIO_PIN pin) {
+    pins |= 1UL << (pin & 31U);
+}
+
+void GPIO_PinClear(GPIO_PIN pin) {
+    pins &= ~(1UL << (pin & 31U));
+}
+
+void GPIO_PinToggle(GPIO_PIN pin) {
+    pins ^= 1UL << (pin & 31U);
+}
+
+bool GPIO_PinRead(GPIO_PIN pin) {
+    return ((pins >> (pin & 31U)) & 1U) != 0U;
+}
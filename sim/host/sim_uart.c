@@ -0,0 +1,149 @@
+/*
+ *  UART1 driver of the host build on stdin and stdout.
+ *
+ *  Writes go straight to stdout, a line prefix tells the instances of a
+ *  pair apart. A task polls stdin and feeds the receive stream buffer the
+ *  serial bridge reads from, so a bridge client talks to the terminal the
+ *  simulation runs in. Line settings are accepted and ignored.
+ */
+
+#include <poll.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "uart/uart1_driver.h"
+#include "sim.h"
+
+static const char *prefix = NULL;
+static uint8_t line_start = 1U;
+
+static StreamBufferHandle_t rx_buffer = NULL;
+static uint8_t rx_storage[UART1_DRIVER_RX_SIZE + 1U];
+static StaticStreamBuffer_t rx_control;
+
+static StaticTask_t uart_tcb;
+static StackType_t uart_stack[SIM_UART_TASK_STACK_SIZE];
+
+
+static void write_all(const uint8_t *data, size_t length) {
+
+    while (length > 0U) {
+
+        ssize_t written = write(STDOUT_FILENO, data, length);
+
+        if (written <= 0) {
+            return;
+        }
+
+        data += written;
+        length -= (size_t) written;
+    }
+}
+
+static void uart_task(void *parameter) {
+
+    uint8_t chunk[64];
+
+    for (;;) {
+
+        struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+        ssize_t length = 0;
+        uint8_t ready = 0U;
+
+        taskENTER_CRITICAL();
+
+        if (poll(&input, 1, 0) == 1 && (input.revents & (POLLIN | POLLHUP)) != 0) {
+            ready = 1U;
+            length = read(STDIN_FILENO, chunk, sizeof(chunk));
+        }
+
+        taskEXIT_CRITICAL();
+
+        // end of input, nothing more will come
+        if (ready == 1U && length <= 0) {
+            vTaskSuspend(NULL);
+        }
+
+        if (length > 0) {
+            xStreamBufferSend(rx_buffer, chunk, (size_t) length, portMAX_DELAY);
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(SIM_UART_POLL_MS));
+        }
+    }
+}
+
+void sim_uart_set_prefix(const char *text) {
+    prefix = text;
+}
+
+int uart1_driver_init(void) {
+
+    rx_buffer = xStreamBufferCreateStatic(UART1_DRIVER_RX_SIZE, 1U, rx_storage, &rx_control);
+
+    if (rx_buffer == NULL) {
+        return -1;
+    }
+
+    if (xTaskCreateStatic(uart_task, "uart", SIM_UART_TASK_STACK_SIZE, NULL, SIM_UART_TASK_PRIORITY,
+            uart_stack, &uart_tcb) == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+size_t uart1_driver_write(const void *data, size_t length, TickType_t timeout) {
+
+    const uint8_t *bytes = data;
+    size_t i;
+    size_t start = 0U;
+
+    taskENTER_CRITICAL();
+
+    for (i = 0; i < length; i++) {
+
+        if (line_start == 1U && prefix != NULL) {
+            write_all(&bytes[start], i - start);
+            write_all((const uint8_t *) prefix, strlen(prefix));
+            start = i;
+        }
+
+        line_start = (bytes[i] == '\n') ? 1U : 0U;
+    }
+
+    write_all(&bytes[start], length - start);
+
+    taskEXIT_CRITICAL();
+
+    return length;
+}
+
+size_t uart1_driver_read(void *buffer, size_t length, TickType_t timeout) {
+    return xStreamBufferReceive(rx_buffer, buffer, length, timeout);
+}
+
+size_t uart1_driver_write_space(void) {
+    return UART1_DRIVER_TX_SIZE;
+}
+
+uint8_t uart1_driver_setup(UART_SERIAL_SETUP *setup) {
+    return 1U;
+}
+
+void uart1_driver_purge_rx(void) {
+
+    taskENTER_CRITICAL();
+    xStreamBufferReset(rx_buffer);
+    taskEXIT_CRITICAL();
+}
+
+void uart1_driver_purge_tx(void) {
+}
+
+uint32_t uart1_driver_dropped(void) {
+    return 0U;
+}
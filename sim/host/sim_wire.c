@@ -0,0 +1,88 @@
+/*
+ *  Frame socket between a simulated device and its peer.
+ *
+ *  The transmit handler of the model sends every frame as one datagram,
+ *  without blocking: a peer that does not read loses frames like a
+ *  congested switch port would. A task polls the socket once per tick and
+ *  hands every datagram to the receive logic of the device.
+ *
+ *  Host calls are made with the tick masked. The POSIX port may suspend a
+ *  task thread anywhere, one suspended inside the C library could hold a
+ *  lock the next task needs.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <sys/socket.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "sim.h"
+
+static int wire = -1;
+static volatile uint32_t dropped = 0U;
+static uint8_t frame[ENC624J600_MODEL_FRAME_MAX];
+
+static StaticTask_t wire_tcb;
+static StackType_t wire_stack[SIM_WIRE_TASK_STACK_SIZE];
+
+
+// called by the model inside a transaction, the device lock is held
+static void transmit(void *context, const uint8_t *data, uint16_t length) {
+
+    ssize_t sent;
+
+    taskENTER_CRITICAL();
+    sent = send(wire, data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+    taskEXIT_CRITICAL();
+
+    if (sent != (ssize_t) length) {
+        dropped++;
+    }
+}
+
+static void wire_task(void *parameter) {
+
+    for (;;) {
+
+        ssize_t length;
+
+        taskENTER_CRITICAL();
+        length = recv(wire, frame, sizeof(frame), MSG_DONTWAIT | MSG_TRUNC);
+        taskEXIT_CRITICAL();
+
+        if (length <= 0) {
+            vTaskDelay(1);
+            continue;
+        }
+
+        if ((size_t) length > sizeof(frame)) {
+            continue;
+        }
+
+        sim_device_lock();
+        enc624j600_model_receive(&sim_device, frame, (uint16_t) length);
+        sim_device_unlock();
+    }
+}
+
+int sim_wire_init(int fd) {
+
+    if (fd < 0) {
+        return 0;
+    }
+
+    wire = fd;
+    enc624j600_model_set_transmit_handler(&sim_device, transmit, NULL);
+
+    if (xTaskCreateStatic(wire_task, "wire", SIM_WIRE_TASK_STACK_SIZE, NULL, SIM_WIRE_TASK_PRIORITY,
+            wire_stack, &wire_tcb) == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+uint32_t sim_wire_dropped(void) {
+    return dropped;
+}
@@ -0,0 +1,701 @@
+/*
+ *  Receive path replay on the ENC624J600 model.
+ *
+ *      pic32-telnet-replay [--mac MAC] [--spi HZ] [--budget FRAMES] [--interval US]
+ *                          [--idle-interval US] [--idle-after US] [--frames] [--json] INPUT
+ *
+ *  Feeds recorded frame arrivals into the device model and reads them out
+ *  with the unchanged driver, the way the network task polls it: up to
+ *  --budget enc624j600_receive() calls back to back, then a pause of
+ *  --interval microseconds once the device ran dry, or of --idle-interval
+ *  microseconds when no frame came for --idle-after. Time is the model's
+ *  simulated time, so the same input gives the same figures on every run
+ *  and machine, and two driver revisions can be compared on identical
+ *  traffic.
+ *
+ *  INPUT is either
+ *
+ *      - a pcap file (microsecond or nanosecond, Ethernet), for example
+ *        one pic32-telnet-wire --pcap recorded: frames the device sent
+ *        itself (source address --mac) are skipped, the rest arrive at
+ *        their capture time relative to the first one
+ *      - a spitrace dump (see tools/spi_trace_decode.py): every frame the
+ *        traced driver read out becomes an arrival at the ESTAT read that
+ *        found it, its length is the RRXDATA bytes between WRXRDPT and
+ *        SETPKTDEC less the 8 byte header. The payload is not in the
+ *        trace, a pattern addressed to the device stands in.
+ *
+ *  For every frame the harness records the SPI bytes, transactions and
+ *  simulated SPI and delay time of the receive call that returned it, and
+ *  the time from arrival to read out. It checks the frame the driver
+ *  returned against the one delivered. The calls that found nothing
+ *  pending are totalled apart. The polls of an idle device between
+ *  arrivals are skipped, they do not depend on the traffic.
+ *
+ *  For an A/B comparison build the harness once per driver revision and
+ *  run both on the same input:
+ *
+ *      make -C sim replay REPLAY_DRIVER=/tmp/old/enc624j600_driver.c REPLAY=/tmp/replay-old
+ *      make -C sim replay
+ *      /tmp/replay-old --json run.pcap > old.json
+ *      sim/build/pic32-telnet-replay --json run.pcap > new.json
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "enc624j600/enc624j600_driver.h"
+#include "enc624j600/enc624j600_driver_hal.h"
+#include "enc624j600/enc624j600_registers.h"
+#include "enc624j600_model.h"
+
+/** Frames per poll, ENC624J600_NETIF_POLL_BUDGET of the firmware */
+#define POLL_BUDGET         4U
+
+/** Pause after a poll that emptied the device, NETWORK_POLL_INTERVAL_MS of the firmware */
+#define POLL_INTERVAL_US    1000U
+
+/** Pause of an idle device, NETWORK_IDLE_POLL_INTERVAL_MS of the firmware */
+#define IDLE_INTERVAL_US    10000U
+
+/** Time without a frame until the device counts as idle, NETWORK_IDLE_AFTER_MS of the firmware */
+#define IDLE_AFTER_US       100000U
+
+/** Padded length without FCS, shorter frames are runts the device drops */
+#define FRAME_MIN           60U
+
+#define FRAME_MAX           ENC624J600_MODEL_FRAME_MAX
+
+#define ETHERNET_HEADER     14U
+
+/** Next packet pointer and receive status vector in front of every frame of the receive ring */
+#define RING_HEADER         8U
+
+#define LINE_MAX            128U
+
+#define PCAP_MICRO          0xA1B2C3D4U
+#define PCAP_NANO           0xA1B23C4DU
+#define LINKTYPE_ETHERNET   1U
+
+typedef struct {
+    uint64_t arrival_ps;        /**< Relative to the first arrival */
+    uint16_t length;
+    uint8_t *data;
+
+    // outcome
+    uint8_t stored;             /**< 1 if the device took the frame */
+    uint8_t received;           /**< 1 once the driver returned it */
+    uint8_t mismatch;           /**< 1 if the driver returned other bytes */
+    uint32_t bytes;
+    uint32_t transactions;
+    uint64_t cost_ps;           /**< SPI and delay time of the receive call */
+    uint64_t latency_ps;        /**< Arrival to the end of the receive call */
+} arrival;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t bytes;
+    uint32_t transactions;
+    uint64_t cost_ps;
+} call_totals;
+
+/**
+ *  @struct poll_timing
+ *  @brief Pauses of the network task after a poll that emptied the device.
+ */
+typedef struct {
+    uint64_t interval_ps;       /**< While frames came within idle_after_ps */
+    uint64_t idle_interval_ps;
+    uint64_t idle_after_ps;
+} poll_timing;
+
+static enc624j600_model device;
+
+static arrival *arrivals = NULL;
+static size_t arrival_count = 0U;
+static size_t arrival_capacity = 0U;
+
+static uint8_t mac[6] = { 0x02U, 0x04U, 0xA3U, 0x00U, 0x00U, 0x01U };
+
+// source address of the frames rebuilt from a trace
+static const uint8_t trace_source[6] = { 0x02U, 0x00U, 0x00U, 0x00U, 0x00U, 0xFEU };
+
+
+uint8_t enc624j600_hal_spi_transfer(uint8_t data) {
+    return enc624j600_model_spi_transfer(&device, data);
+}
+
+void enc624j600_hal_cs_assert(void) {
+    enc624j600_model_cs_assert(&device);
+}
+
+void enc624j600_hal_cs_deassert(void) {
+    enc624j600_model_cs_deassert(&device);
+}
+
+void enc624j600_hal_delay(uint8_t us) {
+    enc624j600_model_delay(&device, us);
+}
+
+static void usage(const char *program) {
+
+    fprintf(stderr, "usage: %s [--mac MAC] [--spi HZ] [--budget FRAMES] [--interval US]\n", program);
+    fprintf(stderr, "       [--idle-interval US] [--idle-after US] [--frames] [--json] INPUT\n");
+    exit(EXIT_FAILURE);
+}
+
+static void parse_mac(const char *text, const char *program) {
+
+    unsigned values[6];
+    uint8_t i;
+
+    if (sscanf(text, "%x:%x:%x:%x:%x:%x", &values[0], &values[1], &values[2], &values[3], &values[4],
+            &values[5]) != 6) {
+        usage(program);
+    }
+
+    for (i = 0U; i < 6U; i++) {
+        mac[i] = (uint8_t) values[i];
+    }
+}
+
+static void add_arrival(uint64_t arrival_ps, const uint8_t *frame, uint16_t length) {
+
+    arrival *entry;
+
+    if (arrival_count == arrival_capacity) {
+
+        arrival_capacity = (arrival_capacity == 0U) ? 256U : 2U * arrival_capacity;
+        arrivals = realloc(arrivals, arrival_capacity * sizeof(arrival));
+
+        if (arrivals == NULL) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    entry = &arrivals[arrival_count++];
+    memset(entry, 0, sizeof(*entry));
+
+    entry->arrival_ps = arrival_ps;
+    entry->length = (length < FRAME_MIN) ? FRAME_MIN : length;
+    entry->data = calloc(1U, entry->length);
+
+    if (entry->data == NULL) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(entry->data, frame, length);
+}
+
+static uint32_t swap32(uint32_t value) {
+    return (value >> 24) | ((value >> 8) & 0xFF00U) | ((value << 8) & 0xFF0000U) | (value << 24);
+}
+
+static void load_pcap(FILE *input, const char *path) {
+
+    uint32_t header[6];
+    uint32_t record[4];
+    uint8_t frame[65536];
+    uint8_t swapped;
+    uint8_t nano;
+    uint64_t first = 0U;
+    uint8_t have_first = 0U;
+    uint32_t skipped = 0U;
+
+    if (fread(header, sizeof(header), 1U, input) != 1U) {
+        fprintf(stderr, "%s: truncated pcap header\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    swapped = (header[0] == swap32(PCAP_MICRO) || header[0] == swap32(PCAP_NANO)) ? 1U : 0U;
+    nano = (header[0] == PCAP_NANO || header[0] == swap32(PCAP_NANO)) ? 1U : 0U;
+
+    if (((swapped == 1U) ? swap32(header[5]) : header[5]) != LINKTYPE_ETHERNET) {
+        fprintf(stderr, "%s: not an Ethernet capture\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    while (fread(record, sizeof(record), 1U, input) == 1U) {
+
+        uint32_t i;
+        uint64_t stamp_ps;
+
+        if (swapped == 1U) {
+            for (i = 0U; i < 4U; i++) {
+                record[i] = swap32(record[i]);
+            }
+        }
+
+        if (record[2] > sizeof(frame) || fread(frame, 1U, record[2], input) != record[2]) {
+            fprintf(stderr, "%s: truncated pcap record\n", path);
+            exit(EXIT_FAILURE);
+        }
+
+        stamp_ps = (uint64_t) record[0] * 1000000000000ULL + (uint64_t) record[1] * ((nano == 1U) ? 1000ULL : 1000000ULL);
+
+        // the device's own transmissions, cut captures and oversized frames are not arrivals
+        if (record[2] < ETHERNET_HEADER || record[2] > FRAME_MAX || record[2] != record[3] ||
+            memcmp(&frame[6], mac, 6U) == 0) {
+            skipped++;
+            continue;
+        }
+
+        if (have_first == 0U) {
+            first = stamp_ps;
+            have_first = 1U;
+        }
+
+        add_arrival((stamp_ps > first) ? stamp_ps - first : 0U, frame, (uint16_t) record[2]);
+    }
+
+    if (skipped > 0U) {
+        fprintf(stderr, "%s: %u frames skipped (sent by %02x:%02x:%02x:%02x:%02x:%02x, cut or oversized)\n", path,
+                skipped, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    }
+}
+
+static void load_trace(FILE *input, const char *path) {
+
+    char line[LINE_MAX];
+    uint8_t frame[FRAME_MAX];
+    uint32_t timer_hz = 0U;
+    uint32_t previous = 0U;
+    uint64_t ticks = 0U;
+    uint8_t have_first = 0U;
+    uint64_t estat_ticks = 0U;
+    uint64_t frame_ticks = 0U;
+    uint8_t in_frame = 0U;
+    uint32_t data_bytes = 0U;
+    uint16_t i;
+
+    memcpy(&frame[0], mac, 6U);
+    memcpy(&frame[6], trace_source, 6U);
+
+    // IEEE local experimental EtherType, then a counting pattern
+    frame[12] = 0x88U;
+    frame[13] = 0xB5U;
+
+    for (i = ETHERNET_HEADER; i < FRAME_MAX; i++) {
+        frame[i] = (uint8_t) i;
+    }
+
+    while (fgets(line, sizeof(line), input) != NULL) {
+
+        // a shell prompt may precede the first line of the dump
+        char *record = strchr(line, '#');
+        unsigned start;
+        unsigned duration;
+        unsigned info;
+
+        if (record == NULL) {
+            continue;
+        }
+
+        if (sscanf(record, "#T %x", &timer_hz) == 1) {
+            continue;
+        }
+
+        if (sscanf(record, "#S %x %x %x", &start, &duration, &info) != 3 || timer_hz == 0U) {
+            continue;
+        }
+
+        // the core timer wraps, the records are in order
+        if (have_first == 1U) {
+            ticks += (uint32_t) (start - previous);
+        }
+
+        previous = start;
+        have_first = 1U;
+
+        uint8_t opcode = (uint8_t) (info >> 24);
+        uint8_t argument = (uint8_t) (info >> 16);
+        uint16_t length = (uint16_t) (info & 0xFFFFU);
+
+        if (opcode == RCRU && argument == ESTAT) {
+            estat_ticks = ticks;
+        } else if (opcode == WRXRDPT) {
+            in_frame = 1U;
+            data_bytes = 0U;
+            frame_ticks = estat_ticks;
+        } else if (opcode == RRXDATA && in_frame == 1U && length > 0U) {
+            data_bytes += length - 1U;
+        } else if (opcode == SETPKTDEC && in_frame == 1U) {
+
+            in_frame = 0U;
+
+            if (data_bytes >= RING_HEADER + ETHERNET_HEADER && data_bytes - RING_HEADER <= FRAME_MAX) {
+                add_arrival(frame_ticks * 1000000000000ULL / timer_hz, frame, (uint16_t) (data_bytes - RING_HEADER));
+            }
+        }
+    }
+
+    if (timer_hz == 0U) {
+        fprintf(stderr, "%s: neither a pcap file nor a spitrace dump\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    // arrivals are relative to the first one
+    if (arrival_count > 0U) {
+
+        uint64_t first = arrivals[0].arrival_ps;
+        size_t j;
+
+        for (j = 0U; j < arrival_count; j++) {
+            arrivals[j].arrival_ps -= first;
+        }
+    }
+}
+
+static void load(const char *path) {
+
+    FILE *input = fopen(path, "rb");
+    uint32_t magic = 0U;
+
+    if (input == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    if (fread(&magic, sizeof(magic), 1U, input) != 1U) {
+        magic = 0U;
+    }
+
+    rewind(input);
+
+    if (magic == PCAP_MICRO || magic == PCAP_NANO || magic == swap32(PCAP_MICRO) || magic == swap32(PCAP_NANO)) {
+        load_pcap(input, path);
+    } else {
+        load_trace(input, path);
+    }
+
+    fclose(input);
+}
+
+static uint64_t cost_of(const enc624j600_model_stats *before, const enc624j600_model_stats *after) {
+    return (after->spi_ps - before->spi_ps) + (after->delay_ps - before->delay_ps);
+}
+
+static uint64_t pause_after(const poll_timing *timing, uint64_t quiet_ps) {
+    return (quiet_ps < timing->idle_after_ps) ? timing->interval_ps : timing->idle_interval_ps;
+}
+
+static void replay(uint8_t budget, const poll_timing *timing, call_totals *empty) {
+
+    static uint8_t payload[FRAME_MAX];
+    size_t delivered = 0U;      // next arrival to hand to the device
+    size_t read = 0U;           // oldest stored frame the driver did not return yet
+    uint64_t base_ps = device.now_ps;
+    uint64_t last_frame_ps = device.now_ps;
+
+    while (delivered < arrival_count || read < delivered) {
+
+        uint8_t frames = 0U;
+
+        while (frames < budget) {
+
+            enc624j600_model_stats before;
+            enc624j600_model_stats after;
+            uint8_t destination[6];
+            uint8_t source[6];
+            uint8_t type[2];
+            uint16_t length = 0U;
+
+            // everything that arrived until now is in the receive ring
+            while (delivered < arrival_count && base_ps + arrivals[delivered].arrival_ps <= device.now_ps) {
+
+                arrival *next = &arrivals[delivered++];
+
+                next->stored = (enc624j600_model_receive(&device, next->data, next->length) == 0) ? 1U : 0U;
+            }
+
+            while (read < delivered && arrivals[read].stored == 0U) {
+                read++;
+            }
+
+            enc624j600_model_get_stats(&device, &before);
+            enc624j600_receive_result result = enc624j600_receive(destination, source, type, payload, &length);
+            enc624j600_model_get_stats(&device, &after);
+
+            if (result != ENC_RECEIVE_SUCCEEDED) {
+
+                if (read < delivered) {
+                    fprintf(stderr, "driver found nothing pending with frame %zu in the device\n", read);
+                    exit(EXIT_FAILURE);
+                }
+
+                empty->calls++;
+                empty->bytes += after.bytes - before.bytes;
+                empty->transactions += after.transactions - before.transactions;
+                empty->cost_ps += cost_of(&before, &after);
+                break;
+            }
+
+            frames++;
+
+            if (read == delivered) {
+                fprintf(stderr, "driver returned a frame that was never delivered\n");
+                exit(EXIT_FAILURE);
+            }
+
+            arrival *frame = &arrivals[read++];
+
+            frame->received = 1U;
+            frame->bytes = after.bytes - before.bytes;
+            frame->transactions = after.transactions - before.transactions;
+            frame->cost_ps = cost_of(&before, &after);
+            frame->latency_ps = device.now_ps - (base_ps + frame->arrival_ps);
+
+            // the device pads short frames, compare what was delivered
+            if (ETHERNET_HEADER + length < frame->length ||
+                memcmp(destination, &frame->data[0], 6U) != 0 ||
+                memcmp(source, &frame->data[6], 6U) != 0 ||
+                memcmp(type, &frame->data[12], 2U) != 0 ||
+                memcmp(payload, &frame->data[ETHERNET_HEADER], frame->length - ETHERNET_HEADER) != 0) {
+                frame->mismatch = 1U;
+            }
+        }
+
+        if (frames > 0U) {
+            last_frame_ps = device.now_ps;
+        }
+
+        if (frames == budget) {
+            continue;
+        }
+
+        // the network task sleeps, an idle device is polled again on the first wake-up after the next arrival
+        uint64_t wake_ps = device.now_ps + pause_after(timing, device.now_ps - last_frame_ps);
+
+        if (read == delivered && delivered < arrival_count) {
+
+            uint64_t next_ps = base_ps + arrivals[delivered].arrival_ps;
+
+            while (wake_ps < next_ps) {
+
+                uint64_t pause_ps = pause_after(timing, wake_ps - last_frame_ps);
+
+                if (pause_ps == 0U) {
+                    wake_ps = next_ps;
+                } else {
+                    wake_ps += pause_ps;
+                }
+            }
+        }
+
+        enc624j600_model_idle_until(&device, wake_ps);
+    }
+}
+
+static int compare_u64(const void *a, const void *b) {
+
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+// fills sorted with the field of every received frame, returns how many
+static size_t collect(uint64_t *sorted, size_t offset) {
+
+    size_t count = 0U;
+    size_t i;
+
+    for (i = 0U; i < arrival_count; i++) {
+        if (arrivals[i].received == 1U) {
+            sorted[count++] = *(const uint64_t *) ((const uint8_t *) &arrivals[i] + offset);
+        }
+    }
+
+    qsort(sorted, count, sizeof(uint64_t), compare_u64);
+
+    return count;
+}
+
+static double percentile_us(const uint64_t *sorted, size_t count, double fraction) {
+
+    size_t index;
+
+    if (count == 0U) {
+        return 0.0;
+    }
+
+    index = (size_t) (fraction * (double) (count - 1U) + 0.5);
+
+    return (double) sorted[index] / 1e6;
+}
+
+static void report(uint8_t json, const char *path, uint32_t spi_hz, const call_totals *empty) {
+
+    uint64_t *sorted = malloc((arrival_count + 1U) * sizeof(uint64_t));
+    size_t received = 0U;
+    size_t stored = 0U;
+    size_t mismatched = 0U;
+    uint64_t bytes = 0U;
+    uint64_t transactions = 0U;
+    uint64_t cost_ps = 0U;
+    uint64_t frame_bytes = 0U;
+    double cost_p50, cost_p99, cost_max, latency_p50, latency_p99, latency_max;
+    size_t count;
+    size_t i;
+
+    if (sorted == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0U; i < arrival_count; i++) {
+
+        const arrival *frame = &arrivals[i];
+
+        stored += frame->stored;
+        received += frame->received;
+        mismatched += frame->mismatch;
+
+        if (frame->received == 1U) {
+            bytes += frame->bytes;
+            transactions += frame->transactions;
+            cost_ps += frame->cost_ps;
+            frame_bytes += frame->length;
+        }
+    }
+
+    count = collect(sorted, offsetof(arrival, cost_ps));
+    cost_p50 = percentile_us(sorted, count, 0.5);
+    cost_p99 = percentile_us(sorted, count, 0.99);
+    cost_max = percentile_us(sorted, count, 1.0);
+
+    count = collect(sorted, offsetof(arrival, latency_ps));
+    latency_p50 = percentile_us(sorted, count, 0.5);
+    latency_p99 = percentile_us(sorted, count, 0.99);
+    latency_max = percentile_us(sorted, count, 1.0);
+
+    free(sorted);
+
+    double per = (received > 0U) ? (double) received : 1.0;
+
+    if (json == 1U) {
+
+        printf("{\"schema\":1,\"input\":\"%s\",\"spi_hz\":%u,\"frames\":%zu,\"stored\":%zu,\"received\":%zu,"
+               "\"mismatched\":%zu,\"frame_bytes\":%llu,", path, spi_hz, arrival_count, stored, received, mismatched,
+               (unsigned long long) frame_bytes);
+        printf("\"per_frame\":{\"spi_bytes\":%.2f,\"transactions\":%.2f,\"time_us\":%.3f,\"time_p50_us\":%.3f,"
+               "\"time_p99_us\":%.3f,\"time_max_us\":%.3f},", (double) bytes / per, (double) transactions / per,
+               (double) cost_ps / 1e6 / per, cost_p50, cost_p99, cost_max);
+        printf("\"latency\":{\"p50_us\":%.3f,\"p99_us\":%.3f,\"max_us\":%.3f},", latency_p50, latency_p99,
+               latency_max);
+        printf("\"empty_polls\":{\"calls\":%u,\"spi_bytes\":%u,\"transactions\":%u,\"time_us\":%.3f}}\n",
+               empty->calls, empty->bytes, empty->transactions, (double) empty->cost_ps / 1e6);
+        return;
+    }
+
+    printf("input        %s, SPI at %u Hz\n", path, spi_hz);
+    printf("frames       %zu arrived, %zu stored by the device, %zu read out, %zu mismatched\n", arrival_count,
+           stored, received, mismatched);
+    printf("per frame    %.1f SPI bytes (%.1f per payload byte), %.2f transactions\n", (double) bytes / per,
+           (frame_bytes > 0U) ? (double) bytes / (double) frame_bytes : 0.0, (double) transactions / per);
+    printf("time         %.3f us avg, p50 %.3f, p99 %.3f, max %.3f\n", (double) cost_ps / 1e6 / per, cost_p50,
+           cost_p99, cost_max);
+    printf("latency      p50 %.3f us, p99 %.3f, max %.3f\n", latency_p50, latency_p99, latency_max);
+    printf("empty polls  %u calls, %u SPI bytes, %u transactions, %.3f us\n", empty->calls, empty->bytes,
+           empty->transactions, (double) empty->cost_ps / 1e6);
+}
+
+static void list_frames(void) {
+
+    size_t i;
+
+    printf("%8s %14s %6s %6s %6s %4s %10s %12s\n", "frame", "arrival us", "length", "state", "bytes", "tx",
+           "time us", "latency us");
+
+    for (i = 0U; i < arrival_count; i++) {
+
+        const arrival *frame = &arrivals[i];
+        const char *state = (frame->stored == 0U) ? "drop" : (frame->mismatch == 1U) ? "bad" : "ok";
+
+        printf("%8zu %14.3f %6u %6s %6u %4u %10.3f %12.3f\n", i, (double) frame->arrival_ps / 1e6, frame->length,
+               state, frame->bytes, frame->transactions, (double) frame->cost_ps / 1e6,
+               (double) frame->latency_ps / 1e6);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+
+    enc624j600_config config = { 0 };
+    call_totals empty = { 0 };
+    uint32_t spi_hz = ENC624J600_MODEL_SPI_HZ;
+    uint8_t budget = POLL_BUDGET;
+    uint64_t interval_us = POLL_INTERVAL_US;
+    uint64_t idle_interval_us = IDLE_INTERVAL_US;
+    uint64_t idle_after_us = IDLE_AFTER_US;
+    poll_timing timing;
+    uint8_t frames = 0U;
+    uint8_t json = 0U;
+    int i = 1;
+
+    for (; i < argc && strncmp(argv[i], "--", 2U) == 0; i++) {
+
+        if (strcmp(argv[i], "--frames") == 0) {
+            frames = 1U;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--json") == 0) {
+            json = 1U;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+
+        if (strcmp(argv[i], "--mac") == 0) {
+            parse_mac(argv[i + 1], argv[0]);
+        } else if (strcmp(argv[i], "--spi") == 0) {
+            spi_hz = (uint32_t) strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--budget") == 0) {
+            budget = (uint8_t) strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--interval") == 0) {
+            interval_us = strtoull(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--idle-interval") == 0) {
+            idle_interval_us = strtoull(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--idle-after") == 0) {
+            idle_after_us = strtoull(argv[i + 1], NULL, 0);
+        } else {
+            usage(argv[0]);
+        }
+
+        i++;
+    }
+
+    if (i != argc - 1 || budget == 0U || spi_hz == 0U) {
+        usage(argv[0]);
+    }
+
+    load(argv[i]);
+
+    enc624j600_model_init(&device, mac);
+    enc624j600_model_set_spi_clock(&device, spi_hz);
+    enc624j600_init(&config);
+    enc624j600_model_reset_stats(&device);
+
+    timing.interval_ps = interval_us * 1000000ULL;
+    timing.idle_interval_ps = idle_interval_us * 1000000ULL;
+    timing.idle_after_ps = idle_after_us * 1000000ULL;
+
+    replay(budget, &timing, &empty);
+
+    if (frames == 1U && json == 0U) {
+        list_frames();
+    }
+
+    report(json, argv[i], spi_hz, &empty);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/*
+ *  Host test of the tickless idle arithmetic in FreeRTOS/portable/port_tickless.h.
+ *
+ *      make -C sim test
+ *
+ *  A simulated CP0 core timer stands in for the registers: a sleep
+ *  programs the compare the way vPortSuppressTicksAndSleep() does and the
+ *  core wakes at an interrupt, at the compare match or some time after it.
+ *  Every case checks the ticks the kernel is stepped by and the position
+ *  the tick resumes at against the time that passed. Exits 1 if a check
+ *  failed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "FreeRTOSConfig.h"
+#include "port_tickless.h"
+
+/** Core timer counts per tick of the target, as port.c derives them */
+#define TARGET_COUNTS_PER_TICK  ((configCPU_CLOCK_HZ / 2UL) / configTICK_RATE_HZ)
+
+/** No interrupt before the compare match */
+#define NO_INTERRUPT            UINT64_MAX
+
+typedef struct {
+    uint32_t count;             /**< CP0 Count, wraps like the register */
+    uint32_t compare;           /**< CP0 Compare */
+} core_timer;
+
+typedef struct {
+    uint32_t expected;          /**< Ticks asked for after the clamp */
+    uint32_t elapsed;           /**< Core timer counts from the start to the wake up */
+    uint32_t completed;         /**< Ticks the kernel is stepped by */
+    uint32_t position;          /**< Position the tick resumes at */
+} sleep_result;
+
+static unsigned failures = 0U;
+
+
+static void check(int condition, const char *name, const char *what) {
+
+    if (!condition) {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+/*
+ *  One pass through vPortSuppressTicksAndSleep() on the simulated timer.
+ *  The core wakes interrupt counts after the start if that is before the
+ *  compare match, otherwise at the match plus latency counts.
+ */
+static sleep_result sleep_ticks(core_timer *timer, uint32_t counts_per_tick, uint32_t expected,
+        uint32_t position, uint64_t interrupt, uint32_t latency) {
+
+    sleep_result result;
+    uint32_t start = timer->count;
+    uint32_t counts;
+
+    if (expected > ulPortTicklessMaxIdleTicks(counts_per_tick)) {
+        expected = ulPortTicklessMaxIdleTicks(counts_per_tick);
+    }
+
+    counts = ulPortTicklessSleepCounts(expected, position, counts_per_tick);
+    timer->compare = start + counts;
+
+    if (interrupt < counts) {
+        timer->count = start + (uint32_t) interrupt;
+    } else {
+        timer->count = timer->compare + latency;
+    }
+
+    result.expected = expected;
+    result.elapsed = timer->count - start;
+    result.completed = ulPortTicklessCompletedTicks(result.elapsed, position, counts_per_tick,
+            expected, &result.position);
+
+    return result;
+}
+
+// the kernel's time and the real time agree: whole ticks plus the resumed position
+static int conserved(const sleep_result *result, uint32_t position, uint32_t counts_per_tick) {
+
+    uint64_t kernel = (uint64_t) result->completed * counts_per_tick + result->position;
+
+    return kernel == (uint64_t) position + result->elapsed;
+}
+
+static void compare_match(uint32_t counts_per_tick) {
+
+    core_timer timer = { 0x12345678UL, 0U };
+    uint32_t position = counts_per_tick / 3U;
+    sleep_result result = sleep_ticks(&timer, counts_per_tick, 10U, position, NO_INTERRUPT, 0U);
+
+    check(result.elapsed == 10U * counts_per_tick - position, "compare match", "compare at the end of the 10th period");
+    check(result.completed == 10U, "compare match", "stepped by the expected ticks");
+    check(result.position == 0U, "compare match", "tick resumes at the start of a period");
+    check(conserved(&result, position, counts_per_tick), "compare match", "time conserved");
+}
+
+static void early_wake(uint32_t counts_per_tick) {
+
+    core_timer timer = { 1000U, 0U };
+    uint32_t position = counts_per_tick / 2U;
+    uint64_t interrupt = 3U * (uint64_t) counts_per_tick + counts_per_tick / 4U;
+    sleep_result result = sleep_ticks(&timer, counts_per_tick, 10U, position, interrupt, 0U);
+
+    check(result.completed == 3U, "early wake", "stepped by the periods that ended");
+    check(result.position == (position + (uint32_t) interrupt) % counts_per_tick, "early wake",
+            "tick resumes within the running period");
+    check(conserved(&result, position, counts_per_tick), "early wake", "time conserved");
+
+    // woken before the first, partial, period ended
+    result = sleep_ticks(&timer, counts_per_tick, 10U, position, counts_per_tick / 4U, 0U);
+
+    check(result.completed == 0U, "early wake", "no tick within the first period");
+    check(result.position == position + counts_per_tick / 4U, "early wake", "position advanced by the sleep");
+}
+
+static void late_wake(uint32_t counts_per_tick) {
+
+    core_timer timer = { 0U, 0U };
+    uint32_t position = 7U;
+    sleep_result result = sleep_ticks(&timer, counts_per_tick, 5U, position, NO_INTERRUPT, 2U * counts_per_tick + 9U);
+
+    check(result.elapsed > ulPortTicklessSleepCounts(5U, position, counts_per_tick), "late wake", "woke after the match");
+    check(result.completed == 5U, "late wake", "never stepped past the expected ticks");
+    check(result.position == 0U, "late wake", "tick resumes at the start of a period");
+}
+
+static void max_idle_clamp(uint32_t counts_per_tick) {
+
+    uint32_t max = ulPortTicklessMaxIdleTicks(counts_per_tick);
+    uint32_t positions[] = { 0U, counts_per_tick - 1U };
+    uint8_t i;
+
+    check((uint64_t) (max + 1U) * counts_per_tick <= 0xFFFFFFFFULL, "max idle clamp",
+            "one period kept back within a wrap");
+
+    for (i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+
+        // the compare wraps past zero
+        core_timer timer = { 0xFFFFFF00UL, 0U };
+        uint32_t position = positions[i];
+        sleep_result result = sleep_ticks(&timer, counts_per_tick, 0xFFFFFFFFUL, position, NO_INTERRUPT, 0U);
+
+        check(result.expected == max, "max idle clamp", "expected idle time clamped");
+        check(result.elapsed == (uint64_t) max * counts_per_tick - position, "max idle clamp",
+                "compare reached across the wrap");
+        check(result.completed == max, "max idle clamp", "stepped by the clamped ticks");
+        check(result.position == 0U, "max idle clamp", "tick resumes at the start of a period");
+
+        // the period kept back absorbs a late wake up without the total wrapping
+        timer.count = 0xFFFFFF00UL;
+        result = sleep_ticks(&timer, counts_per_tick, 0xFFFFFFFFUL, position, NO_INTERRUPT, counts_per_tick - 1U);
+
+        check(result.completed == max, "max idle clamp", "late wake at the clamp");
+        check(result.position == 0U, "max idle clamp", "late wake at the clamp resumes at a period");
+
+        // an interrupt in the last period
+        timer.count = 0xFFFFFF00UL;
+        result = sleep_ticks(&timer, counts_per_tick, 0xFFFFFFFFUL, position,
+                (uint64_t) max * counts_per_tick - position - 1U, 0U);
+
+        check(result.completed == max - 1U, "max idle clamp", "interrupt in the last period");
+        check(conserved(&result, position, counts_per_tick), "max idle clamp", "time conserved");
+    }
+}
+
+int main(void) {
+
+    // the target's tick and a slow one, where the clamp is 14 ticks
+    uint32_t rates[] = { TARGET_COUNTS_PER_TICK, 0x10000000UL };
+    uint8_t i;
+
+    for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        compare_match(rates[i]);
+        early_wake(rates[i]);
+        late_wake(rates[i]);
+        max_idle_clamp(rates[i]);
+    }
+
+    if (failures > 0U) {
+        printf("%u checks failed\n", failures);
+        return 1;
+    }
+
+    printf("port_tickless: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,462 @@
+/*
+ *  Virtual Ethernet segment between simulated devices and host endpoints.
+ *
+ *      pic32-telnet-wire [--rate BITS] [--latency US] [--loss PERCENT] [--queue FRAMES]
+ *                        [--seed N] [--pcap FILE] PROGRAM [ARGS...] [-- PROGRAM [ARGS...]]...
+ *
+ *  Every PROGRAM gets a port of the segment: the wire starts it with
+ *  --wire FD appended, FD being its end of a SOCK_SEQPACKET socket pair
+ *  that carries one frame per datagram (destination address up to the end
+ *  of the padding, no FCS). The segment is a hub, a frame goes to every
+ *  other port.
+ *
+ *  Each port transmits onto its peers at --rate bits per second, preamble,
+ *  FCS and inter frame gap included, through a queue of --queue frames.
+ *  A frame that finds the queue full is dropped like on a congested switch
+ *  port. Every delivery is then delayed by --latency microseconds and lost
+ *  with --loss percent probability, drawn from a generator seeded with
+ *  --seed so a run can be repeated. A rate of 0 does not limit.
+ *
+ *  --pcap records every frame as its sender put it on the wire, with
+ *  nanosecond timestamps, lost frames included: retransmissions show up
+ *  as duplicates next to the original.
+ *
+ *  Only the first PROGRAM keeps stdin. The wire runs until a port closes
+ *  or it is interrupted, then it terminates the others and prints the
+ *  frame counters to stderr.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PORTS_MAX           8U
+
+#define FRAME_MAX           1536U
+
+/** Default depth of a port's transmit queue */
+#define QUEUE_DEPTH         64U
+
+#define QUEUE_DEPTH_MAX     1024U
+
+/** Frames a port can have queued or in flight */
+#define QUEUE_SLOTS         (2U * QUEUE_DEPTH_MAX)
+
+/** Preamble and start delimiter, FCS and inter frame gap: bytes on the line a frame does not carry */
+#define LINE_OVERHEAD       (8U + 4U + 12U)
+
+/** Padded length without FCS */
+#define FRAME_MIN           60U
+
+typedef struct {
+    uint64_t deliver_ns;
+    uint16_t length;
+    uint8_t data[FRAME_MAX];
+} queued_frame;
+
+typedef struct {
+    int fd;
+    pid_t pid;
+
+    // frames from this port on their way to the others, waiting to be sent or in flight
+    queued_frame *queue;
+    uint16_t head;
+    uint16_t count;
+    uint64_t busy_until_ns;
+
+    uint32_t frames;
+    uint32_t lost;
+    uint32_t queue_drops;
+    uint32_t send_drops;
+} port;
+
+static port ports[PORTS_MAX];
+static unsigned port_count = 0U;
+
+static uint64_t rate = 0U;
+static uint64_t latency_ns = 0U;
+static uint32_t loss_threshold = 0U;
+static uint16_t queue_depth = QUEUE_DEPTH;
+static uint64_t random_state = 1U;
+
+static FILE *pcap = NULL;
+static uint64_t start_ns;
+static uint64_t start_realtime_ns;
+
+static volatile sig_atomic_t stopping = 0;
+
+
+static void usage(const char *program) {
+
+    fprintf(stderr, "usage: %s [--rate BITS] [--latency US] [--loss PERCENT] [--queue FRAMES]\n", program);
+    fprintf(stderr, "       [--seed N] [--pcap FILE] PROGRAM [ARGS...] [-- PROGRAM [ARGS...]]...\n");
+    exit(EXIT_FAILURE);
+}
+
+static uint64_t now_ns(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+// xorshift64*, good enough to pick lost frames and cheap to repeat
+static uint32_t next_random(void) {
+
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+
+    return (uint32_t) ((random_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static void stop(int signal_number) {
+    stopping = 1;
+}
+
+static void pcap_open(const char *path) {
+
+    // nanosecond timestamps, version 2.4, no time zone offset, LINKTYPE_ETHERNET
+    const uint32_t magic = 0xA1B23C4DU;
+    const uint16_t version[2] = { 2U, 4U };
+    const uint32_t fields[4] = { 0U, 0U, 65535U, 1U };
+    struct timespec now;
+
+    pcap = fopen(path, "wb");
+
+    if (pcap == NULL) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    fwrite(&magic, sizeof(magic), 1U, pcap);
+    fwrite(version, sizeof(version), 1U, pcap);
+    fwrite(fields, sizeof(fields), 1U, pcap);
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    start_realtime_ns = (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+static void pcap_write(uint64_t at_ns, const uint8_t *frame, uint16_t length) {
+
+    uint64_t stamp = start_realtime_ns + (at_ns - start_ns);
+    uint32_t record[4];
+
+    record[0] = (uint32_t) (stamp / 1000000000ULL);
+    record[1] = (uint32_t) (stamp % 1000000000ULL);
+    record[2] = length;
+    record[3] = length;
+
+    fwrite(record, sizeof(record), 1U, pcap);
+    fwrite(frame, 1U, length, pcap);
+}
+
+static void start_program(unsigned index, char **argv) {
+
+    int pair[2];
+    char fd_text[16];
+    char **arguments;
+    int count = 0;
+    pid_t pid;
+    unsigned i;
+
+    while (argv[count] != NULL) {
+        count++;
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, pair) != 0) {
+        perror("socketpair");
+        exit(EXIT_FAILURE);
+    }
+
+    pid = fork();
+
+    if (pid < 0) {
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+
+    if (pid == 0) {
+
+        // only the own end of the own port stays open
+        for (i = 0U; i < port_count; i++) {
+            close(ports[i].fd);
+        }
+
+        close(pair[0]);
+
+        if (index > 0U) {
+
+            int null = open("/dev/null", O_RDONLY);
+
+            if (null >= 0) {
+                dup2(null, STDIN_FILENO);
+                close(null);
+            }
+        }
+
+        arguments = calloc((size_t) count + 3U, sizeof(char *));
+
+        if (arguments == NULL) {
+            _exit(EXIT_FAILURE);
+        }
+
+        snprintf(fd_text, sizeof(fd_text), "%d", pair[1]);
+        memcpy(arguments, argv, (size_t) count * sizeof(char *));
+        arguments[count] = "--wire";
+        arguments[count + 1] = fd_text;
+
+        execvp(arguments[0], arguments);
+        perror(arguments[0]);
+        _exit(EXIT_FAILURE);
+    }
+
+    close(pair[1]);
+
+    ports[index].fd = pair[0];
+    ports[index].pid = pid;
+    ports[index].queue = calloc(QUEUE_SLOTS, sizeof(queued_frame));
+
+    if (ports[index].queue == NULL) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+
+    fcntl(pair[0], F_SETFL, fcntl(pair[0], F_GETFL) | O_NONBLOCK);
+}
+
+// a frame from port source, queued behind whatever that port is still sending
+static void transmit(port *source, uint64_t now, const uint8_t *frame, uint16_t length) {
+
+    uint64_t depart = (source->busy_until_ns > now) ? source->busy_until_ns : now;
+    queued_frame *entry;
+    uint16_t line_length = (length < FRAME_MIN) ? FRAME_MIN : length;
+    uint16_t waiting = 0U;
+
+    source->frames++;
+
+    if (pcap != NULL) {
+        pcap_write(now, frame, length);
+    }
+
+    // frames in flight have left the queue
+    while (waiting < source->count
+            && source->queue[(source->head + source->count - 1U - waiting) % QUEUE_SLOTS].deliver_ns - latency_ns > now) {
+        waiting++;
+    }
+
+    if (waiting == queue_depth || source->count == QUEUE_SLOTS) {
+        source->queue_drops++;
+        return;
+    }
+
+    if (rate != 0U) {
+        depart += ((uint64_t) (line_length + LINE_OVERHEAD) * 8U * 1000000000ULL) / rate;
+    }
+
+    source->busy_until_ns = depart;
+
+    if (loss_threshold != 0U && next_random() < loss_threshold) {
+        source->lost++;
+        return;
+    }
+
+    entry = &source->queue[(source->head + source->count) % QUEUE_SLOTS];
+    entry->deliver_ns = depart + latency_ns;
+    entry->length = length;
+    memcpy(entry->data, frame, length);
+    source->count++;
+}
+
+// hands every frame that is due to the other ports, returns when the next one is
+static uint64_t deliver(uint64_t now) {
+
+    uint64_t next = UINT64_MAX;
+    unsigned i;
+    unsigned j;
+
+    for (i = 0U; i < port_count; i++) {
+
+        port *source = &ports[i];
+
+        while (source->count > 0U && source->queue[source->head].deliver_ns <= now) {
+
+            queued_frame *entry = &source->queue[source->head];
+
+            for (j = 0U; j < port_count; j++) {
+
+                if (j != i && send(ports[j].fd, entry->data, entry->length, MSG_DONTWAIT | MSG_NOSIGNAL)
+                        != (ssize_t) entry->length) {
+                    // the receiver did not keep up, its socket buffer is its receive FIFO
+                    source->send_drops++;
+                }
+            }
+
+            source->head = (uint16_t) ((source->head + 1U) % QUEUE_SLOTS);
+            source->count--;
+        }
+
+        if (source->count > 0U && source->queue[source->head].deliver_ns < next) {
+            next = source->queue[source->head].deliver_ns;
+        }
+    }
+
+    return next;
+}
+
+static void run(void) {
+
+    struct pollfd fds[PORTS_MAX];
+    static uint8_t frame[FRAME_MAX];
+    unsigned i;
+
+    for (i = 0U; i < port_count; i++) {
+        fds[i].fd = ports[i].fd;
+        fds[i].events = POLLIN;
+    }
+
+    while (stopping == 0) {
+
+        uint64_t now = now_ns();
+        uint64_t next = deliver(now);
+        int timeout = 100;
+
+        if (next != UINT64_MAX) {
+            // poll() counts milliseconds, the last stretch is spun
+            timeout = (next - now >= 1000000ULL) ? (int) ((next - now) / 1000000ULL) : 0;
+        }
+
+        if (poll(fds, port_count, timeout) < 0) {
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            perror("poll");
+            return;
+        }
+
+        for (i = 0U; i < port_count; i++) {
+
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            for (;;) {
+
+                ssize_t length = recv(fds[i].fd, frame, sizeof(frame), MSG_DONTWAIT | MSG_TRUNC);
+
+                if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                    break;
+                }
+
+                if (length <= 0) {
+                    // a program went away, the run is over
+                    return;
+                }
+
+                if ((size_t) length <= sizeof(frame)) {
+                    transmit(&ports[i], now_ns(), frame, (uint16_t) length);
+                }
+            }
+        }
+    }
+}
+
+static void finish(void) {
+
+    unsigned i;
+
+    for (i = 0U; i < port_count; i++) {
+        kill(ports[i].pid, SIGTERM);
+    }
+
+    for (i = 0U; i < port_count; i++) {
+        waitpid(ports[i].pid, NULL, 0);
+    }
+
+    if (pcap != NULL) {
+        fclose(pcap);
+    }
+
+    for (i = 0U; i < port_count; i++) {
+        fprintf(stderr, "wire: port %u frames %u lost %u queue drops %u receiver drops %u\n", i,
+                ports[i].frames, ports[i].lost, ports[i].queue_drops, ports[i].send_drops);
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    const char *pcap_path = NULL;
+    int i = 1;
+    int first;
+
+    for (; i < argc && strncmp(argv[i], "--", 2U) == 0 && argv[i][2] != '\0'; i += 2) {
+
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+
+        if (strcmp(argv[i], "--rate") == 0) {
+            rate = strtoull(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--latency") == 0) {
+            latency_ns = strtoull(argv[i + 1], NULL, 0) * 1000U;
+        } else if (strcmp(argv[i], "--loss") == 0) {
+            loss_threshold = (uint32_t) (strtod(argv[i + 1], NULL) / 100.0 * 4294967295.0);
+        } else if (strcmp(argv[i], "--queue") == 0) {
+            queue_depth = (uint16_t) strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            random_state = strtoull(argv[i + 1], NULL, 0) | 1U;
+        } else if (strcmp(argv[i], "--pcap") == 0) {
+            pcap_path = argv[i + 1];
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (i >= argc || queue_depth == 0U || queue_depth > QUEUE_DEPTH_MAX) {
+        usage(argv[0]);
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    signal(SIGPIPE, SIG_IGN);
+
+    start_ns = now_ns();
+
+    if (pcap_path != NULL) {
+        pcap_open(pcap_path);
+    }
+
+    // the programs are split on "--", each one gets the next port
+    for (first = i; i <= argc; i++) {
+
+        if (i == argc || strcmp(argv[i], "--") == 0) {
+
+            if (i == first || port_count == PORTS_MAX) {
+                usage(argv[0]);
+            }
+
+            argv[i] = NULL;
+            start_program(port_count, &argv[first]);
+            port_count++;
+            first = i + 1;
+        }
+    }
+
+    run();
+    finish();
+
+    return EXIT_SUCCESS;
+}
@@ -67,6 +67,12 @@
 // *****************************************************************************
 // *****************************************************************************
 
+/* UART1 error, receive and transmit share one vector. The handler calls
+   FreeRTOS FromISR functions, so the vector enters the context saving
+   wrapper in interrupts_a.S. The IPL must match
+   UART1_DRIVER_INTERRUPT_PRIORITY. */
+void __attribute__((interrupt(IPL2AUTO), vector(_UART_1_VECTOR))) UART_1_Handler(void);
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -57,6 +57,8 @@
 // *****************************************************************************
 // *****************************************************************************
 
+void UART_1_Handler( void );
+
 
 
 #endif // INTERRUPTS_H
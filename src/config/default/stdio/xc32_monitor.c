@@ -38,6 +38,10 @@
 * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
 *******************************************************************************/
 #include <stddef.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "serial/serial_bridge.h"
+#include "uart/uart1_driver.h"
 
 extern int read(int handle, void *buffer, unsigned int len);
 extern int write(int handle, void * buffer, size_t count);
@@ -50,7 +54,17 @@ int read(int handle, void *buffer, unsigned int len)
 
 int write(int handle, void * buffer, size_t count)
 {
-   UART1_Write(buffer, count);
-   
-   return count;
+   /* UART1 belongs to the serial bridge client while it is connected */
+   if (serial_bridge_connected() == 1U)
+   {
+       return count;
+   }
+
+   /* Queued for the UART1 interrupt, only blocks while the buffer is full */
+   if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+   {
+       return uart1_driver_write(buffer, count, portMAX_DELAY);
+   }
+
+   return uart1_driver_write(buffer, count, 0U);
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+/*
+ *  lwIP network interface on the ENC624J600 driver.
+ *
+ *  The driver works on flat buffers: transmit takes the destination, the
+ *  EtherType and the payload, receive returns them the same way. Outgoing
+ *  pbuf chains are flattened into a static frame buffer, received frames
+ *  are read into the same buffer and copied into a PBUF_POOL chain, so the
+ *  netif allocates nothing but the pbufs lwIP asked for.
+ *
+ *  The tcpip thread transmits and the polling task receives, a mutex hands
+ *  the buffer between them. Either side holds it for one frame on SPI, at
+ *  most ~1.3 ms, which is cheaper than a second 1.5 KB buffer.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "lwip/opt.h"
+#include "lwip/etharp.h"
+#include "lwip/pbuf.h"
+#include "netif/ethernet.h"
+#include "enc624j600/enc624j600_driver.h"
+#include "enc624j600/enc624j600_netif.h"
+
+#define IFNAME0         'e'
+#define IFNAME1         'n'
+
+static uint8_t frame[SIZEOF_ETH_HDR + ENC624J600_NETIF_MTU];
+static SemaphoreHandle_t frame_lock = NULL;
+static StaticSemaphore_t frame_lock_control;
+
+static volatile uint32_t rx_dropped = 0U;
+static volatile uint32_t tx_failed = 0U;
+
+
+static err_t link_output(struct netif *netif, struct pbuf *p) {
+
+    err_t result = ERR_OK;
+
+    xSemaphoreTake(frame_lock, portMAX_DELAY);
+
+    u16_t length = pbuf_copy_partial(p, frame, sizeof(frame), 0U);
+
+    // the device inserts the source address itself (ECON2.TXMAC)
+    if (length <= SIZEOF_ETH_HDR) {
+        result = ERR_ARG;
+    } else if (enc624j600_transmit(&frame[0], &frame[12], &frame[SIZEOF_ETH_HDR],
+            length - SIZEOF_ETH_HDR) != ENC_TRANSMIT_SUCCEEDED) {
+        result = ERR_IF;
+    }
+
+    xSemaphoreGive(frame_lock);
+
+    if (result != ERR_OK) {
+        tx_failed++;
+    }
+
+    return result;
+}
+
+err_t enc624j600_netif_init(struct netif *netif) {
+
+    if (frame_lock == NULL) {
+        frame_lock = xSemaphoreCreateMutexStatic(&frame_lock_control);
+    }
+
+    netif->name[0] = IFNAME0;
+    netif->name[1] = IFNAME1;
+    netif->output = etharp_output;
+    netif->linkoutput = link_output;
+    netif->mtu = ENC624J600_NETIF_MTU;
+
+    netif->hwaddr_len = ETHARP_HWADDR_LEN;
+    enc624j600_read_mac_address(netif->hwaddr);
+
+    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET;
+
+    if (enc624j600_link_up() == 1U) {
+        netif->flags |= NETIF_FLAG_LINK_UP;
+    }
+
+    return ERR_OK;
+}
+
+uint8_t enc624j600_netif_poll(struct netif *netif) {
+
+    uint8_t frames = 0U;
+
+    while (frames < ENC624J600_NETIF_POLL_BUDGET) {
+
+        struct pbuf *p = NULL;
+        uint16_t length = 0U;
+
+        xSemaphoreTake(frame_lock, portMAX_DELAY);
+
+        if (enc624j600_receive(&frame[0], &frame[6], &frame[12],
+                &frame[SIZEOF_ETH_HDR], &length) != ENC_RECEIVE_SUCCEEDED) {
+            xSemaphoreGive(frame_lock);
+            break;
+        }
+
+        p = pbuf_alloc(PBUF_RAW, (u16_t) (SIZEOF_ETH_HDR + length), PBUF_POOL);
+
+        if (p != NULL) {
+            pbuf_take(p, frame, (u16_t) (SIZEOF_ETH_HDR + length));
+        }
+
+        xSemaphoreGive(frame_lock);
+
+        frames++;
+
+        if (p == NULL) {
+            rx_dropped++;
+            continue;
+        }
+
+        if (netif->input(p, netif) != ERR_OK) {
+            pbuf_free(p);
+            rx_dropped++;
+        }
+    }
+
+    return frames;
+}
+
+uint32_t enc624j600_netif_rx_dropped(void) {
+    return rx_dropped;
+}
+
+uint32_t enc624j600_netif_tx_failed(void) {
+    return tx_failed;
+}
@@ -0,0 +1,179 @@
+/*
+ *  SPI transaction trace of the ENC624J600 HAL.
+ *
+ *  Built with ENC624J600_TRACE set, the HAL calls the hooks at chip select
+ *  assert, for every byte and at chip select deassert. Each transaction
+ *  leaves a record with its start on the core timer, its duration, the
+ *  opcode, the byte after it (a register address or the low byte of a
+ *  pointer) and the number of bytes on the bus. The oldest record is
+ *  overwritten, the ring always holds the most recent traffic.
+ *
+ *  Transactions never overlap, the HAL holds the bus from assert to
+ *  deassert, so the ring has a single producer at a time.
+ */
+
+#include "FreeRTOS.h"
+#include "enc624j600/enc624j600_trace.h"
+
+#if ENC624J600_TRACE
+
+#define RING_MASK           (ENC624J600_TRACE_RECORDS - 1U)
+
+// core timer, SYSCLK / 2
+#define TIMER_HZ            (configCPU_CLOCK_HZ / 2U)
+
+typedef char trace_ring_power_of_2[((ENC624J600_TRACE_RECORDS & RING_MASK) == 0U) ? 1 : -1];
+
+static enc624j600_trace_record ring[ENC624J600_TRACE_RECORDS];
+static volatile uint32_t head = 0U;         /**< Sequence number of the next record */
+static volatile uint8_t enabled = 1U;
+
+// transaction in progress
+static uint8_t active = 0U;
+static uint32_t start;
+static uint32_t info;
+
+
+void enc624j600_trace_begin(void) {
+
+    active = enabled;
+
+    if (active == 1U) {
+        info = 0U;
+        start = portGET_RUN_TIME_COUNTER_VALUE();
+    }
+}
+
+void enc624j600_trace_byte(uint8_t data) {
+
+    if (active == 0U) {
+        return;
+    }
+
+    uint16_t length = (uint16_t) (info & 0xFFFFU);
+
+    if (length == 0U) {
+        info |= (uint32_t) data << 24;
+    } else if (length == 1U) {
+        info |= (uint32_t) data << 16;
+    }
+
+    if (length < 0xFFFFU) {
+        info++;
+    }
+}
+
+void enc624j600_trace_end(void) {
+
+    if (active == 0U) {
+        return;
+    }
+
+    enc624j600_trace_record *record = &ring[head & RING_MASK];
+
+    record->start = start;
+    record->duration = portGET_RUN_TIME_COUNTER_VALUE() - start;
+    record->info = info;
+
+    head = head + 1U;
+    active = 0U;
+}
+
+void enc624j600_trace_enable(uint8_t enable) {
+    enabled = (enable != 0U) ? 1U : 0U;
+}
+
+uint8_t enc624j600_trace_enabled(void) {
+    return enabled;
+}
+
+void enc624j600_trace_clear(void) {
+    head = 0U;
+}
+
+void enc624j600_trace_reader_init(enc624j600_trace_reader *reader) {
+
+    uint32_t newest = head;
+
+    // a full ring holds the last ENC624J600_TRACE_RECORDS records, the oldest in the slot written next
+    reader->next = (newest > ENC624J600_TRACE_RECORDS) ? newest - ENC624J600_TRACE_RECORDS : 0U;
+    reader->end = newest;
+    reader->header = 1U;
+}
+
+static char *put_hex(char *text, uint32_t value) {
+
+    static const char digits[] = "0123456789abcdef";
+    int8_t shift;
+
+    *text++ = ' ';
+
+    for (shift = 28; shift >= 0; shift -= 4) {
+        *text++ = digits[(value >> shift) & 0x0FU];
+    }
+
+    return text;
+}
+
+static uint16_t finish_line(char *line, char *end) {
+
+    *end++ = '\r';
+    *end++ = '\n';
+    *end = '\0';
+
+    return (uint16_t) (end - line);
+}
+
+uint16_t enc624j600_trace_read(enc624j600_trace_reader *reader, char *line) {
+
+    line[0] = '#';
+
+    if (reader->header == 1U) {
+
+        reader->header = 0U;
+        line[1] = 'T';
+
+        return finish_line(line, put_hex(&line[2], TIMER_HZ));
+    }
+
+    if (reader->next == reader->end) {
+        return 0U;
+    }
+
+    const enc624j600_trace_record *record = &ring[reader->next & RING_MASK];
+    char *end;
+
+    reader->next++;
+
+    line[1] = 'S';
+    end = put_hex(&line[2], record->start);
+    end = put_hex(end, record->duration);
+    end = put_hex(end, record->info);
+
+    return finish_line(line, end);
+}
+
+#else
+
+void enc624j600_trace_enable(uint8_t enable) {
+}
+
+uint8_t enc624j600_trace_enabled(void) {
+    return 0U;
+}
+
+void enc624j600_trace_clear(void) {
+}
+
+void enc624j600_trace_reader_init(enc624j600_trace_reader *reader) {
+
+    reader->next = 0U;
+    reader->end = 0U;
+    reader->header = 0U;
+}
+
+uint16_t enc624j600_trace_read(enc624j600_trace_reader *reader, char *line) {
+    return 0U;
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ *  Periodic housekeeping on FreeRTOS software timers.
+ *
+ *  All jobs run as timer callbacks in the timer service task, which sleeps
+ *  until the next expiry, so periodic work costs nothing between ticks and
+ *  whatever CPU is left shows up as idle time. Callbacks must not block
+ *  for long: the link poll waits at most for one SPI transaction of the
+ *  receive task, work that belongs to the tcpip thread is posted there and
+ *  skipped when its message box is full.
+ */
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "definitions.h"
+#include "lwip/tcpip.h"
+#include "enc624j600/enc624j600_driver.h"
+#include "housekeeping/housekeeping.h"
+#include "log/log.h"
+#include "telnet/telnet_server.h"
+
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    TimerCallbackFunction_t callback;
+} housekeeping_job;
+
+static void heartbeat(TimerHandle_t timer);
+static void poll_link(TimerHandle_t timer);
+static void sample_stats(TimerHandle_t timer);
+static void scan_idle_sessions(TimerHandle_t timer);
+
+static const housekeeping_job jobs[] = {
+    { "heartbeat", HOUSEKEEPING_HEARTBEAT_MS, heartbeat },
+    { "link", HOUSEKEEPING_LINK_POLL_MS, poll_link },
+    { "stats", HOUSEKEEPING_STATS_MS, sample_stats },
+    { "idle", HOUSEKEEPING_IDLE_SCAN_MS, scan_idle_sessions },
+};
+
+#define JOB_COUNT   (sizeof(jobs) / sizeof(jobs[0]))
+
+// the memory budget counts HOUSEKEEPING_JOB_COUNT timers
+typedef char housekeeping_job_count_matches[(JOB_COUNT == HOUSEKEEPING_JOB_COUNT) ? 1 : -1];
+
+static StaticTimer_t timers[HOUSEKEEPING_JOB_COUNT];
+
+static uint8_t link_up = 0U;
+static volatile uint16_t cpu_load = 0U;
+static configRUN_TIME_COUNTER_TYPE last_total = 0U;
+static configRUN_TIME_COUNTER_TYPE last_idle = 0U;
+
+
+static void heartbeat(TimerHandle_t timer) {
+    GPIO_PinToggle(GPIO_PIN_RD1);
+}
+
+static void poll_link(TimerHandle_t timer) {
+
+    uint8_t up = enc624j600_link_up();
+
+    if (up != link_up) {
+
+        link_up = up;
+
+        if (up == 1U) {
+            LOG("link up");
+        } else {
+            LOG("link down");
+        }
+    }
+}
+
+static void sample_stats(TimerHandle_t timer) {
+
+    configRUN_TIME_COUNTER_TYPE total = portGET_RUN_TIME_COUNTER_VALUE();
+    configRUN_TIME_COUNTER_TYPE idle = ulTaskGetIdleRunTimeCounter();
+    configRUN_TIME_COUNTER_TYPE elapsed = total - last_total;
+    configRUN_TIME_COUNTER_TYPE idle_elapsed = idle - last_idle;
+
+    if (elapsed > 0U && idle_elapsed <= elapsed) {
+        cpu_load = (uint16_t) (1000U - (uint32_t) (((uint64_t) idle_elapsed * 1000U) / elapsed));
+    }
+
+    last_total = total;
+    last_idle = idle;
+}
+
+static void scan_idle_sessions(TimerHandle_t timer) {
+
+    // the next scan comes soon enough if the message box is full
+    tcpip_try_callback(telnet_server_close_idle, NULL);
+}
+
+int housekeeping_init(void) {
+
+    uint8_t i;
+
+    for (i = 0; i < JOB_COUNT; i++) {
+
+        TimerHandle_t timer = xTimerCreateStatic(jobs[i].name, pdMS_TO_TICKS(jobs[i].period_ms), pdTRUE, NULL,
+                jobs[i].callback, &timers[i]);
+
+        // the command queue is not served before the scheduler runs, so no block time
+        if (timer == NULL || xTimerStart(timer, 0) != pdPASS) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+uint16_t housekeeping_cpu_load(void) {
+    return cpu_load;
+}
+
+uint8_t housekeeping_link_up(void) {
+    return link_up;
+}
@@ -0,0 +1,256 @@
+/*
+ *  Deferred binary logging.
+ *
+ *  LOG() stores the address of its format string and the raw arguments in
+ *  a ring of fixed size records, formatting happens on the host.
+ *
+ *  The ring is shared by all readers: the UART drain timer and every telnet
+ *  session following the log. Each reader only keeps a sequence number, so
+ *  another observer costs eight bytes and no copy of the data. Producers
+ *  never wait for readers and overwrite the oldest record, a reader that
+ *  fell behind notices the gap in the sequence numbers and reports the
+ *  number of lost lines instead.
+ *
+ *  Producers reserve a sequence number with an atomic increment of the
+ *  head and publish the record by storing its sequence number + 1 in the
+ *  slot last. Readers check that stamp before and after copying a record,
+ *  which catches records still being written as well as records
+ *  overwritten while they were copied. Tasks and interrupts never block
+ *  each other.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "log/log.h"
+#include "serial/serial_bridge.h"
+#include "uart/uart1_driver.h"
+
+#define RING_MASK           (LOG_RING_RECORDS - 1U)
+
+#define COUNT_SHIFT         28U
+#define TICKS_MASK          0x0FFFFFFFU
+
+typedef struct {
+    volatile uint32_t stamp;    /**< Sequence number + 1 once committed, 0 while written */
+    uint32_t format;
+    uint32_t info;              /**< Argument count (bits 31..28) and tick count (27..0) */
+    uint32_t args[LOG_ARGS_MAX];
+} log_slot;
+
+static log_slot ring[LOG_RING_RECORDS];
+static volatile uint32_t head = 0U;         /**< Next sequence number, advanced by producers */
+
+// the memory budget sizes the ring from log.h
+typedef char log_ring_matches_budget[(sizeof(ring) == LOG_RING_BYTES) ? 1 : -1];
+
+
+void log_record(const char *format, uint8_t count, ...) {
+
+    uint32_t sequence;
+    log_slot *slot;
+    uint8_t i;
+    va_list args;
+
+    if (count > LOG_ARGS_MAX) {
+        count = LOG_ARGS_MAX;
+    }
+
+    sequence = __sync_fetch_and_add(&head, 1U);
+    slot = &ring[sequence & RING_MASK];
+
+    // readers skip the slot until the new stamp is stored
+    slot->stamp = 0U;
+    __sync_synchronize();
+
+    slot->format = (uint32_t) (uintptr_t) format;
+    slot->info = ((uint32_t) count << COUNT_SHIFT) | (xTaskGetTickCount() & TICKS_MASK);
+
+    va_start(args, count);
+
+    for (i = 0; i < count; i++) {
+        slot->args[i] = va_arg(args, uint32_t);
+    }
+
+    va_end(args);
+
+    // the record must be complete before readers can see it
+    __sync_synchronize();
+    slot->stamp = sequence + 1U;
+}
+
+static char *put_hex(char *text, uint32_t value) {
+
+    static const char digits[] = "0123456789abcdef";
+    int8_t shift;
+
+    *text++ = ' ';
+
+    for (shift = 28; shift >= 0; shift -= 4) {
+        *text++ = digits[(value >> shift) & 0x0FU];
+    }
+
+    return text;
+}
+
+static uint16_t finish_line(char *line, char *end) {
+
+    *end++ = '\r';
+    *end++ = '\n';
+    *end = '\0';
+
+    return (uint16_t) (end - line);
+}
+
+void log_reader_init(log_reader *reader, uint8_t oldest) {
+
+    uint32_t newest = head;
+
+    reader->next = newest;
+    reader->lost = 0U;
+
+    if (oldest == 1U) {
+        reader->next = (newest >= LOG_RING_RECORDS) ? newest - LOG_RING_RECORDS : 0U;
+    }
+}
+
+uint16_t log_read(log_reader *reader, char *line) {
+
+    static const char dropped[] = " lines dropped";
+
+    for (;;) {
+
+        uint32_t newest = head;
+
+        if (newest - reader->next > LOG_RING_RECORDS) {
+            // overwritten before this reader got to them
+            reader->lost += newest - LOG_RING_RECORDS - reader->next;
+            reader->next = newest - LOG_RING_RECORDS;
+        }
+
+        if (reader->lost > 0U) {
+
+            char *end;
+
+            line[0] = '#';
+            line[1] = 'D';
+            end = put_hex(&line[2], reader->lost);
+            memcpy(end, dropped, sizeof(dropped) - 1U);
+
+            reader->lost = 0U;
+
+            return finish_line(line, end + sizeof(dropped) - 1U);
+        }
+
+        if (reader->next == newest) {
+            return 0U;
+        }
+
+        const log_slot *slot = &ring[reader->next & RING_MASK];
+        uint32_t stamp = slot->stamp;
+
+        if (stamp != reader->next + 1U) {
+
+            // either the producer has not committed yet, or a newer record
+            // is replacing this one and the head check above catches up
+            if (head - reader->next > LOG_RING_RECORDS) {
+                continue;
+            }
+
+            return 0U;
+        }
+
+        __sync_synchronize();
+
+        uint32_t format = slot->format;
+        uint32_t info = slot->info;
+        uint32_t args[LOG_ARGS_MAX];
+        uint8_t count = (uint8_t) (info >> COUNT_SHIFT);
+        uint8_t i;
+
+        if (count > LOG_ARGS_MAX) {
+            count = LOG_ARGS_MAX;
+        }
+
+        for (i = 0; i < count; i++) {
+            args[i] = slot->args[i];
+        }
+
+        __sync_synchronize();
+
+        if (slot->stamp != stamp) {
+            // overwritten while copying
+            continue;
+        }
+
+        reader->next++;
+
+        char *end;
+
+        line[0] = '#';
+        line[1] = 'L';
+        end = put_hex(&line[2], format);
+        end = put_hex(end, info & TICKS_MASK);
+
+        for (i = 0; i < count; i++) {
+            end = put_hex(end, args[i]);
+        }
+
+        return finish_line(line, end);
+    }
+}
+
+#if LOG_DRAIN
+
+static log_reader drain_reader;
+static StaticTimer_t drain_timer;
+
+// runs in the timer task, which must not wait on the UART
+static void drain(TimerHandle_t timer) {
+
+    char line[LOG_LINE_MAX];
+
+    // UART1 belongs to the bridge client, the reader reports the gap afterwards
+    if (serial_bridge_connected() != 0U) {
+        return;
+    }
+
+    while (uart1_driver_write_space() >= LOG_LINE_MAX) {
+
+        log_reader before = drain_reader;
+        uint16_t length = log_read(&drain_reader, line);
+
+        if (length == 0U) {
+            break;
+        }
+
+        // another writer holds the UART, send the line on the next run
+        if (uart1_driver_write(line, length, 0U) != length) {
+            drain_reader = before;
+            break;
+        }
+    }
+}
+
+#endif
+
+int log_init(void) {
+
+#if LOG_DRAIN
+    TimerHandle_t timer;
+
+    log_reader_init(&drain_reader, 1U);
+
+    timer = xTimerCreateStatic("log", pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS), pdTRUE, NULL, drain, &drain_timer);
+
+    if (timer == NULL || xTimerStart(timer, 0U) != pdPASS) {
+        return -1;
+    }
+#endif
+
+    return 0;
+}
@@ -30,10 +30,32 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
-#include "enc624j600/enc624j600_driver.h"
-
-void my_first_task(void *parameter);
-void my_second_task(void *parameter);
+#include "semphr.h"
+#include "enc624j600/enc624j600_driver_hal.h"
+#include "enc624j600/enc624j600_trace.h"
+#include "lwip/tcpip.h"
+#include "network/iperf_server.h"
+#include "network/network.h"
+#include "telnet/telnet_server.h"
+#include "shell/shell.h"
+#include "shell/shell_worker.h"
+#include "serial/serial_bridge.h"
+#include "uart/uart1_driver.h"
+#include "log/log.h"
+#include "housekeeping/housekeeping.h"
+
+void network_init_done(void *parameter);
+
+// serializes ENC624J600 transactions of the network task, the tcpip thread and the housekeeping link poll
+static SemaphoreHandle_t spi_lock = NULL;
+static StaticSemaphore_t spi_lock_control;
+
+static const network_config network = {
+    NETWORK_DEFAULT_ADDRESS,
+    NETWORK_DEFAULT_NETMASK,
+    NETWORK_DEFAULT_GATEWAY,
+    NULL
+};
 
 // *****************************************************************************
 // *****************************************************************************
@@ -54,6 +76,13 @@ int main ( void )
     
     UART1_SerialSetup(&uart_setup, 0);
     
+    // printf and the serial bridge go through the interrupt driven driver
+    if (uart1_driver_init() != 0) {
+        for (;;) {
+            
+        }
+    }
+    
     SPI_TRANSFER_SETUP spi_setup;
     spi_setup.clockFrequency = 10000000;
     spi_setup.clockPhase = SPI_CLOCK_PHASE_LEADING_EDGE;
@@ -74,36 +103,45 @@ int main ( void )
     // SYSCLK, PBCLK = 76Mhz
     // task priorities 0 - 4
     
-    BaseType_t returned;
+    spi_lock = xSemaphoreCreateMutexStatic(&spi_lock_control);
     
-    returned = xTaskCreate(
-            my_first_task,
-            "first",
-            configMINIMAL_STACK_SIZE,
-            NULL,
-            1,
-            NULL);
+    if (spi_lock == NULL) {
+        for (;;) {
+            
+        }
+    }
     
-    if (returned != pdPASS) {
+    // LED heartbeat, link polling, CPU load and idle sessions on software timers
+    if (housekeeping_init() != 0) {
         for (;;) {
             
         }
     }
     
-    returned = xTaskCreate(
-            my_second_task,
-            "second",
-            configMINIMAL_STACK_SIZE,
-            NULL,
-            2,
-            NULL);
+    // ENC624J600 bring-up and receive polling
+    if (network_init(&network) != 0) {
+        for (;;) {
+            
+        }
+    }
     
-    if (returned != pdPASS) {
+    // records from LOG() are drained to UART1 or the log command
+    if (log_init() != 0) {
         for (;;) {
             
         }
     }
     
+    // slow shell commands run here instead of the tcpip thread
+    if (shell_worker_init() != 0) {
+        for (;;) {
+            
+        }
+    }
+    
+    // lwIP core, the telnet server is started from the tcpip thread
+    tcpip_init(network_init_done, NULL);
+    
     vTaskStartScheduler();
 
     while ( true )
@@ -117,80 +155,13 @@ int main ( void )
     return ( EXIT_FAILURE );
 }
 
-void my_first_task(void *parameter) {
-    
-    // toggle LED 2 every two seconds
-    
-    TickType_t ticks = xTaskGetTickCount();
-    
-    for (;;) {
-        
-        if ((xTaskGetTickCount() - ticks) > pdMS_TO_TICKS(500)) {
-            
-            GPIO_PinToggle(GPIO_PIN_RD1);
-            
-            ticks = xTaskGetTickCount();
-        }
-    }
-}
-
-uint8_t data[100];
-
-void my_second_task(void *parameter) {
-    
-    // toggle LED 3
-    // then sleep for 5 seconds
+void network_init_done(void *parameter) {
     
-    enc624j600_init();
+    telnet_server_init(shell_execute, shell_output_reserve);
+    serial_bridge_init();
     
-    uint8_t destination_address[6];
-    uint8_t source_address[6];
-    uint16_t length_protocol = 0;
-    uint16_t data_length = 0;
-    
-    int i;
-    
-    for (;;) {
-        
-        GPIO_PinToggle(GPIO_PIN_RD2);
-        
-        if (enc624j600_receive(destination_address, source_address, &length_protocol, data, &data_length) == 0) {
-            
-            printf("Destination: ");
-            for(i = 0; i < 6; i++) {
-                
-                if (i == 5) {
-                    printf("%X\r\n", destination_address[i]);
-                    continue;
-                }
-                
-                printf("%X:", destination_address[i]);
-            }
-            
-            printf("Source: ");
-            for(i = 0; i < 6; i++) {
-                
-                if (i == 5) {
-                    printf("%X\r\n", source_address[i]);
-                    continue;
-                }
-                
-                printf("%X:", source_address[i]);
-            }
-            
-            printf("Length/Protocol: 0x%X\r\n", length_protocol);
-            
-            for (i = 0; i < data_length; i++) {
-                printf("%c ", data[i]);
-            }
-            
-            printf("\r\n\r\n");
-            
-        } else {
-            printf("Nothing!\r\n");
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(5000));
+    if (IPERF_SERVER_AT_BOOT == 1) {
+        iperf_server_start();
     }
 }
 
@@ -204,6 +175,8 @@ uint8_t enc624j600_hal_spi_transfer(uint8_t data) {
     
     uint8_t receive = 0;
     
+    ENC624J600_TRACE_BYTE(data);
+    
     SPI2_WriteRead(&data, 1, &receive, 1);
     
     return receive;
@@ -211,6 +184,13 @@ uint8_t enc624j600_hal_spi_transfer(uint8_t data) {
 
 void enc624j600_hal_cs_assert(void) {
     
+    // a transaction runs from CS assert to CS deassert, the scheduler may not run yet during init
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreTake(spi_lock, portMAX_DELAY);
+    }
+    
+    ENC624J600_TRACE_BEGIN();
+    
     // NOP 13 ns
     
     GPIO_PinClear(GPIO_PIN_RF12);
@@ -227,6 +207,12 @@ void enc624j600_hal_cs_deassert(void) {
     
     Nop();
     Nop();
+    
+    ENC624J600_TRACE_END();
+    
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreGive(spi_lock);
+    }
 }
 
 void enc624j600_hal_delay(uint8_t us) {
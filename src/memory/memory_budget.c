@@ -0,0 +1,142 @@
+/*
+ *  Compile-time memory budget.
+ *
+ *  There is no heap: every task, queue, semaphore, timer, stream buffer
+ *  and session or ring buffer is allocated statically by the module that
+ *  owns it, lwIP allocates from its own heap and memp pools and sys_arch
+ *  hands out mailboxes, semaphores and threads from fixed pools. The table
+ *  below repeats the sizing of all of them, so the RAM plan is known before
+ *  anything runs: the total is checked against the budget at compile time
+ *  and the mem command prints the breakdown.
+ *
+ *  When a module gains a static kernel object or a buffer of more than a
+ *  few dozen bytes, or a pool changes shape, the entry here changes with it.
+ */
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "memory/memory_budget.h"
+#include "enc624j600/enc624j600_netif.h"
+#include "enc624j600/enc624j600_trace.h"
+#include "housekeeping/housekeeping.h"
+#include "log/log.h"
+#include "network/network.h"
+#include "serial/serial_bridge.h"
+#include "shell/shell_chargen.h"
+#include "shell/shell_top.h"
+#include "shell/shell_worker.h"
+#include "telnet/telnet_output.h"
+#include "telnet/telnet_server.h"
+#include "uart/uart1_driver.h"
+
+// everything memp.c needs for the element sizes in memp_std.h
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/priv/memp_priv.h"
+#include "lwip/pbuf.h"
+#include "lwip/raw.h"
+#include "lwip/udp.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/altcp.h"
+#include "lwip/ip4_frag.h"
+#include "lwip/netbuf.h"
+#include "lwip/api.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/priv/api_msg.h"
+#include "lwip/priv/sockets_priv.h"
+#include "lwip/etharp.h"
+#include "lwip/igmp.h"
+#include "lwip/timeouts.h"
+#include "netif/ppp/ppp_opts.h"
+#include "lwip/netdb.h"
+#include "lwip/dns.h"
+#include "lwip/priv/nd6_priv.h"
+#include "lwip/ip6_frag.h"
+#include "lwip/mld6.h"
+#include "lwip/sys.h"
+#include "lwip/stats.h"
+
+#define TASK_BYTES(stack_words)         (sizeof(StaticTask_t) + (stack_words) * sizeof(StackType_t))
+#define QUEUE_BYTES(length, item_size)  (sizeof(StaticQueue_t) + (length) * (item_size))
+
+// a stream buffer keeps one byte of its storage empty
+#define STREAM_BYTES(size)              (sizeof(StaticStreamBuffer_t) + (size) + 1U)
+
+// timer command queue items are timers.c's private DaemonTaskMessage_t: an id and the larger of its two parameter blocks
+#define TIMER_MESSAGE_SIZE              (sizeof(BaseType_t) + sizeof(void (*)(void)) + sizeof(void *) + sizeof(uint32_t))
+
+// serial_bridge.c's private byte_ring from the UART: two uint16_t indices in front of the buffer
+#define BRIDGE_RING_INDEX_BYTES         (2U * sizeof(uint16_t))
+
+// lwIP heap as declared in mem.c: the aligned MEM_SIZE plus two struct mem, which is two mem_size_t and a flag
+#define LWIP_HEAP_BYTES                 LWIP_MEM_ALIGN_BUFFER(LWIP_MEM_ALIGN_SIZE(MEM_SIZE) + 2U * LWIP_MEM_ALIGN_SIZE(2U * sizeof(mem_size_t) + 1U))
+
+// memp pools as declared in memp.c, one member per pool so sizeof adds them up
+typedef struct {
+#define LWIP_MEMPOOL(name, num, size, desc)     u8_t name[LWIP_MEM_ALIGN_BUFFER((num) * (MEMP_SIZE + MEMP_ALIGN_SIZE(size)))];
+#include "lwip/priv/memp_std.h"
+} lwip_memp_layout;
+
+// lwip_stats with the heap figures and a pointer per pool, plus the stats_mem memp.c declares for every pool
+#if LWIP_POOL_STATS
+#define LWIP_POOL_STATS_BYTES           (sizeof(struct stats_) + MEMP_MAX * sizeof(struct stats_mem))
+#else
+#define LWIP_POOL_STATS_BYTES           0U
+#endif
+
+#define MEMORY_BUDGET_POOLS(X) \
+    X("idle task", TASK_BYTES(configMINIMAL_STACK_SIZE)) \
+    X("timer task", TASK_BYTES(configTIMER_TASK_STACK_DEPTH)) \
+    X("timer queue", QUEUE_BYTES(configTIMER_QUEUE_LENGTH, TIMER_MESSAGE_SIZE)) \
+    X("interrupt stack", configISR_STACK_SIZE * sizeof(StackType_t)) \
+    X("housekeeping timers", HOUSEKEEPING_JOB_COUNT * sizeof(StaticTimer_t)) \
+    X("network task", TASK_BYTES(NETWORK_TASK_STACK_SIZE)) \
+    X("ethernet frame", ENC624J600_NETIF_BUFFER_BYTES + sizeof(StaticSemaphore_t)) \
+    X("spi lock", sizeof(StaticSemaphore_t)) \
+    X("spi trace", ENC624J600_TRACE * ENC624J600_TRACE_RECORDS * sizeof(enc624j600_trace_record)) \
+    X("log ring", LOG_RING_BYTES) \
+    X("log drain timer", LOG_DRAIN * sizeof(StaticTimer_t)) \
+    X("uart1 buffers", STREAM_BYTES(UART1_DRIVER_TX_SIZE) + STREAM_BYTES(UART1_DRIVER_RX_SIZE) + sizeof(StaticSemaphore_t)) \
+    X("shell workers", SHELL_WORKER_COUNT * TASK_BYTES(SHELL_WORKER_STACK_SIZE)) \
+    X("shell job queue", QUEUE_BYTES(SHELL_WORKER_QUEUE_DEPTH, sizeof(void *))) \
+    X("shell jobs", SHELL_WORKER_QUEUE_DEPTH * sizeof(shell_job)) \
+    X("phy lock", sizeof(StaticSemaphore_t)) \
+    X("top views", TELNET_MAX_SESSIONS * sizeof(top_view) + sizeof(top_monitor)) \
+    X("chargen streams", TELNET_MAX_SESSIONS * sizeof(chargen_stream)) \
+    X("telnet sessions", TELNET_MAX_SESSIONS * sizeof(telnet_session)) \
+    X("bridge pump task", TASK_BYTES(SERIAL_BRIDGE_PUMP_STACK_SIZE)) \
+    X("bridge rings", sizeof(telnet_output) + SERIAL_BRIDGE_RING_SIZE + BRIDGE_RING_INDEX_BYTES) \
+    X("lwip heap", LWIP_HEAP_BYTES) \
+    X("lwip memp", sizeof(lwip_memp_layout)) \
+    X("lwip pool stats", LWIP_POOL_STATS_BYTES) \
+    X("lwip threads", LWIP_FREERTOS_STATIC_THREADS * TASK_BYTES(LWIP_FREERTOS_STACK_WORDS(LWIP_FREERTOS_STATIC_THREAD_STACKSIZE))) \
+    X("lwip mailboxes", LWIP_FREERTOS_STATIC_MBOXES * QUEUE_BYTES(LWIP_FREERTOS_STATIC_MBOX_SIZE, sizeof(void *))) \
+    X("lwip semaphores", LWIP_FREERTOS_STATIC_SEMS * sizeof(StaticSemaphore_t))
+
+#define POOL_ENTRY(name, bytes)     { name, (uint32_t) (bytes) },
+#define POOL_SUM(name, bytes)       + (bytes)
+
+#define MEMORY_BUDGET_TOTAL         (0U MEMORY_BUDGET_POOLS(POOL_SUM))
+
+// only the target has the RAM limit, host builds have wider stacks and pointers
+#ifdef __XC32
+typedef char memory_budget_fits[(MEMORY_BUDGET_TOTAL <= MEMORY_BUDGET_RAM_SIZE - MEMORY_BUDGET_RESERVE) ? 1 : -1];
+#endif
+
+const memory_budget_pool memory_budget_pools[] = {
+    MEMORY_BUDGET_POOLS(POOL_ENTRY)
+};
+
+#define POOL_COUNT  (sizeof(memory_budget_pools) / sizeof(memory_budget_pools[0]))
+
+
+uint8_t memory_budget_pool_count(void) {
+    return (uint8_t) POOL_COUNT;
+}
+
+uint32_t memory_budget_total(void) {
+    return (uint32_t) MEMORY_BUDGET_TOTAL;
+}
@@ -0,0 +1,223 @@
+/*
+ *  iperf2 compatible TCP throughput server.
+ *
+ *  Measures the receive path of the ENC624J600 and lwIP without the
+ *  telnet code in the way: an iperf2 client connects to port 5001 and
+ *  sends as fast as the window lets it, the server acknowledges every
+ *  byte as soon as it arrives and throws it away. The iperf2 header at
+ *  the start of the stream is not interpreted, a plain "iperf -c" test
+ *  needs no answer.
+ *
+ *  lwIP's own lwiperf app is not part of the tree, its header is: the
+ *  reports use its report types so results read the same. Everything
+ *  runs in the tcpip thread on the raw API and allocates nothing beyond
+ *  the listener and the connection pcb.
+ */
+
+#include <stddef.h>
+
+#include "lwip/tcp.h"
+#include "lwip/sys.h"
+#include "log/log.h"
+#include "network/iperf_server.h"
+
+// tcp_poll interval in coarse timer ticks (500 ms)
+#define POLL_INTERVAL   2U
+
+static struct tcp_pcb *listen_pcb = NULL;
+static struct tcp_pcb *test_pcb = NULL;
+
+static iperf_server_report running;
+static u32_t started;
+static u32_t last_data;
+
+static iperf_server_report last;
+static uint32_t finished = 0U;
+
+
+static void update(iperf_server_report *report) {
+
+    u32_t ms = sys_now() - started;
+
+    report->ms = ms;
+    report->kbit_per_second = (ms == 0U) ? 0U : (uint32_t) (((uint64_t) report->bytes * 8U) / ms);
+}
+
+// ends the test, the pcb is already closed, aborted or freed by lwIP
+static void finish(enum lwiperf_report_type type) {
+
+    running.type = type;
+    update(&running);
+
+    last = running;
+    finished++;
+    test_pcb = NULL;
+
+    LOG("iperf %u bytes in %u ms, %u kbit/s, result %u", (unsigned) last.bytes, (unsigned) last.ms,
+        (unsigned) last.kbit_per_second, (unsigned) last.type);
+}
+
+static void detach(struct tcp_pcb *pcb) {
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0U);
+}
+
+static err_t test_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+
+    if (p == NULL) {
+
+        // the client is done sending
+        detach(pcb);
+
+        if (tcp_close(pcb) != ERR_OK) {
+            tcp_abort(pcb);
+            finish(LWIPERF_TCP_DONE_SERVER);
+            return ERR_ABRT;
+        }
+
+        finish(LWIPERF_TCP_DONE_SERVER);
+        return ERR_OK;
+    }
+
+    running.bytes += p->tot_len;
+    last_data = sys_now();
+
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    return ERR_OK;
+}
+
+static void test_err(void *arg, err_t err) {
+
+    // lwIP already freed the pcb
+    finish(LWIPERF_TCP_ABORTED_REMOTE);
+}
+
+static err_t test_poll(void *arg, struct tcp_pcb *pcb) {
+
+    if ((u32_t) (sys_now() - last_data) < IPERF_SERVER_IDLE_TIMEOUT_MS) {
+        return ERR_OK;
+    }
+
+    detach(pcb);
+    tcp_abort(pcb);
+    finish(LWIPERF_TCP_ABORTED_LOCAL);
+
+    return ERR_ABRT;
+}
+
+static err_t server_accept(void *arg, struct tcp_pcb *newpcb, err_t err) {
+
+    if (err != ERR_OK || newpcb == NULL) {
+        return ERR_VAL;
+    }
+
+    // one test at a time, a second client would only share the window
+    if (test_pcb != NULL) {
+        tcp_abort(newpcb);
+        return ERR_ABRT;
+    }
+
+    test_pcb = newpcb;
+
+    running.type = LWIPERF_TCP_DONE_SERVER;
+    ip_addr_copy(running.remote_address, newpcb->remote_ip);
+    running.remote_port = newpcb->remote_port;
+    running.bytes = 0U;
+    running.ms = 0U;
+    running.kbit_per_second = 0U;
+
+    started = sys_now();
+    last_data = started;
+
+    tcp_arg(newpcb, NULL);
+    tcp_recv(newpcb, test_recv);
+    tcp_err(newpcb, test_err);
+    tcp_poll(newpcb, test_poll, POLL_INTERVAL);
+
+    return ERR_OK;
+}
+
+err_t iperf_server_start(void) {
+
+    err_t err;
+
+    if (listen_pcb != NULL) {
+        return ERR_OK;
+    }
+
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+
+    if (pcb == NULL) {
+        return ERR_MEM;
+    }
+
+    err = tcp_bind(pcb, IP_ANY_TYPE, IPERF_SERVER_PORT);
+
+    if (err != ERR_OK) {
+        tcp_close(pcb);
+        return err;
+    }
+
+    listen_pcb = tcp_listen(pcb);
+
+    if (listen_pcb == NULL) {
+        tcp_close(pcb);
+        return ERR_MEM;
+    }
+
+    tcp_accept(listen_pcb, server_accept);
+
+    return ERR_OK;
+}
+
+void iperf_server_stop(void) {
+
+    if (test_pcb != NULL) {
+
+        struct tcp_pcb *pcb = test_pcb;
+
+        detach(pcb);
+        tcp_abort(pcb);
+        finish(LWIPERF_TCP_ABORTED_LOCAL);
+    }
+
+    if (listen_pcb != NULL) {
+        tcp_close(listen_pcb);
+        listen_pcb = NULL;
+    }
+}
+
+uint8_t iperf_server_listening(void) {
+    return (listen_pcb != NULL) ? 1U : 0U;
+}
+
+uint8_t iperf_server_progress(iperf_server_report *report) {
+
+    if (test_pcb == NULL) {
+        return 0U;
+    }
+
+    update(&running);
+
+    report->remote_address = running.remote_address;
+    report->remote_port = running.remote_port;
+    report->bytes = running.bytes;
+    report->ms = running.ms;
+    report->kbit_per_second = running.kbit_per_second;
+
+    return 1U;
+}
+
+uint32_t iperf_server_last_report(iperf_server_report *report) {
+
+    if (finished > 0U) {
+        *report = last;
+    }
+
+    return finished;
+}
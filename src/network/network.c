@@ -0,0 +1,94 @@
+/*
+ *  Network interface bring-up and receive polling.
+ *
+ *  One task owns the receive side of the ENC624J600: it runs the driver
+ *  initialization, which spins until auto-negotiation completed, adds the
+ *  netif through the netifapi and then moves received frames into lwIP.
+ *  While frames are pending it polls back to back, then once per
+ *  NETWORK_POLL_INTERVAL_MS, and an idle device once per
+ *  NETWORK_IDLE_POLL_INTERVAL_MS.
+ */
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lwip/ip4_addr.h"
+#include "lwip/netifapi.h"
+#include "lwip/tcpip.h"
+#include "enc624j600/enc624j600_driver.h"
+#include "enc624j600/enc624j600_netif.h"
+#include "log/log.h"
+#include "network/network.h"
+
+static network_config settings;
+static struct netif netif;
+static volatile uint8_t up = 0U;
+
+static StaticTask_t network_tcb;
+static StackType_t network_stack[NETWORK_TASK_STACK_SIZE];
+
+
+static void network_task(void *parameter) {
+
+    enc624j600_config device = { 0 };
+    ip4_addr_t address;
+    ip4_addr_t netmask;
+    ip4_addr_t gateway;
+
+    device.mac_address = settings.mac_address;
+    enc624j600_init(&device);
+
+    IP4_ADDR(&address, settings.address[0], settings.address[1], settings.address[2], settings.address[3]);
+    IP4_ADDR(&netmask, settings.netmask[0], settings.netmask[1], settings.netmask[2], settings.netmask[3]);
+    IP4_ADDR(&gateway, settings.gateway[0], settings.gateway[1], settings.gateway[2], settings.gateway[3]);
+
+    if (netifapi_netif_add(&netif, &address, &netmask, &gateway, NULL, enc624j600_netif_init, tcpip_input) != ERR_OK) {
+
+        LOG("netif add failed");
+        vTaskSuspend(NULL);
+    }
+
+    netifapi_netif_set_default(&netif);
+    netifapi_netif_set_up(&netif);
+
+    up = 1U;
+    LOG("network up %u.%u.%u.%u", settings.address[0], settings.address[1], settings.address[2], settings.address[3]);
+
+    TickType_t last_frame = xTaskGetTickCount();
+
+    for (;;) {
+
+        uint8_t frames = enc624j600_netif_poll(&netif);
+
+        if (frames > 0U) {
+            last_frame = xTaskGetTickCount();
+        }
+
+        // a full budget means more frames may be waiting
+        if (frames < ENC624J600_NETIF_POLL_BUDGET) {
+
+            if ((xTaskGetTickCount() - last_frame) < pdMS_TO_TICKS(NETWORK_IDLE_AFTER_MS)) {
+                vTaskDelay(pdMS_TO_TICKS(NETWORK_POLL_INTERVAL_MS));
+            } else {
+                vTaskDelay(pdMS_TO_TICKS(NETWORK_IDLE_POLL_INTERVAL_MS));
+            }
+        }
+    }
+}
+
+int network_init(const network_config *config) {
+
+    settings = *config;
+
+    if (xTaskCreateStatic(network_task, "network", NETWORK_TASK_STACK_SIZE, NULL, NETWORK_TASK_PRIORITY,
+            network_stack, &network_tcb) == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+uint8_t network_up(void) {
+    return up;
+}
@@ -0,0 +1,267 @@
+/*
+ *  Per-connection TCP figures.
+ *
+ *  Laggy sessions have three usual causes: a long round trip, lost
+ *  segments or output piling up on the device. lwIP keeps none of that
+ *  per connection beyond its 500 ms RTT estimate, so two lwIP hooks watch
+ *  the segments of the attached connections:
+ *
+ *      out     a data segment below snd_nxt is a retransmission, fast when
+ *              the pcb is in fast recovery without an RTO; new data is
+ *              timed unless a segment already is
+ *      in      an ACK covering the timed segment is an RTT sample, a zero
+ *              window from the peer starts a stall that lasts until the
+ *              window opens
+ *
+ *  The output path of the owner reports the time its data waited for room
+ *  in lwIP's send buffer. Durations go into log2 histograms in us, timed
+ *  on the core timer, and on sys_now() once they get near its wrap.
+ *
+ *  Everything runs in the tcpip thread: the hooks are called from
+ *  tcp_input() and tcp_output(), the owner attaches and detaches from
+ *  its tcp callbacks. Finding the figures of a pcb is a scan of
+ *  TCP_METRICS_CONNECTIONS pointers per segment.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "lwip/def.h"
+#include "lwip/sys.h"
+#include "lwip/priv/tcp_priv.h"
+#include "network/tcp_metrics.h"
+
+#if TCP_METRICS
+
+// core timer, SYSCLK / 2
+#define TIMER_TICKS_PER_US  (configCPU_CLOCK_HZ / 2U / 1000000U)
+
+// the core timer wraps after 113 s, longer waits are timed in milliseconds
+#define WRAP_GUARD_MS       100000U
+
+static tcp_metrics *attached[TCP_METRICS_CONNECTIONS];
+
+
+static void record(tcp_metrics_histogram *histogram, uint32_t us) {
+
+    uint8_t bucket = 0U;
+    uint32_t bound = TCP_METRICS_FIRST_BUCKET_US;
+
+    while (bucket < TCP_METRICS_BUCKETS - 1U && us >= bound) {
+        bucket++;
+        bound <<= 1;
+    }
+
+    if (histogram->buckets[bucket] < 0xFFFFU) {
+        histogram->buckets[bucket]++;
+    }
+
+    if (histogram->count == 0U || us < histogram->min_us) {
+        histogram->min_us = us;
+    }
+
+    if (us > histogram->max_us) {
+        histogram->max_us = us;
+    }
+
+    histogram->count++;
+    histogram->sum_us += us;
+}
+
+static uint32_t elapsed_us(uint32_t start, u32_t start_ms) {
+
+    u32_t ms = sys_now() - start_ms;
+
+    if (ms >= WRAP_GUARD_MS) {
+        return (ms > UINT32_MAX / 1000U) ? UINT32_MAX : ms * 1000U;
+    }
+
+    return (portGET_RUN_TIME_COUNTER_VALUE() - start) / TIMER_TICKS_PER_US;
+}
+
+// zeroes the figures, measurements under way start over from now
+static void clear(tcp_metrics *metrics) {
+
+    memset(&metrics->rtt, 0, sizeof(metrics->rtt));
+    memset(&metrics->sndbuf_wait, 0, sizeof(metrics->sndbuf_wait));
+
+    metrics->retransmits = 0U;
+    metrics->fast_retransmits = 0U;
+    metrics->zero_windows = 0U;
+    metrics->zero_window_ms = 0U;
+
+    metrics->rtt_timing = 0U;
+    metrics->wait_start = portGET_RUN_TIME_COUNTER_VALUE();
+    metrics->wait_start_ms = sys_now();
+    metrics->zero_window_start = metrics->wait_start_ms;
+}
+
+void tcp_metrics_attach(tcp_metrics *metrics, const struct tcp_pcb *pcb) {
+
+    uint8_t i;
+
+    metrics->pcb = NULL;
+    metrics->waiting = 0U;
+    metrics->zero_window = 0U;
+    clear(metrics);
+
+    for (i = 0U; i < TCP_METRICS_CONNECTIONS; i++) {
+
+        if (attached[i] == NULL) {
+            attached[i] = metrics;
+            metrics->pcb = pcb;
+            return;
+        }
+    }
+}
+
+void tcp_metrics_detach(tcp_metrics *metrics) {
+
+    uint8_t i;
+
+    for (i = 0U; i < TCP_METRICS_CONNECTIONS; i++) {
+
+        if (attached[i] == metrics) {
+            attached[i] = NULL;
+        }
+    }
+
+    metrics->pcb = NULL;
+}
+
+void tcp_metrics_reset(void) {
+
+    uint8_t i;
+
+    for (i = 0U; i < TCP_METRICS_CONNECTIONS; i++) {
+
+        if (attached[i] != NULL) {
+            clear(attached[i]);
+        }
+    }
+}
+
+tcp_metrics *tcp_metrics_find(const struct tcp_pcb *pcb) {
+
+    uint8_t i;
+
+    for (i = 0U; i < TCP_METRICS_CONNECTIONS; i++) {
+
+        if (attached[i] != NULL && attached[i]->pcb == pcb) {
+            return attached[i];
+        }
+    }
+
+    return NULL;
+}
+
+void tcp_metrics_sndbuf_wait(const struct tcp_pcb *pcb, uint8_t waiting) {
+
+    tcp_metrics *metrics = tcp_metrics_find(pcb);
+
+    if (metrics == NULL || metrics->waiting == waiting) {
+        return;
+    }
+
+    metrics->waiting = waiting;
+
+    if (waiting == 1U) {
+        metrics->wait_start = portGET_RUN_TIME_COUNTER_VALUE();
+        metrics->wait_start_ms = sys_now();
+    } else {
+        record(&metrics->sndbuf_wait, elapsed_us(metrics->wait_start, metrics->wait_start_ms));
+    }
+}
+
+err_t tcp_metrics_segment_in(const struct tcp_pcb *pcb, const struct tcp_hdr *hdr) {
+
+    tcp_metrics *metrics = tcp_metrics_find(pcb);
+    u8_t flags = TCPH_FLAGS(hdr);
+
+    // tcp_input() already turned the header into host order
+    if (metrics == NULL || (flags & (TCP_RST | TCP_SYN)) != 0U) {
+        return ERR_OK;
+    }
+
+    if ((flags & TCP_ACK) != 0U && metrics->rtt_timing == 1U && TCP_SEQ_GEQ(hdr->ackno, metrics->rtt_end)) {
+        metrics->rtt_timing = 0U;
+        record(&metrics->rtt, (portGET_RUN_TIME_COUNTER_VALUE() - metrics->rtt_start) / TIMER_TICKS_PER_US);
+    }
+
+    if (hdr->wnd == 0U && metrics->zero_window == 0U) {
+        metrics->zero_window = 1U;
+        metrics->zero_windows++;
+        metrics->zero_window_start = sys_now();
+    } else if (hdr->wnd != 0U && metrics->zero_window == 1U) {
+        metrics->zero_window = 0U;
+        metrics->zero_window_ms += sys_now() - metrics->zero_window_start;
+    }
+
+    return ERR_OK;
+}
+
+u32_t *tcp_metrics_segment_out(const struct tcp_pcb *pcb, const struct tcp_hdr *hdr, const struct pbuf *p,
+        u32_t *opts) {
+
+    tcp_metrics *metrics = tcp_metrics_find(pcb);
+
+    if (metrics == NULL) {
+        return opts;
+    }
+
+    // p starts at the TCP header, SYN and FIN take a sequence number each
+    u8_t flags = TCPH_FLAGS(hdr);
+    u32_t seqno = lwip_ntohl(hdr->seqno);
+    u32_t length = (u32_t) (p->tot_len - TCPH_HDRLEN_BYTES(hdr)) +
+                   (((flags & TCP_SYN) != 0U) ? 1U : 0U) + (((flags & TCP_FIN) != 0U) ? 1U : 0U);
+
+    // pure ACKs, keepalives and window probes tell nothing
+    if (length == 0U || pcb->persist_backoff > 0U) {
+        return opts;
+    }
+
+    if (TCP_SEQ_LT(seqno, pcb->snd_nxt)) {
+
+        metrics->retransmits++;
+
+        if ((pcb->flags & TF_INFR) != 0U && (pcb->flags & TF_RTO) == 0U) {
+            metrics->fast_retransmits++;
+        }
+
+        // Karn: an ACK after a retransmission may belong to either copy
+        metrics->rtt_timing = 0U;
+    } else if (metrics->rtt_timing == 0U) {
+        metrics->rtt_timing = 1U;
+        metrics->rtt_end = seqno + length;
+        metrics->rtt_start = portGET_RUN_TIME_COUNTER_VALUE();
+    }
+
+    return opts;
+}
+
+#else
+
+void tcp_metrics_attach(tcp_metrics *metrics, const struct tcp_pcb *pcb) {
+    metrics->pcb = NULL;
+}
+
+void tcp_metrics_detach(tcp_metrics *metrics) {
+    metrics->pcb = NULL;
+}
+
+void tcp_metrics_reset(void) {
+}
+
+tcp_metrics *tcp_metrics_find(const struct tcp_pcb *pcb) {
+    return NULL;
+}
+
+void tcp_metrics_sndbuf_wait(const struct tcp_pcb *pcb, uint8_t waiting) {
+}
+
+#endif
+
+uint32_t tcp_metrics_bucket_floor_us(uint8_t bucket) {
+    return (bucket == 0U) ? 0U : (TCP_METRICS_FIRST_BUCKET_US / 2U) << bucket;
+}
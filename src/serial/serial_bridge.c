@@ -0,0 +1,819 @@
+/*
+ *  Telnet to UART1 serial bridge with RFC 2217 COM port control.
+ *
+ *  The tcpip thread parses the telnet stream and writes the data straight
+ *  into the transmit stream buffer of the UART1 driver, but only as much
+ *  as fits. The rest of the received data is held and the TCP window
+ *  stays closed, so the peer is throttled instead of bytes being dropped;
+ *  a timer retries while data is held.
+ *
+ *  The pump task blocks on the receive stream buffer and copies into the
+ *  from_uart ring, a single producer, single consumer ring the tcpip
+ *  thread drains into the output ring, escaping IAC. While the ring is
+ *  full the pump waits for a notification the tcpip thread gives once it
+ *  freed space, the driver keeps buffering the line meanwhile.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lwip/tcpip.h"
+#include "lwip/timeouts.h"
+#include "serial/serial_bridge.h"
+#include "telnet/telnet_output.h"
+#include "telnet/telnet_protocol.h"
+#include "uart/uart1_driver.h"
+
+/** tcp_poll() interval in TCP coarse timer ticks (500 ms) */
+#define POLL_INTERVAL       4U
+
+#define RING_MASK           (SERIAL_BRIDGE_RING_SIZE - 1U)
+
+/** Retry interval while received data waits for transmit buffer space */
+#define RESUME_INTERVAL_MS  5U
+
+/** Bytes moved per call between the driver and the rings */
+#define CHUNK_SIZE          64U
+
+/**
+ *  @defgroup Bridge_Options Telnet options used by the bridge
+ *  @{
+ */
+
+#define OPTION_BINARY       0U      /**< RFC 856 */
+#define OPTION_SGA          3U      /**< Suppress go ahead, RFC 858 */
+#define OPTION_COM_PORT     44U     /**< RFC 2217 */
+
+#define FLAG_BINARY         0x01U
+#define FLAG_SGA            0x02U
+#define FLAG_COM_PORT       0x04U
+
+/** @} */
+
+/**
+ *  @defgroup Com_Port_Commands COM-PORT-OPTION commands (RFC 2217)
+ *  @brief Client to server values, the server answers with value + 100.
+ *  @{
+ */
+
+#define CPC_SIGNATURE               0U
+#define CPC_SET_BAUDRATE            1U
+#define CPC_SET_DATASIZE            2U
+#define CPC_SET_PARITY              3U
+#define CPC_SET_STOPSIZE            4U
+#define CPC_SET_CONTROL             5U
+#define CPC_FLOWCONTROL_SUSPEND     8U
+#define CPC_FLOWCONTROL_RESUME      9U
+#define CPC_SET_LINESTATE_MASK      10U
+#define CPC_SET_MODEMSTATE_MASK     11U
+#define CPC_PURGE_DATA              12U
+
+#define CPC_SERVER_OFFSET           100U
+
+#define PARITY_NONE                 1U
+#define PARITY_ODD                  2U
+#define PARITY_EVEN                 3U
+
+#define STOPSIZE_1                  1U
+#define STOPSIZE_2                  2U
+
+#define PURGE_RECEIVE               1U      /**< Data received from the serial port */
+#define PURGE_TRANSMIT              2U      /**< Data waiting to be sent to the serial port */
+#define PURGE_BOTH                  3U
+
+/** @} */
+
+/** Subnegotiation bytes kept, enough for every command except long signatures */
+#define SUBNEGOTIATION_MAX  8U
+
+typedef enum {
+    STATE_DATA = 0,
+    STATE_IAC,
+    STATE_OPTION,
+    STATE_SUBNEGOTIATION,
+    STATE_SUBNEGOTIATION_IAC
+} bridge_state;
+
+/**
+ *  @struct byte_ring
+ *  @brief Single producer, single consumer ring. Free running indices,
+ *  each written by one side only, so no locking is needed.
+ */
+typedef struct {
+    volatile uint16_t head;     /**< Written by the producer */
+    volatile uint16_t tail;     /**< Written by the consumer */
+    uint8_t buffer[SERIAL_BRIDGE_RING_SIZE];
+} byte_ring;
+
+static const char signature[] = "PIC32 serial bridge";
+
+static byte_ring from_uart;
+
+static struct tcp_pcb *listen_pcb = NULL;
+static struct tcp_pcb *client_pcb = NULL;
+static telnet_output output;
+static struct pbuf *received = NULL;   /**< Data not parsed yet because the transmit buffer was full */
+static uint8_t stage[CHUNK_SIZE];       /**< Parsed data on its way to the driver */
+static uint8_t stage_length = 0U;
+
+static volatile uint8_t connected = 0U;
+static volatile uint8_t drain_posted = 0U;
+static uint8_t resume_armed = 0U;
+static uint8_t closing = 0U;
+static uint8_t suspended = 0U;          /**< FLOWCONTROL-SUSPEND from the client */
+
+static bridge_state state = STATE_DATA;
+static uint8_t verb = 0U;
+static uint8_t local_options = 0U;
+static uint8_t remote_options = 0U;
+static uint8_t last_byte_cr = 0U;
+static uint8_t subnegotiation[SUBNEGOTIATION_MAX];
+static uint8_t subnegotiation_length = 0U;
+
+static UART_SERIAL_SETUP line_setup;
+
+static StaticTask_t pump_tcb;
+static StackType_t pump_stack[SERIAL_BRIDGE_PUMP_STACK_SIZE];
+static TaskHandle_t pump = NULL;
+static volatile uint8_t pump_waiting = 0U;  /**< The pump waits for space in from_uart */
+
+static err_t client_sent(void *arg, struct tcp_pcb *pcb, u16_t len);
+static err_t client_poll(void *arg, struct tcp_pcb *pcb);
+static void client_err(void *arg, err_t err);
+
+
+static uint16_t ring_count(const byte_ring *ring) {
+    return (uint16_t) (ring->head - ring->tail);
+}
+
+static uint16_t ring_free(const byte_ring *ring) {
+    return SERIAL_BRIDGE_RING_SIZE - ring_count(ring);
+}
+
+static void ring_put(byte_ring *ring, uint8_t byte) {
+
+    ring->buffer[ring->head & RING_MASK] = byte;
+    ring->head++;
+}
+
+static uint8_t ring_get(byte_ring *ring) {
+
+    uint8_t byte = ring->buffer[ring->tail & RING_MASK];
+
+    ring->tail++;
+
+    return byte;
+}
+
+// tcpip thread: from_uart has space again, wakes the pump if it waits for it
+static void from_uart_released(void) {
+
+    if (pump_waiting == 1U) {
+        pump_waiting = 0U;
+        xTaskNotifyGive(pump);
+    }
+}
+
+static void apply_line_setup(UART_SERIAL_SETUP *setup) {
+
+    if (uart1_driver_setup(setup) == 1U) {
+        line_setup = *setup;
+    }
+}
+
+static void send_option(uint8_t command, uint8_t option) {
+
+    uint8_t reply[3] = { TELNET_IAC, command, option };
+
+    telnet_output_write(&output, reply, sizeof(reply));
+}
+
+static void send_com_port(uint8_t command, const uint8_t *value, uint8_t length) {
+
+    uint8_t reply[4 + 2 * sizeof(signature) + 2];
+    uint8_t count = 0U;
+    uint8_t i;
+
+    reply[count++] = TELNET_IAC;
+    reply[count++] = TELNET_SB;
+    reply[count++] = OPTION_COM_PORT;
+    reply[count++] = command + CPC_SERVER_OFFSET;
+
+    for (i = 0; i < length; i++) {
+
+        // a baud rate may contain 0xFF, double it like in the data stream
+        if (value[i] == TELNET_IAC) {
+            reply[count++] = TELNET_IAC;
+        }
+
+        reply[count++] = value[i];
+    }
+
+    reply[count++] = TELNET_IAC;
+    reply[count++] = TELNET_SE;
+
+    telnet_output_write(&output, reply, count);
+}
+
+static uint8_t option_flag(uint8_t option) {
+
+    switch (option) {
+        case OPTION_BINARY:     return FLAG_BINARY;
+        case OPTION_SGA:        return FLAG_SGA;
+        case OPTION_COM_PORT:   return FLAG_COM_PORT;
+        default:                return 0U;
+    }
+}
+
+static void negotiate(uint8_t command, uint8_t option) {
+
+    uint8_t flag = option_flag(option);
+
+    switch (command) {
+
+        case TELNET_DO:
+            // the server side offers binary mode and SGA only
+            if ((flag & (FLAG_BINARY | FLAG_SGA)) == 0U) {
+                send_option(TELNET_WONT, option);
+            } else if ((local_options & flag) == 0U) {
+                local_options |= flag;
+                send_option(TELNET_WILL, option);
+            }
+            break;
+
+        case TELNET_DONT:
+            if ((local_options & flag) != 0U) {
+                local_options &= ~flag;
+                send_option(TELNET_WONT, option);
+            }
+            break;
+
+        case TELNET_WILL:
+            if ((flag & (FLAG_BINARY | FLAG_COM_PORT)) == 0U) {
+                send_option(TELNET_DONT, option);
+            } else if ((remote_options & flag) == 0U) {
+                remote_options |= flag;
+                send_option(TELNET_DO, option);
+            }
+            break;
+
+        case TELNET_WONT:
+            if ((remote_options & flag) != 0U) {
+                remote_options &= ~flag;
+                send_option(TELNET_DONT, option);
+            }
+            break;
+    }
+}
+
+static uint8_t control_reply(uint8_t value) {
+
+    // no break, modem or flow control lines are wired, report the idle state
+    if (value <= 3U) {
+        return 1U;          // no flow control
+    } else if (value <= 6U) {
+        return 6U;          // break off
+    } else if (value <= 9U) {
+        return 8U;          // DTR on
+    } else if (value <= 12U) {
+        return 11U;         // RTS on
+    } else if (value <= 16U) {
+        return 14U;         // no inbound flow control
+    }
+
+    return value;
+}
+
+static void com_port_command(const uint8_t *data, uint8_t length) {
+
+    UART_SERIAL_SETUP setup = line_setup;
+    uint8_t value = (length > 1U) ? data[1] : 0U;
+    uint8_t reply[4];
+
+    switch (data[0]) {
+
+        case CPC_SIGNATURE:
+            send_com_port(CPC_SIGNATURE, (const uint8_t *) signature, sizeof(signature) - 1U);
+            break;
+
+        case CPC_SET_BAUDRATE:
+            if (length >= 5U) {
+
+                uint32_t baud = ((uint32_t) data[1] << 24) | ((uint32_t) data[2] << 16) |
+                                ((uint32_t) data[3] << 8) | data[4];
+
+                // zero asks for the current value
+                if (baud != 0U) {
+                    setup.baudRate = baud;
+                    apply_line_setup(&setup);
+                }
+            }
+
+            reply[0] = (uint8_t) (line_setup.baudRate >> 24);
+            reply[1] = (uint8_t) (line_setup.baudRate >> 16);
+            reply[2] = (uint8_t) (line_setup.baudRate >> 8);
+            reply[3] = (uint8_t) line_setup.baudRate;
+            send_com_port(CPC_SET_BAUDRATE, reply, 4U);
+            break;
+
+        case CPC_SET_DATASIZE:
+            // the UART has 8 and 9 bit frames, only 8 bit maps to a byte stream
+            reply[0] = 8U;
+            send_com_port(CPC_SET_DATASIZE, reply, 1U);
+            break;
+
+        case CPC_SET_PARITY:
+            if (value == PARITY_NONE || value == PARITY_ODD || value == PARITY_EVEN) {
+                setup.parity = (value == PARITY_NONE) ? UART_PARITY_NONE :
+                               (value == PARITY_ODD) ? UART_PARITY_ODD : UART_PARITY_EVEN;
+                apply_line_setup(&setup);
+            }
+
+            reply[0] = (line_setup.parity == UART_PARITY_ODD) ? PARITY_ODD :
+                       (line_setup.parity == UART_PARITY_EVEN) ? PARITY_EVEN : PARITY_NONE;
+            send_com_port(CPC_SET_PARITY, reply, 1U);
+            break;
+
+        case CPC_SET_STOPSIZE:
+            if (value == STOPSIZE_1 || value == STOPSIZE_2) {
+                setup.stopBits = (value == STOPSIZE_1) ? UART_STOP_1_BIT : UART_STOP_2_BIT;
+                apply_line_setup(&setup);
+            }
+
+            reply[0] = (line_setup.stopBits == UART_STOP_2_BIT) ? STOPSIZE_2 : STOPSIZE_1;
+            send_com_port(CPC_SET_STOPSIZE, reply, 1U);
+            break;
+
+        case CPC_SET_CONTROL:
+            reply[0] = control_reply(value);
+            send_com_port(CPC_SET_CONTROL, reply, 1U);
+            break;
+
+        case CPC_FLOWCONTROL_SUSPEND:
+            suspended = 1U;
+            break;
+
+        case CPC_FLOWCONTROL_RESUME:
+            suspended = 0U;
+            break;
+
+        case CPC_SET_LINESTATE_MASK:
+        case CPC_SET_MODEMSTATE_MASK:
+            // state changes are never reported
+            reply[0] = 0U;
+            send_com_port(data[0], reply, 1U);
+            break;
+
+        case CPC_PURGE_DATA:
+            if (value == PURGE_RECEIVE || value == PURGE_BOTH) {
+                from_uart.tail = from_uart.head;
+                from_uart_released();
+            }
+
+            if (value == PURGE_TRANSMIT || value == PURGE_BOTH) {
+                stage_length = 0U;
+                uart1_driver_purge_tx();
+            }
+
+            reply[0] = value;
+            send_com_port(CPC_PURGE_DATA, reply, 1U);
+            break;
+    }
+}
+
+static void flush_stage(void) {
+
+    // the space was checked before parsing, this does not block
+    if (stage_length > 0U) {
+        uart1_driver_write(stage, stage_length, portMAX_DELAY);
+        stage_length = 0U;
+    }
+}
+
+static void put_data(uint8_t byte) {
+
+    // outside binary mode CR is followed by NUL or LF, the NUL is padding
+    if (last_byte_cr == 1U && byte == 0U && (remote_options & FLAG_BINARY) == 0U) {
+        last_byte_cr = 0U;
+        return;
+    }
+
+    last_byte_cr = (byte == '\r') ? 1U : 0U;
+
+    stage[stage_length++] = byte;
+
+    if (stage_length == CHUNK_SIZE) {
+        flush_stage();
+    }
+}
+
+static void process_byte(uint8_t byte) {
+
+    switch (state) {
+
+        case STATE_DATA:
+            if (byte == TELNET_IAC) {
+                state = STATE_IAC;
+            } else {
+                put_data(byte);
+            }
+            break;
+
+        case STATE_IAC:
+            if (byte == TELNET_IAC) {
+                put_data(byte);
+                state = STATE_DATA;
+            } else if (byte >= TELNET_WILL) {
+                verb = byte;
+                state = STATE_OPTION;
+            } else if (byte == TELNET_SB) {
+                subnegotiation_length = 0U;
+                state = STATE_SUBNEGOTIATION;
+            } else {
+                state = STATE_DATA;
+            }
+            break;
+
+        case STATE_OPTION:
+            negotiate(verb, byte);
+            state = STATE_DATA;
+            break;
+
+        case STATE_SUBNEGOTIATION:
+            if (byte == TELNET_IAC) {
+                state = STATE_SUBNEGOTIATION_IAC;
+            } else if (subnegotiation_length < SUBNEGOTIATION_MAX) {
+                subnegotiation[subnegotiation_length++] = byte;
+            }
+            break;
+
+        case STATE_SUBNEGOTIATION_IAC:
+            if (byte == TELNET_SE) {
+
+                if (subnegotiation_length >= 2U && subnegotiation[0] == OPTION_COM_PORT) {
+                    com_port_command(&subnegotiation[1], subnegotiation_length - 1U);
+                }
+
+                state = STATE_DATA;
+            } else {
+                if (subnegotiation_length < SUBNEGOTIATION_MAX) {
+                    subnegotiation[subnegotiation_length++] = byte;
+                }
+
+                state = STATE_SUBNEGOTIATION;
+            }
+            break;
+    }
+}
+
+static void resume_timer(void *arg);
+
+// tcpip thread: parses held data as long as the transmit buffer has room
+static void parse_received(void) {
+
+    struct pbuf *q;
+    uint16_t consumed = 0U;
+    uint16_t i;
+
+    // every received byte yields at most one byte for the UART
+    size_t budget = uart1_driver_write_space();
+
+    for (q = received; q != NULL && budget > 0U; q = q->next) {
+
+        const uint8_t *payload = (const uint8_t *) q->payload;
+
+        for (i = 0; i < q->len && budget > 0U; i++) {
+            process_byte(payload[i]);
+            consumed++;
+            budget--;
+        }
+    }
+
+    flush_stage();
+
+    if (consumed > 0U) {
+        tcp_recved(client_pcb, consumed);
+        received = pbuf_free_header(received, consumed);
+    }
+
+    if (received != NULL && resume_armed == 0U) {
+        resume_armed = 1U;
+        sys_timeout(RESUME_INTERVAL_MS, resume_timer, NULL);
+    }
+}
+
+static void resume_timer(void *arg) {
+
+    resume_armed = 0U;
+
+    if (client_pcb != NULL && received != NULL) {
+        parse_received();
+        telnet_output_flush(&output, 1U);
+    }
+}
+
+// tcpip thread: moves UART data into the output ring, doubling IAC
+static void drain_from_uart(void) {
+
+    uint8_t chunk[64];
+
+    if (client_pcb == NULL || closing == 1U || suspended == 1U) {
+        return;
+    }
+
+    while (ring_count(&from_uart) > 0U) {
+
+        uint16_t space = telnet_output_free_space(&output);
+        uint16_t count = 0U;
+
+        while (count + 2U <= sizeof(chunk) && count + 2U <= space && ring_count(&from_uart) > 0U) {
+
+            uint8_t byte = ring_get(&from_uart);
+
+            chunk[count++] = byte;
+
+            if (byte == TELNET_IAC) {
+                chunk[count++] = TELNET_IAC;
+            }
+        }
+
+        if (count == 0U) {
+            // output ring full, continued from the sent callback
+            break;
+        }
+
+        telnet_output_write(&output, chunk, count);
+    }
+
+    from_uart_released();
+    telnet_output_flush(&output, 1U);
+}
+
+static void drain_callback(void *arg) {
+
+    drain_posted = 0U;
+    drain_from_uart();
+}
+
+static void reset_client(void) {
+
+    if (received != NULL) {
+        pbuf_free(received);
+        received = NULL;
+    }
+
+    UART_SERIAL_SETUP setup;
+
+    setup.baudRate = SERIAL_BRIDGE_DEFAULT_BAUD;
+    setup.parity = UART_PARITY_NONE;
+    setup.dataWidth = UART_DATA_8_BIT;
+    setup.stopBits = UART_STOP_1_BIT;
+
+    apply_line_setup(&setup);
+
+    client_pcb = NULL;
+    connected = 0U;
+    closing = 0U;
+}
+
+static void finish_close(void) {
+
+    struct tcp_pcb *pcb = client_pcb;
+
+    // the output ring must not be referenced by lwIP any more
+    if (telnet_output_pending(&output) > 0U || telnet_output_unacknowledged(&output) > 0U) {
+        return;
+    }
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0U);
+
+    if (tcp_close(pcb) != ERR_OK) {
+        // out of memory for the FIN, retried from the poll callback
+        tcp_sent(pcb, client_sent);
+        tcp_err(pcb, client_err);
+        tcp_poll(pcb, client_poll, POLL_INTERVAL);
+        return;
+    }
+
+    reset_client();
+}
+
+static void close_client(void) {
+
+    closing = 1U;
+    connected = 0U;
+
+    telnet_output_flush(&output, 1U);
+    finish_close();
+}
+
+static err_t client_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+
+    if (p == NULL) {
+        close_client();
+        return ERR_OK;
+    }
+
+    if (err != ERR_OK || closing == 1U) {
+        tcp_recved(pcb, p->tot_len);
+        pbuf_free(p);
+        return ERR_OK;
+    }
+
+    if (received == NULL) {
+        received = p;
+    } else {
+        pbuf_cat(received, p);
+    }
+
+    parse_received();
+    telnet_output_flush(&output, 1U);
+
+    return ERR_OK;
+}
+
+static err_t client_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
+
+    telnet_output_acknowledged(&output, len);
+
+    if (closing == 1U) {
+        telnet_output_flush(&output, 1U);
+        finish_close();
+        return ERR_OK;
+    }
+
+    drain_from_uart();
+
+    return ERR_OK;
+}
+
+static err_t client_poll(void *arg, struct tcp_pcb *pcb) {
+
+    if (closing == 1U) {
+        telnet_output_flush(&output, 1U);
+        finish_close();
+        return ERR_OK;
+    }
+
+    drain_from_uart();
+
+    return ERR_OK;
+}
+
+static void client_err(void *arg, err_t err) {
+
+    // the pcb is already freed by lwIP
+    reset_client();
+}
+
+static err_t bridge_accept(void *arg, struct tcp_pcb *newpcb, err_t err) {
+
+    if (err != ERR_OK || newpcb == NULL) {
+        return ERR_VAL;
+    }
+
+    // one UART, one client
+    if (client_pcb != NULL) {
+        tcp_abort(newpcb);
+        return ERR_ABRT;
+    }
+
+    client_pcb = newpcb;
+    closing = 0U;
+    suspended = 0U;
+    state = STATE_DATA;
+    local_options = FLAG_BINARY | FLAG_SGA;
+    remote_options = FLAG_BINARY;
+    last_byte_cr = 0U;
+
+    // the previous client's data must not leak into this connection
+    from_uart.tail = from_uart.head;
+    from_uart_released();
+    stage_length = 0U;
+    uart1_driver_purge_rx();
+    uart1_driver_purge_tx();
+
+    telnet_output_init(&output, newpcb);
+
+    tcp_recv(newpcb, client_recv);
+    tcp_sent(newpcb, client_sent);
+    tcp_err(newpcb, client_err);
+    tcp_poll(newpcb, client_poll, POLL_INTERVAL);
+
+    // transparent 8 bit stream without go ahead
+    send_option(TELNET_WILL, OPTION_BINARY);
+    send_option(TELNET_DO, OPTION_BINARY);
+    send_option(TELNET_WILL, OPTION_SGA);
+    telnet_output_flush(&output, 1U);
+
+    connected = 1U;
+
+    return ERR_OK;
+}
+
+static void post(tcpip_callback_fn function, volatile uint8_t *posted) {
+
+    if (*posted == 1U) {
+        return;
+    }
+
+    *posted = 1U;
+
+    // message pool empty, the next pump round tries again
+    if (tcpip_callback(function, NULL) != ERR_OK) {
+        *posted = 0U;
+    }
+}
+
+static void pump_task(void *parameter) {
+
+    uint8_t chunk[CHUNK_SIZE];
+
+    for (;;) {
+
+        size_t length = ring_free(&from_uart);
+        size_t i;
+
+        if (length == 0U) {
+
+            // the peer reads slower than the line, the driver keeps buffering;
+            // space freed after the check above still ends the wait
+            pump_waiting = 1U;
+
+            if (ring_free(&from_uart) == 0U) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+
+            pump_waiting = 0U;
+            continue;
+        }
+
+        if (length > sizeof(chunk)) {
+            length = sizeof(chunk);
+        }
+
+        length = uart1_driver_read(chunk, length, portMAX_DELAY);
+
+        // without a client the bytes have no receiver
+        if (connected == 0U) {
+            continue;
+        }
+
+        for (i = 0; i < length; i++) {
+            ring_put(&from_uart, chunk[i]);
+        }
+
+        post(drain_callback, &drain_posted);
+    }
+}
+
+err_t serial_bridge_init(void) {
+
+    err_t err;
+
+    line_setup.baudRate = SERIAL_BRIDGE_DEFAULT_BAUD;
+    line_setup.parity = UART_PARITY_NONE;
+    line_setup.dataWidth = UART_DATA_8_BIT;
+    line_setup.stopBits = UART_STOP_1_BIT;
+
+    pump = xTaskCreateStatic(pump_task, "bridge", SERIAL_BRIDGE_PUMP_STACK_SIZE, NULL, SERIAL_BRIDGE_PUMP_PRIORITY,
+            pump_stack, &pump_tcb);
+
+    if (pump == NULL) {
+        return ERR_MEM;
+    }
+
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+
+    if (pcb == NULL) {
+        return ERR_MEM;
+    }
+
+    err = tcp_bind(pcb, IP_ANY_TYPE, SERIAL_BRIDGE_PORT);
+
+    if (err != ERR_OK) {
+        tcp_close(pcb);
+        return err;
+    }
+
+    listen_pcb = tcp_listen(pcb);
+
+    if (listen_pcb == NULL) {
+        tcp_close(pcb);
+        return ERR_MEM;
+    }
+
+    tcp_accept(listen_pcb, bridge_accept);
+
+    return ERR_OK;
+}
+
+uint8_t serial_bridge_connected(void) {
+    return connected;
+}
@@ -0,0 +1,168 @@
+/*
+ *  Command line shell on top of the telnet server.
+ *
+ *  Commands are registered in shell_commands.def. The descriptor table is
+ *  built from that file at compile time and kept in flash, the lookup uses
+ *  a perfect hash generated by tools/shell_hash_gen.py, so dispatch costs
+ *  one hash and one strcmp however many commands exist.
+ *
+ *  Fast commands run inline in the tcpip thread, slow ones are handed to
+ *  the worker pool in shell_worker.c.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "shell/shell.h"
+#include "shell/shell_hash.h"
+#include "shell/shell_worker.h"
+
+static const shell_command commands[] = {
+#define SHELL_COMMAND(name, handler, mode, output, min_args, max_args, usage, help) \
+    { #name, handler, mode, output, min_args, max_args, usage, help },
+#include "shell/shell_commands.def"
+#undef SHELL_COMMAND
+};
+
+#define COMMAND_COUNT   (sizeof(commands) / sizeof(commands[0]))
+
+// position of every command in shell_commands.def
+enum {
+#define SHELL_COMMAND(name, handler, mode, output, min_args, max_args, usage, help) \
+    COMMAND_INDEX_##name,
+#include "shell/shell_commands.def"
+#undef SHELL_COMMAND
+};
+
+// fail to compile when shell_hash.h was not regenerated after editing shell_commands.def:
+// a new or renamed command has no SHELL_HASH_INDEX_ entry, a moved one another position
+// and a removed one leaves the count behind
+typedef char shell_hash_matches_commands[(SHELL_HASH_COMMANDS == COMMAND_COUNT) ? 1 : -1];
+
+#define SHELL_COMMAND(name, handler, mode, output, min_args, max_args, usage, help) \
+    typedef char shell_hash_matches_##name[(SHELL_HASH_INDEX_##name == COMMAND_INDEX_##name) ? 1 : -1];
+#include "shell/shell_commands.def"
+#undef SHELL_COMMAND
+
+static const uint8_t hash_slots[SHELL_HASH_SLOTS] = SHELL_HASH_TABLE;
+
+
+static uint32_t hash_name(const char *name) {
+
+    uint32_t hash = SHELL_HASH_SEED;
+
+    while (*name != '\0') {
+        hash = (hash ^ (uint8_t) *name) * 16777619U;
+        name++;
+    }
+
+    return hash;
+}
+
+static int tokenize(char *line, char *argv[]) {
+
+    int argc = 0;
+
+    while (*line != '\0' && argc < (int) SHELL_ARGS_MAX) {
+
+        while (*line == ' ' || *line == '\t') {
+            *line++ = '\0';
+        }
+
+        if (*line == '\0') {
+            break;
+        }
+
+        argv[argc++] = line;
+
+        while (*line != '\0' && *line != ' ' && *line != '\t') {
+            line++;
+        }
+    }
+
+    return argc;
+}
+
+const shell_command *shell_find(const char *name) {
+
+    uint32_t hash = hash_name(name);
+    uint8_t index = hash_slots[(hash ^ (hash >> 16)) & (SHELL_HASH_SLOTS - 1U)];
+
+    // a slot is only unique for registered names, confirm the match
+    if (index == SHELL_HASH_EMPTY || strcmp(commands[index].name, name) != 0) {
+        return NULL;
+    }
+
+    return &commands[index];
+}
+
+const shell_command *shell_command_at(uint8_t index) {
+
+    if (index >= COMMAND_COUNT) {
+        return NULL;
+    }
+
+    return &commands[index];
+}
+
+uint8_t shell_command_count(void) {
+    return (uint8_t) COMMAND_COUNT;
+}
+
+uint16_t shell_output_reserve(const char *line) {
+
+    char name[SHELL_HASH_NAME_MAX + 1U];
+    uint8_t length = 0U;
+
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+
+    while (*line != '\0' && *line != ' ' && *line != '\t') {
+
+        if (length == SHELL_HASH_NAME_MAX) {
+            // longer than any command, runs into the unknown command message
+            return SHELL_OUTPUT_LINE;
+        }
+
+        name[length++] = *line++;
+    }
+
+    name[length] = '\0';
+
+    const shell_command *command = shell_find(name);
+
+    return (command != NULL) ? command->output : SHELL_OUTPUT_LINE;
+}
+
+void shell_execute(telnet_session *session, char *line, uint16_t length) {
+
+    char *argv[SHELL_ARGS_MAX];
+    int argc = tokenize(line, argv);
+
+    if (argc == 0) {
+        return;
+    }
+
+    const shell_command *command = shell_find(argv[0]);
+
+    if (command == NULL) {
+        telnet_session_printf(session, "Unknown command: %s\r\n", argv[0]);
+        return;
+    }
+
+    if (argc - 1 < command->min_args || argc - 1 > command->max_args) {
+        telnet_session_printf(session, "Usage: %s\r\n", command->usage);
+        return;
+    }
+
+    if (command->mode == SHELL_SLOW) {
+
+        if (shell_worker_submit(session, command, argc, argv) != 0) {
+            telnet_session_write_static(session, "Busy, try again later\r\n", 23U);
+        }
+        return;
+    }
+
+    command->handler(session, argc, argv);
+}
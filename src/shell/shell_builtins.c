@@ -0,0 +1,53 @@
+/*
+ *  Built-in shell commands.
+ */
+
+#include <string.h>
+
+#include "shell/shell.h"
+
+void shell_help(telnet_session *session, int argc, char *argv[]) {
+
+    uint8_t i;
+
+    if (argc == 2) {
+
+        const shell_command *command = shell_find(argv[1]);
+
+        if (command == NULL) {
+            telnet_session_printf(session, "Unknown command: %s\r\n", argv[1]);
+            return;
+        }
+
+        telnet_session_printf(session, "Usage: %s\r\n", command->usage);
+        telnet_session_write_static(session, command->help, (uint16_t) strlen(command->help));
+        telnet_session_write_static(session, "\r\n", 2U);
+        return;
+    }
+
+    for (i = 0; i < shell_command_count(); i++) {
+
+        const shell_command *command = shell_command_at(i);
+
+        telnet_session_printf(session, "%-10s", command->name);
+        telnet_session_write_static(session, command->help, (uint16_t) strlen(command->help));
+        telnet_session_write_static(session, "\r\n", 2U);
+    }
+}
+
+void shell_echo(telnet_session *session, int argc, char *argv[]) {
+
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        telnet_session_printf(session, (i == argc - 1) ? "%s" : "%s ", argv[i]);
+    }
+
+    telnet_session_write_static(session, "\r\n", 2U);
+}
+
+void shell_exit(telnet_session *session, int argc, char *argv[]) {
+
+    telnet_session_write_static(session, "Bye\r\n", 5U);
+    telnet_session_close(session);
+}
@@ -0,0 +1,114 @@
+/*
+ *  Character generator command.
+ *
+ *  Streams the RFC 864 pattern, 72 printable characters per line shifted
+ *  by one each line, through the session pump: output is produced only as
+ *  fast as the peer acknowledges it, so it measures the transmit path and
+ *  not a buffer. Without a byte count it runs until ^C.
+ */
+
+#include <stdlib.h>
+
+#include "shell/shell.h"
+#include "shell/shell_chargen.h"
+
+#define LINE_CHARS      72U
+
+#define LINE_BYTES      (LINE_CHARS + 2U)
+
+// printable ASCII from space to tilde
+#define FIRST_CHAR      ' '
+#define CHAR_COUNT      95U
+
+static chargen_stream streams[TELNET_MAX_SESSIONS];
+
+static uint8_t pump_chargen(telnet_session *session, void *context);
+
+
+static chargen_stream *find_stream(void) {
+
+    uint8_t i;
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        telnet_session *owner = streams[i].session;
+
+        if (owner == NULL ||
+            owner->in_use == 0U ||
+            owner->pump != pump_chargen ||
+            owner->pump_context != &streams[i]) {
+            return &streams[i];
+        }
+    }
+
+    return NULL;
+}
+
+static uint8_t pump_chargen(telnet_session *session, void *context) {
+
+    chargen_stream *stream = (chargen_stream *) context;
+    char text[LINE_BYTES];
+    uint8_t i;
+
+    while (telnet_output_free_space(&session->output) >= LINE_BYTES) {
+
+        uint16_t length = LINE_BYTES;
+
+        if (stream->unlimited == 0U) {
+
+            if (stream->remaining == 0U) {
+                return 0U;
+            }
+
+            if (stream->remaining < length) {
+                length = (uint16_t) stream->remaining;
+            }
+
+            stream->remaining -= length;
+        }
+
+        for (i = 0; i < LINE_CHARS; i++) {
+            text[i] = (char) (FIRST_CHAR + (stream->line + i) % CHAR_COUNT);
+        }
+
+        text[LINE_CHARS] = '\r';
+        text[LINE_CHARS + 1U] = '\n';
+
+        stream->line = (uint8_t) ((stream->line + 1U) % CHAR_COUNT);
+
+        telnet_session_write(session, text, length);
+    }
+
+    return 1U;
+}
+
+void shell_chargen(telnet_session *session, int argc, char *argv[]) {
+
+    uint32_t bytes = 0U;
+
+    if (argc == 2) {
+
+        char *end;
+
+        bytes = strtoul(argv[1], &end, 0);
+
+        if (*end != '\0' || bytes == 0U) {
+            telnet_session_write_static(session, "Usage: chargen [bytes]\r\n", 24U);
+            return;
+        }
+    }
+
+    chargen_stream *stream = find_stream();
+
+    if (stream == NULL) {
+        telnet_session_write_static(session, "Busy, try again later\r\n", 23U);
+        return;
+    }
+
+    stream->session = session;
+    stream->remaining = bytes;
+    stream->unlimited = (argc == 2) ? 0U : 1U;
+    stream->line = 0U;
+
+    telnet_session_follow(session, pump_chargen, stream);
+}
@@ -0,0 +1,115 @@
+/*
+ *  Shell commands for the ENC624J600.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "enc624j600/enc624j600_driver.h"
+#include "enc624j600/enc624j600_trace.h"
+#include "serial/serial_bridge.h"
+#include "shell/shell.h"
+#include "shell/shell_enc624j600.h"
+#include "uart/uart1_driver.h"
+
+typedef struct {
+    uint8_t address;
+    const char *name;
+} phy_register;
+
+static const phy_register phy_registers[] = {
+    { 0x00U, "PHCON1" },
+    { 0x01U, "PHSTAT1" },
+    { 0x04U, "PHANA" },
+    { 0x05U, "PHANLPA" },
+    { 0x06U, "PHANE" },
+    { 0x11U, "PHCON2" },
+    { 0x1BU, "PHSTAT2" },
+    { 0x1FU, "PHSTAT3" },
+};
+
+// serializes the MII sequences of phy commands, SHELL_WORKER_COUNT runs them in parallel
+static SemaphoreHandle_t mii_lock = NULL;
+static StaticSemaphore_t mii_lock_control;
+
+int shell_enc624j600_init(void) {
+
+    mii_lock = xSemaphoreCreateMutexStatic(&mii_lock_control);
+
+    return (mii_lock != NULL) ? 0 : -1;
+}
+
+// SHELL_SLOW, every read waits for MISTAT.BUSY
+void shell_phy(telnet_session *session, int argc, char *argv[]) {
+
+    uint16_t values[sizeof(phy_registers) / sizeof(phy_registers[0])];
+    uint8_t i;
+
+    // the HAL locks every SPI transaction against the receive path, a MII
+    // read spans several of them and must not interleave with another one;
+    // the lock is not held while the output waits for the session
+    xSemaphoreTake(mii_lock, portMAX_DELAY);
+
+    for (i = 0; i < sizeof(phy_registers) / sizeof(phy_registers[0]); i++) {
+        values[i] = enc624j600_read_phy_register(phy_registers[i].address);
+    }
+
+    xSemaphoreGive(mii_lock);
+
+    for (i = 0; i < sizeof(phy_registers) / sizeof(phy_registers[0]); i++) {
+        telnet_session_printf(session, "%-8s 0x%02X  0x%04X\r\n",
+                              phy_registers[i].name, phy_registers[i].address, values[i]);
+    }
+}
+
+static void trace_dump(telnet_session *session, uint8_t uart) {
+
+    enc624j600_trace_reader reader;
+    char line[ENC624J600_TRACE_LINE_MAX];
+    uint16_t length;
+
+    // the dump itself moves frames through the chip, recording stays off until spitrace on
+    enc624j600_trace_enable(0U);
+    enc624j600_trace_reader_init(&reader);
+
+    while ((length = enc624j600_trace_read(&reader, line)) > 0U) {
+
+        if (uart == 1U) {
+            uart1_driver_write(line, length, portMAX_DELAY);
+        } else {
+            telnet_session_write(session, line, length);
+        }
+    }
+}
+
+// SHELL_SLOW, a dump blocks until the session or UART1 took every line
+void shell_spitrace(telnet_session *session, int argc, char *argv[]) {
+
+    if (ENC624J600_TRACE == 0) {
+        telnet_session_write_static(session, "SPI trace not compiled in, build with ENC624J600_TRACE=1\r\n", 58U);
+        return;
+    }
+
+    if (argc == 1) {
+        trace_dump(session, 0U);
+    } else if (strcmp(argv[1], "on") == 0) {
+        enc624j600_trace_enable(1U);
+    } else if (strcmp(argv[1], "off") == 0) {
+        enc624j600_trace_enable(0U);
+    } else if (strcmp(argv[1], "clear") == 0) {
+        enc624j600_trace_clear();
+    } else if (strcmp(argv[1], "uart") == 0) {
+
+        if (serial_bridge_connected() == 1U) {
+            telnet_session_write_static(session, "UART1 is bridged, dump to the session instead\r\n", 47U);
+            return;
+        }
+
+        trace_dump(session, 1U);
+    } else {
+        telnet_session_write_static(session, "Usage: spitrace [on|off|clear|uart]\r\n", 37U);
+    }
+}
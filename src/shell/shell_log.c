@@ -0,0 +1,93 @@
+/*
+ *  Shell commands for the deferred log.
+ *
+ *  Sessions read the shared log ring through their own log_reader and the
+ *  telnet server pulls the lines as output space frees up, see
+ *  telnet_session_follow(). Nothing is copied per session, a slow session
+ *  only loses its place and is told how many lines it missed.
+ */
+
+#include <string.h>
+
+#include "log/log.h"
+#include "shell/shell.h"
+
+typedef struct {
+    telnet_session *session;
+    log_reader reader;
+    uint8_t follow;             /**< 1 for log -f, 0 to stop once caught up */
+} log_follower;
+
+static log_follower followers[TELNET_MAX_SESSIONS];
+
+static uint8_t pump_log(telnet_session *session, void *context);
+
+
+static log_follower *find_follower(telnet_session *session) {
+
+    uint8_t i;
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        telnet_session *owner = followers[i].session;
+
+        // a follower is free once its session stopped pumping from it
+        if (owner == NULL ||
+            owner->in_use == 0U ||
+            owner->pump != pump_log ||
+            owner->pump_context != &followers[i]) {
+            return &followers[i];
+        }
+    }
+
+    return NULL;
+}
+
+static uint8_t pump_log(telnet_session *session, void *context) {
+
+    log_follower *follower = (log_follower *) context;
+    char line[LOG_LINE_MAX];
+
+    while (telnet_output_free_space(&session->output) >= LOG_LINE_MAX) {
+
+        uint16_t length = log_read(&follower->reader, line);
+
+        if (length == 0U) {
+            return follower->follow;
+        }
+
+        telnet_session_write(session, line, length);
+    }
+
+    return 1U;
+}
+
+void shell_log(telnet_session *session, int argc, char *argv[]) {
+
+    uint8_t follow = 0U;
+
+    if (argc == 2) {
+
+        if (strcmp(argv[1], "-f") != 0) {
+            telnet_session_write_static(session, "Usage: log [-f]\r\n", 17U);
+            return;
+        }
+
+        follow = 1U;
+    }
+
+    log_follower *follower = find_follower(session);
+
+    if (follower == NULL) {
+        telnet_session_write_static(session, "Busy, try again later\r\n", 23U);
+        return;
+    }
+
+    follower->session = session;
+    follower->follow = follow;
+
+    // a plain log shows the whole ring, -f only what comes next
+    log_reader_init(&follower->reader, (follow == 1U) ? 0U : 1U);
+
+    telnet_session_follow(session, pump_log, follower);
+}
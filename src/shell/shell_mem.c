@@ -0,0 +1,92 @@
+/*
+ *  Memory budget and lwIP pool commands.
+ *
+ *  mem prints the static plan, pools what lwIP really uses of it: the
+ *  elements in use, the high-water mark and the allocations that failed
+ *  for the heap (in bytes) and every memp pool. The counters exist only
+ *  with LWIP_POOL_STATS 1 in lwipopts.h. tools/lwip_pool_size.py turns
+ *  captures of pools into a proposal for lwipopts.h.
+ */
+
+#include <string.h>
+
+#include "shell/shell.h"
+#include "memory/memory_budget.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/sys.h"
+#include "lwip/priv/memp_priv.h"
+
+#if LWIP_POOL_STATS
+static const char *const pool_names[] = {
+#define LWIP_MEMPOOL(name, num, size, desc)     #name,
+#include "lwip/priv/memp_std.h"
+};
+#endif
+
+void shell_mem(telnet_session *session, int argc, char *argv[]) {
+
+    uint8_t i;
+    uint32_t total = memory_budget_total();
+
+    for (i = 0; i < memory_budget_pool_count(); i++) {
+        telnet_session_printf(session, "%-22s %6lu\r\n", memory_budget_pools[i].name,
+                (unsigned long) memory_budget_pools[i].bytes);
+    }
+
+    telnet_session_printf(session, "%-22s %6lu of %lu, %lu reserved\r\n", "total", (unsigned long) total,
+            (unsigned long) MEMORY_BUDGET_RAM_SIZE, (unsigned long) MEMORY_BUDGET_RESERVE);
+}
+
+#if LWIP_POOL_STATS
+
+static void print_pool(telnet_session *session, const char *name, uint32_t size, const struct stats_mem *stats) {
+
+    telnet_session_printf(session, "%-16s %5lu %5lu %5lu %5lu %5lu\r\n", name, (unsigned long) size,
+            (unsigned long) stats->avail, (unsigned long) stats->used, (unsigned long) stats->max,
+            (unsigned long) stats->err);
+}
+
+// SHELL_FAST: allocations outside the tcpip thread only bump the counters in between
+void shell_pools(telnet_session *session, int argc, char *argv[]) {
+
+    uint8_t i;
+
+    if (argc == 2) {
+
+        SYS_ARCH_DECL_PROTECT(level);
+
+        if (strcmp(argv[1], "reset") != 0) {
+            telnet_session_write_static(session, "Usage: pools [reset]\r\n", 22U);
+            return;
+        }
+
+        // like a fresh boot with what is allocated right now
+        SYS_ARCH_PROTECT(level);
+
+        lwip_stats.mem.max = lwip_stats.mem.used;
+        lwip_stats.mem.err = 0U;
+
+        for (i = 0U; i < MEMP_MAX; i++) {
+            lwip_stats.memp[i]->max = lwip_stats.memp[i]->used;
+            lwip_stats.memp[i]->err = 0U;
+        }
+
+        SYS_ARCH_UNPROTECT(level);
+    }
+
+    telnet_session_printf(session, "%-16s %5s %5s %5s %5s %5s\r\n", "pool", "size", "avail", "used", "max", "err");
+    print_pool(session, "HEAP", 1U, &lwip_stats.mem);
+
+    for (i = 0U; i < MEMP_MAX; i++) {
+        print_pool(session, pool_names[i], memp_pools[i]->size, lwip_stats.memp[i]);
+    }
+}
+
+#else
+
+void shell_pools(telnet_session *session, int argc, char *argv[]) {
+    telnet_session_write_static(session, "No pool statistics, build with LWIP_POOL_STATS 1\r\n", 50U);
+}
+
+#endif
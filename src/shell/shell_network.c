@@ -0,0 +1,192 @@
+/*
+ *  Shell commands for the network services.
+ *
+ *  netstat lists lwIP's TCP pcbs. With -v it adds the figures tcp_metrics
+ *  keeps for the telnet sessions: RTT and send buffer waits as log2
+ *  histograms, each bucket labelled by its lower bound, retransmissions
+ *  and the time the peer kept its window closed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lwip/ip_addr.h"
+#include "lwip/priv/tcp_priv.h"
+#include "network/iperf_server.h"
+#include "network/tcp_metrics.h"
+#include "shell/shell.h"
+
+// "255.255.255.255:65535"
+#define ENDPOINT_LENGTH     22U
+
+// indexed by enum lwiperf_report_type
+static const char *const iperf_results[] = {
+    "done",
+    "done",
+    "aborted locally",
+    "data error",
+    "send error",
+    "aborted by the client",
+};
+
+static void print_iperf_report(telnet_session *session, const char *label, const iperf_server_report *report) {
+
+    telnet_session_printf(session, "%-8s %s:%u  %lu bytes  %lu ms  %lu kbit/s\r\n", label,
+            ipaddr_ntoa(&report->remote_address), (unsigned) report->remote_port, (unsigned long) report->bytes,
+            (unsigned long) report->ms, (unsigned long) report->kbit_per_second);
+}
+
+// SHELL_FAST, the server lives in the tcpip thread
+void shell_iperf(telnet_session *session, int argc, char *argv[]) {
+
+    iperf_server_report report;
+    uint32_t tests;
+
+    if (argc == 2) {
+
+        if (strcmp(argv[1], "start") == 0) {
+
+            err_t err = iperf_server_start();
+
+            if (err != ERR_OK) {
+                telnet_session_printf(session, "Cannot listen on port %u, error %d\r\n", (unsigned) IPERF_SERVER_PORT,
+                        (int) err);
+                return;
+            }
+        } else if (strcmp(argv[1], "stop") == 0) {
+            iperf_server_stop();
+        } else {
+            telnet_session_write_static(session, "Usage: iperf [start|stop]\r\n", 27U);
+            return;
+        }
+    }
+
+    if (iperf_server_listening() == 1U) {
+        telnet_session_printf(session, "Listening on port %u, run iperf -c on the peer\r\n",
+                (unsigned) IPERF_SERVER_PORT);
+    } else {
+        telnet_session_write_static(session, "Stopped\r\n", 9U);
+    }
+
+    if (iperf_server_progress(&report) == 1U) {
+        print_iperf_report(session, "running", &report);
+    }
+
+    tests = iperf_server_last_report(&report);
+
+    if (tests > 0U) {
+        print_iperf_report(session, "last", &report);
+        telnet_session_printf(session, "%-8s %s, %lu tests since boot\r\n", "",
+                iperf_results[report.type], (unsigned long) tests);
+    }
+}
+
+static void format_endpoint(char *buffer, const ip_addr_t *address, u16_t port) {
+
+    char ip[IPADDR_STRLEN_MAX];
+
+    snprintf(buffer, ENDPOINT_LENGTH, "%s:%u", ipaddr_ntoa_r(address, ip, sizeof(ip)), (unsigned) port);
+}
+
+static void print_histogram(telnet_session *session, const char *label, const tcp_metrics_histogram *histogram) {
+
+    uint8_t i;
+    uint32_t mean;
+
+    if (histogram->count == 0U) {
+        telnet_session_printf(session, "    %-11s none\r\n", label);
+        return;
+    }
+
+    mean = (uint32_t) (histogram->sum_us / histogram->count);
+
+    telnet_session_printf(session, "    %-11s %lu, min %lu.%lu max %lu.%lu mean %lu.%lu ms\r\n    %-11s", label,
+            (unsigned long) histogram->count,
+            (unsigned long) (histogram->min_us / 1000U), (unsigned long) (histogram->min_us % 1000U / 100U),
+            (unsigned long) (histogram->max_us / 1000U), (unsigned long) (histogram->max_us % 1000U / 100U),
+            (unsigned long) (mean / 1000U), (unsigned long) (mean % 1000U / 100U), "");
+
+    for (i = 0U; i < TCP_METRICS_BUCKETS; i++) {
+
+        uint32_t floor_us = tcp_metrics_bucket_floor_us(i);
+
+        if (histogram->buckets[i] == 0U) {
+            continue;
+        }
+
+        if (floor_us < 1000U) {
+            telnet_session_printf(session, " %luus:%u", (unsigned long) floor_us, (unsigned) histogram->buckets[i]);
+        } else if (floor_us < 1000000U) {
+            telnet_session_printf(session, " %lums:%u", (unsigned long) (floor_us / 1000U),
+                    (unsigned) histogram->buckets[i]);
+        } else {
+            telnet_session_printf(session, " %lus:%u", (unsigned long) (floor_us / 1000000U),
+                    (unsigned) histogram->buckets[i]);
+        }
+    }
+
+    telnet_session_write_static(session, "\r\n", 2U);
+}
+
+static void print_metrics(telnet_session *session, const tcp_metrics *metrics) {
+
+    print_histogram(session, "rtt", &metrics->rtt);
+    print_histogram(session, "sndbuf wait", &metrics->sndbuf_wait);
+
+    telnet_session_printf(session, "    %-11s %lu, %lu fast; zero windows %lu, %lu ms%s\r\n", "retransmits",
+            (unsigned long) metrics->retransmits, (unsigned long) metrics->fast_retransmits,
+            (unsigned long) metrics->zero_windows, (unsigned long) metrics->zero_window_ms,
+            (metrics->zero_window == 1U) ? " and closed now" : "");
+}
+
+static void print_pcbs(telnet_session *session, const struct tcp_pcb *pcb, uint8_t verbose) {
+
+    char local[ENDPOINT_LENGTH];
+    char remote[ENDPOINT_LENGTH];
+
+    for (; pcb != NULL; pcb = pcb->next) {
+
+        const tcp_metrics *metrics = tcp_metrics_find(pcb);
+
+        format_endpoint(local, &pcb->local_ip, pcb->local_port);
+        format_endpoint(remote, &pcb->remote_ip, pcb->remote_port);
+
+        telnet_session_printf(session, "%-21s %-21s %-11s %5u %5lu\r\n", local, remote,
+                tcp_debug_state_str(pcb->state), (unsigned) (TCP_SND_BUF - tcp_sndbuf(pcb)),
+                (unsigned long) ((uint32_t) pcb->rto * TCP_SLOW_INTERVAL));
+
+        if (verbose == 1U && metrics != NULL) {
+            print_metrics(session, metrics);
+        }
+    }
+}
+
+// SHELL_FAST, walks lwIP's pcb lists and the figures its hooks update
+void shell_netstat(telnet_session *session, int argc, char *argv[]) {
+
+    const struct tcp_pcb_listen *listener;
+    char local[ENDPOINT_LENGTH];
+    uint8_t verbose = 0U;
+
+    if (argc == 2) {
+
+        if (strcmp(argv[1], "-v") == 0) {
+            verbose = 1U;
+        } else if (strcmp(argv[1], "reset") == 0) {
+            tcp_metrics_reset();
+        } else {
+            telnet_session_write_static(session, "Usage: netstat [-v|reset]\r\n", 27U);
+            return;
+        }
+    }
+
+    telnet_session_printf(session, "%-21s %-21s %-11s %5s %5s\r\n", "local", "remote", "state", "sendq", "rto");
+
+    for (listener = tcp_listen_pcbs.listen_pcbs; listener != NULL; listener = listener->next) {
+        format_endpoint(local, &listener->local_ip, listener->local_port);
+        telnet_session_printf(session, "%-21s %-21s %s\r\n", local, "*", tcp_debug_state_str(listener->state));
+    }
+
+    print_pcbs(session, tcp_active_pcbs, verbose);
+    print_pcbs(session, tcp_tw_pcbs, verbose);
+}
@@ -0,0 +1,241 @@
+/*
+ *  top: live view of the FreeRTOS tasks.
+ *
+ *  The kernel accumulates per task run time on the CP0 core timer (see
+ *  FreeRTOSConfig.h). The counters of the previous sample are kept, the
+ *  CPU share is the difference over the refresh interval, so the 32 bit
+ *  counters may wrap between samples. The frame is produced by the telnet
+ *  server's follow pump and sent as a diff against the previous one,
+ *  usually just the changed percentages.
+ *
+ *  All sessions following top see the same frame. The first pump that
+ *  finds the interval elapsed samples once and updates every view, each
+ *  view only keeps its cursor. A view without room for an update falls
+ *  out of step and is repainted from the shared frame once its peer
+ *  acknowledged enough.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "housekeeping/housekeeping.h"
+#include "shell/shell.h"
+#include "shell/shell_top.h"
+#include "telnet/telnet_screen.h"
+
+static top_view views[TELNET_MAX_SESSIONS];
+
+// only used in the tcpip thread
+static top_monitor monitor;
+
+static uint8_t pump_top(telnet_session *session, void *context);
+
+
+static uint8_t view_active(const top_view *view) {
+
+    const telnet_session *owner = view->session;
+
+    return (owner != NULL &&
+            owner->in_use == 1U &&
+            owner->pump == pump_top &&
+            owner->pump_context == view) ? 1U : 0U;
+}
+
+static top_view *find_view(void) {
+
+    uint8_t i;
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        if (view_active(&views[i]) == 0U) {
+            return &views[i];
+        }
+    }
+
+    return NULL;
+}
+
+static char state_letter(eTaskState state) {
+
+    switch (state) {
+        case eRunning:
+        case eReady:
+            return 'R';
+        case eBlocked:
+            return 'B';
+        case eSuspended:
+            return 'S';
+        default:
+            return 'D';
+    }
+}
+
+// previous run time counter of a task, 0 for tasks created since the last frame
+static configRUN_TIME_COUNTER_TYPE previous_counter(UBaseType_t number) {
+
+    uint8_t i;
+
+    for (i = 0; i < monitor.count; i++) {
+
+        if (monitor.previous[i].number == number) {
+            return monitor.previous[i].counter;
+        }
+    }
+
+    return 0U;
+}
+
+// orders by creation, otherwise the rows jump between frames
+static void sort_tasks(UBaseType_t count) {
+
+    UBaseType_t i;
+    UBaseType_t j;
+
+    for (i = 1; i < count; i++) {
+
+        TaskStatus_t task = monitor.tasks[i];
+
+        for (j = i; j > 0 && monitor.tasks[j - 1U].xTaskNumber > task.xTaskNumber; j--) {
+            monitor.tasks[j] = monitor.tasks[j - 1U];
+        }
+
+        monitor.tasks[j] = task;
+    }
+}
+
+static void compose(void) {
+
+    telnet_screen_frame *frame = &monitor.frame;
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t count = uxTaskGetSystemState(monitor.tasks, TOP_TASKS_MAX, &total);
+    UBaseType_t i;
+
+    telnet_screen_frame_clear(frame);
+
+    if (count == 0U) {
+        telnet_screen_frame_printf(frame, 0U, "More than %u tasks", TOP_TASKS_MAX);
+        return;
+    }
+
+    sort_tasks(count);
+
+    configRUN_TIME_COUNTER_TYPE elapsed = total - monitor.total;
+
+    uint16_t load = housekeeping_cpu_load();
+
+    telnet_screen_frame_printf(frame, 0U, "%u tasks, load %u.%u%%, up %lu s",
+            (unsigned) count, load / 10U, load % 10U,
+            (unsigned long) (xTaskGetTickCount() / configTICK_RATE_HZ));
+    telnet_screen_frame_printf(frame, 1U, "^C to quit");
+    telnet_screen_frame_printf(frame, 2U, "NAME            S PRIO  CPU%%  STACK");
+
+    for (i = 0; i < count; i++) {
+
+        const TaskStatus_t *task = &monitor.tasks[i];
+        unsigned stack = (unsigned) (task->usStackHighWaterMark * sizeof(StackType_t));
+        uint8_t row = (uint8_t) (3U + i);
+
+        if (monitor.count == 0U || elapsed == 0U) {
+            // no interval to compare with yet
+            telnet_screen_frame_printf(frame, row, "%-15.15s %c %4u     - %6u",
+                    task->pcTaskName, state_letter(task->eCurrentState),
+                    (unsigned) task->uxCurrentPriority, stack);
+            continue;
+        }
+
+        configRUN_TIME_COUNTER_TYPE used = task->ulRunTimeCounter - previous_counter(task->xTaskNumber);
+        uint32_t permille = (uint32_t) (((uint64_t) used * 1000U) / elapsed);
+
+        telnet_screen_frame_printf(frame, row, "%-15.15s %c %4u %3u.%u %6u",
+                task->pcTaskName, state_letter(task->eCurrentState),
+                (unsigned) task->uxCurrentPriority,
+                (unsigned) (permille / 10U), (unsigned) (permille % 10U), stack);
+    }
+
+    for (i = 0; i < count; i++) {
+        monitor.previous[i].number = monitor.tasks[i].xTaskNumber;
+        monitor.previous[i].counter = monitor.tasks[i].ulRunTimeCounter;
+    }
+
+    monitor.count = (uint8_t) count;
+    monitor.total = total;
+}
+
+static uint8_t has_room(const telnet_session *session) {
+    return (telnet_output_free_space(&session->output) >= TELNET_SCREEN_RENDER_MAX) ? 1U : 0U;
+}
+
+// brings every view from monitor.shown to the new frame
+static void refresh(void) {
+
+    uint8_t i;
+
+    compose();
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        top_view *view = &views[i];
+
+        if (view_active(view) == 0U) {
+            continue;
+        }
+
+        // an update is written in one piece, this view catches up with a repaint
+        if (has_room(view->session) == 0U) {
+            telnet_screen_init(&view->screen);
+            continue;
+        }
+
+        telnet_screen_update(&view->screen, &monitor.shown, &monitor.frame, view->session);
+    }
+
+    monitor.shown = monitor.frame;
+    monitor.composed = 1U;
+    monitor.refreshed = xTaskGetTickCount();
+}
+
+static uint8_t pump_top(telnet_session *session, void *context) {
+
+    top_view *view = (top_view *) context;
+
+    if ((xTaskGetTickCount() - monitor.refreshed) >= pdMS_TO_TICKS(TOP_INTERVAL_MS)) {
+        refresh();
+    }
+
+    // joined late or missed an update, wait for the peer to acknowledge the last one
+    if (view->screen.valid == 0U && monitor.composed == 1U && has_room(session) == 1U) {
+        telnet_screen_update(&view->screen, NULL, &monitor.shown, session);
+    }
+
+    return 1U;
+}
+
+void shell_top(telnet_session *session, int argc, char *argv[]) {
+
+    top_view *view = find_view();
+    uint8_t i;
+
+    // cannot fail, there is a view per session and this one is not following top yet
+    if (view == NULL) {
+        return;
+    }
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        if (view_active(&views[i]) == 1U) {
+            break;
+        }
+    }
+
+    if (i == TELNET_MAX_SESSIONS) {
+        // nobody is watching, the first frame is due right away
+        monitor.count = 0U;
+        monitor.total = 0U;
+        monitor.composed = 0U;
+        monitor.refreshed = xTaskGetTickCount() - pdMS_TO_TICKS(TOP_INTERVAL_MS);
+    }
+
+    view->session = session;
+    telnet_screen_init(&view->screen);
+
+    telnet_session_follow(session, pump_top, view);
+}
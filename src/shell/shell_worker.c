@@ -0,0 +1,189 @@
+/*
+ *  Worker pool for slow shell commands.
+ *
+ *  Commands registered as SHELL_SLOW would block the tcpip thread and with
+ *  it every session, e.g. PHY reads waiting for MISTAT.BUSY. They run in a
+ *  small pool of worker tasks instead. The tcpip thread takes a job slot,
+ *  copies the line and detaches the session, a worker runs the handler and
+ *  posts the output back through tcpip_callback() in chunks. Only the tcpip
+ *  thread touches the output ring, the worker blocks until a chunk fitted.
+ *  There is one worker per session and a session has at most one job, so
+ *  a client that stops reading only holds up its own command.
+ *
+ *  Job slots are allocated and released in the tcpip thread only, so the
+ *  slot flags need no locking.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "lwip/tcpip.h"
+#include "shell/shell_enc624j600.h"
+#include "shell/shell_worker.h"
+
+static shell_job jobs[SHELL_WORKER_QUEUE_DEPTH];
+static QueueHandle_t job_queue = NULL;
+static StaticQueue_t job_queue_control;
+static uint8_t job_queue_storage[SHELL_WORKER_QUEUE_DEPTH * sizeof(shell_job *)];
+
+static StaticTask_t worker_tcbs[SHELL_WORKER_COUNT];
+static StackType_t worker_stacks[SHELL_WORKER_COUNT][SHELL_WORKER_STACK_SIZE];
+
+
+// tcpip thread: moves as much of the chunk as fits into the output ring
+static void deliver_output(void *arg) {
+
+    shell_job *job = (shell_job *) arg;
+    uint16_t written = telnet_session_deliver(job->session, job->output, job->output_length);
+
+    job->output_length -= written;
+    memmove(job->output, &job->output[written], job->output_length);
+
+    xTaskNotifyGive(job->worker);
+}
+
+// tcpip thread: the handler returned and its output is delivered
+static void finish_job(void *arg) {
+
+    shell_job *job = (shell_job *) arg;
+
+    telnet_session_attach(job->session);
+
+    job->in_use = 0U;
+}
+
+static void post(tcpip_callback_fn function, shell_job *job) {
+
+    // the message pool is shared with the stack, wait if it is empty
+    while (tcpip_callback(function, job) != ERR_OK) {
+        vTaskDelay(pdMS_TO_TICKS(TELNET_FLUSH_INTERVAL_MS));
+    }
+}
+
+static void send_output(shell_job *job) {
+
+    while (job->output_length > 0U) {
+
+        post(deliver_output, job);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (job->output_length > 0U) {
+            // output ring full, give the peer time to acknowledge
+            vTaskDelay(pdMS_TO_TICKS(TELNET_FLUSH_INTERVAL_MS));
+        }
+    }
+}
+
+// worker: called through the telnet_session_* functions while detached
+static uint16_t collect_output(void *context, const void *data, uint16_t length) {
+
+    shell_job *job = (shell_job *) context;
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint16_t remaining = length;
+
+    while (remaining > 0U) {
+
+        uint16_t chunk = SHELL_WORKER_OUTPUT_SIZE - job->output_length;
+
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+
+        memcpy(&job->output[job->output_length], bytes, chunk);
+        job->output_length += chunk;
+        bytes += chunk;
+        remaining -= chunk;
+
+        if (job->output_length == SHELL_WORKER_OUTPUT_SIZE) {
+            send_output(job);
+        }
+    }
+
+    return length;
+}
+
+static void worker_task(void *parameter) {
+
+    shell_job *job;
+
+    for (;;) {
+
+        xQueueReceive(job_queue, &job, portMAX_DELAY);
+
+        job->worker = xTaskGetCurrentTaskHandle();
+        job->output_length = 0U;
+
+        job->command->handler(job->session, job->argc, job->argv);
+
+        send_output(job);
+        post(finish_job, job);
+    }
+}
+
+int shell_worker_init(void) {
+
+    uint8_t i;
+
+    if (shell_enc624j600_init() != 0) {
+        return -1;
+    }
+
+    job_queue = xQueueCreateStatic(SHELL_WORKER_QUEUE_DEPTH, sizeof(shell_job *), job_queue_storage, &job_queue_control);
+
+    if (job_queue == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < SHELL_WORKER_COUNT; i++) {
+
+        if (xTaskCreateStatic(worker_task, "worker", SHELL_WORKER_STACK_SIZE, NULL, SHELL_WORKER_PRIORITY,
+                worker_stacks[i], &worker_tcbs[i]) == NULL) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int shell_worker_submit(telnet_session *session, const shell_command *command, int argc, char *argv[]) {
+
+    shell_job *job = NULL;
+    uint8_t i;
+    int j;
+
+    for (i = 0; i < SHELL_WORKER_QUEUE_DEPTH; i++) {
+
+        if (jobs[i].in_use == 0U) {
+            job = &jobs[i];
+            break;
+        }
+    }
+
+    if (job == NULL) {
+        return -1;
+    }
+
+    job->in_use = 1U;
+    job->session = session;
+    job->command = command;
+    job->argc = argc;
+
+    // the tokenizer left the words NUL separated in one line, copy that span
+    char *end = argv[argc - 1] + strlen(argv[argc - 1]) + 1;
+
+    memcpy(job->line, argv[0], (size_t) (end - argv[0]));
+
+    for (j = 0; j < argc; j++) {
+        job->argv[j] = &job->line[argv[j] - argv[0]];
+    }
+
+    telnet_session_detach(session, collect_output, job);
+
+    // cannot fail, there are as many queue entries as job slots
+    xQueueSend(job_queue, &job, 0U);
+
+    return 0;
+}
@@ -0,0 +1,444 @@
+/*
+ *  Telnet protocol parser, LINEMODE negotiation (RFC 1184) and line editor.
+ *
+ *  In character mode every keystroke costs an inbound segment, an echo
+ *  segment and an ACK, each of them an SPI frame to the ENC624J600. With
+ *  LINEMODE EDIT the client edits locally and sends whole lines, so the
+ *  packet rate drops roughly by the line length. Clients that refuse
+ *  LINEMODE get a server side editor with remote echo instead.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "telnet/telnet_input.h"
+#include "telnet/telnet_protocol.h"
+
+/**
+ *  @defgroup Telnet_Options Telnet options
+ *  @{
+ */
+
+#define OPTION_ECHO         1U      /**< RFC 857 */
+#define OPTION_SGA          3U      /**< Suppress go ahead, RFC 858 */
+#define OPTION_LINEMODE     34U     /**< RFC 1184 */
+
+/** @} */
+
+/**
+ *  @defgroup Linemode Linemode suboptions, mode bits and SLC (RFC 1184)
+ *  @{
+ */
+
+#define LM_MODE             1U      /**< MODE suboption */
+#define LM_FORWARDMASK      2U      /**< FORWARDMASK suboption */
+#define LM_SLC              3U      /**< Set Local Characters suboption */
+
+#define MODE_EDIT           0x01U   /**< Client edits lines locally */
+#define MODE_TRAPSIG        0x02U   /**< Client translates signals to telnet commands */
+#define MODE_ACK            0x04U   /**< Mode acknowledge */
+
+#define SLC_IP              3U      /**< Interrupt process */
+#define SLC_EC              10U     /**< Erase character */
+#define SLC_EL              11U     /**< Erase line */
+#define SLC_EW              12U     /**< Erase word */
+
+#define SLC_NOSUPPORT       0x00U   /**< Function not supported */
+#define SLC_CANTCHANGE      0x01U   /**< Value can not be changed */
+#define SLC_VALUE           0x02U   /**< Value may be changed */
+#define SLC_DEFAULT         0x03U   /**< Use the default value */
+#define SLC_LEVELBITS       0x03U   /**< Support level mask */
+#define SLC_FLUSHOUT        0x20U   /**< Flush output when received */
+#define SLC_FLUSHIN         0x40U   /**< Flush input when received */
+#define SLC_ACK             0x80U   /**< Acknowledge of a value */
+
+/** @} */
+
+#define CTRL_C              0x03U
+#define CTRL_U              0x15U
+#define CTRL_W              0x17U
+#define DEL                 0x7FU
+#define BS                  0x08U
+
+static const uint8_t erase_sequence[] = { BS, ' ', BS };
+static const uint8_t new_line[] = { '\r', '\n' };
+
+// server defaults, sent in the SLC subnegotiation
+static const uint8_t default_slc[][3] = {
+    { SLC_IP, SLC_VALUE | SLC_FLUSHIN | SLC_FLUSHOUT, CTRL_C },
+    { SLC_EC, SLC_VALUE, DEL },
+    { SLC_EL, SLC_VALUE, CTRL_U },
+    { SLC_EW, SLC_VALUE, CTRL_W }
+};
+
+
+static void send_option(telnet_output *output, uint8_t verb, uint8_t option) {
+
+    uint8_t command[3] = { TELNET_IAC, verb, option };
+
+    telnet_output_write(output, command, sizeof(command));
+}
+
+static void send_mode(telnet_output *output, uint8_t mode) {
+
+    uint8_t command[] = { TELNET_IAC, TELNET_SB, OPTION_LINEMODE, LM_MODE, mode, TELNET_IAC, TELNET_SE };
+
+    telnet_output_write(output, command, sizeof(command));
+}
+
+static void send_slc_table(telnet_output *output) {
+
+    static const uint8_t header[] = { TELNET_IAC, TELNET_SB, OPTION_LINEMODE, LM_SLC };
+    static const uint8_t trailer[] = { TELNET_IAC, TELNET_SE };
+
+    telnet_output_write(output, header, sizeof(header));
+    telnet_output_write(output, default_slc, sizeof(default_slc));
+    telnet_output_write(output, trailer, sizeof(trailer));
+}
+
+static void enter_server_edit(telnet_input *input, telnet_output *output) {
+
+    input->edit_mode = TELNET_EDIT_SERVER;
+    input->echo = 1U;
+
+    // character at a time: the server echoes, no go-ahead
+    send_option(output, TELNET_WILL, OPTION_ECHO);
+    send_option(output, TELNET_WILL, OPTION_SGA);
+}
+
+static void echo(telnet_input *input, telnet_output *output, const void *data, uint16_t length) {
+
+    if (input->echo == 1U) {
+        telnet_output_write(output, data, length);
+    }
+}
+
+static void erase_characters(telnet_input *input, telnet_output *output, uint16_t count) {
+
+    while (count > 0U && input->line_length > 0U) {
+
+        input->line_length--;
+        echo(input, output, erase_sequence, sizeof(erase_sequence));
+        count--;
+    }
+}
+
+static void erase_word(telnet_input *input, telnet_output *output) {
+
+    uint16_t count = 0U;
+    uint16_t i = input->line_length;
+
+    // trailing blanks, then the word itself
+    while (i > 0U && input->line[i - 1U] == ' ') {
+        i--;
+        count++;
+    }
+
+    while (i > 0U && input->line[i - 1U] != ' ') {
+        i--;
+        count++;
+    }
+
+    erase_characters(input, output, count);
+}
+
+static void process_slc(telnet_input *input, telnet_output *output) {
+
+    static const uint8_t header[] = { TELNET_IAC, TELNET_SB, OPTION_LINEMODE, LM_SLC };
+    static const uint8_t trailer[] = { TELNET_IAC, TELNET_SE };
+
+    uint8_t replied = 0U;
+    uint8_t i;
+
+    // triplets of function, flags, value after the LM_SLC byte
+    for (i = 1U; i + 2U < input->subnegotiation_length; i += 3U) {
+
+        uint8_t function = input->subnegotiation[i];
+        uint8_t flags = input->subnegotiation[i + 1U];
+        uint8_t value = input->subnegotiation[i + 2U];
+
+        if (function == 0U || function > TELNET_SLC_COUNT) {
+            continue;
+        }
+
+        if ((flags & SLC_ACK) != 0U) {
+            // acknowledge of our own value, nothing to answer
+            input->slc[function] = value;
+            continue;
+        }
+
+        if ((flags & SLC_LEVELBITS) == SLC_NOSUPPORT ||
+            (flags & SLC_LEVELBITS) == SLC_DEFAULT) {
+            continue;
+        }
+
+        // accept the client's character and acknowledge it
+        input->slc[function] = value;
+
+        if (replied == 0U) {
+            telnet_output_write(output, header, sizeof(header));
+            replied = 1U;
+        }
+
+        uint8_t triplet[3] = { function, (uint8_t) (flags | SLC_ACK), value };
+
+        telnet_output_write(output, triplet, sizeof(triplet));
+
+        if (value == TELNET_IAC) {
+            // data byte 0xFF is doubled inside a subnegotiation
+            telnet_output_write(output, &triplet[2], 1U);
+        }
+    }
+
+    if (replied == 1U) {
+        telnet_output_write(output, trailer, sizeof(trailer));
+    }
+}
+
+static void process_subnegotiation(telnet_input *input, telnet_output *output) {
+
+    if (input->subnegotiation_length < 2U || input->subnegotiation[0] != OPTION_LINEMODE) {
+        return;
+    }
+
+    // drop the option byte, the suboption is first now
+    memmove(input->subnegotiation, &input->subnegotiation[1], --input->subnegotiation_length);
+
+    switch (input->subnegotiation[0]) {
+
+        case LM_MODE:
+            if (input->subnegotiation_length >= 2U && (input->subnegotiation[1] & MODE_ACK) != 0U) {
+                input->mode = input->subnegotiation[1] & (uint8_t) ~MODE_ACK;
+            }
+            break;
+
+        case LM_SLC:
+            process_slc(input, output);
+            break;
+
+        case TELNET_DO:
+            // no forward mask, the client forwards on end of line only
+            if (input->subnegotiation_length >= 2U && input->subnegotiation[1] == LM_FORWARDMASK) {
+
+                uint8_t reply[] = { TELNET_IAC, TELNET_SB, OPTION_LINEMODE, TELNET_WONT, LM_FORWARDMASK, TELNET_IAC, TELNET_SE };
+
+                telnet_output_write(output, reply, sizeof(reply));
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void process_option(telnet_input *input, telnet_output *output, uint8_t option) {
+
+    switch (input->verb) {
+
+        case TELNET_WILL:
+            if (option == OPTION_LINEMODE) {
+
+                if (input->edit_mode != TELNET_EDIT_CLIENT) {
+                    input->edit_mode = TELNET_EDIT_CLIENT;
+                    input->echo = 0U;
+
+                    send_mode(output, MODE_EDIT | MODE_TRAPSIG);
+                    send_slc_table(output);
+                }
+            } else {
+                send_option(output, TELNET_DONT, option);
+            }
+            break;
+
+        case TELNET_WONT:
+            if (option == OPTION_LINEMODE && input->edit_mode != TELNET_EDIT_SERVER) {
+                enter_server_edit(input, output);
+            }
+            break;
+
+        case TELNET_DO:
+            if (option == OPTION_ECHO) {
+
+                if (input->edit_mode == TELNET_EDIT_CLIENT) {
+                    send_option(output, TELNET_WONT, OPTION_ECHO);
+                } else if (input->echo == 0U) {
+                    input->echo = 1U;
+                    send_option(output, TELNET_WILL, OPTION_ECHO);
+                }
+            } else if (option == OPTION_SGA) {
+
+                if (input->edit_mode != TELNET_EDIT_SERVER) {
+                    send_option(output, TELNET_WILL, OPTION_SGA);
+                }
+            } else {
+                send_option(output, TELNET_WONT, option);
+            }
+            break;
+
+        case TELNET_DONT:
+            if (option == OPTION_ECHO && input->echo == 1U) {
+                // client echoes locally, keep editing without echo
+                input->echo = 0U;
+                send_option(output, TELNET_WONT, OPTION_ECHO);
+            }
+            break;
+    }
+}
+
+static telnet_input_result cancel_line(telnet_input *input, telnet_output *output) {
+
+    static const char interrupt[] = "^C\r\n";
+
+    input->line_length = 0U;
+
+    echo(input, output, interrupt, sizeof(interrupt) - 1U);
+
+    return TELNET_INPUT_CANCEL;
+}
+
+static telnet_input_result process_data(telnet_input *input, telnet_output *output, uint8_t byte) {
+
+    uint8_t last_byte_cr = input->last_byte_cr;
+
+    input->last_byte_cr = (byte == '\r') ? 1U : 0U;
+
+    if (byte == '\r' || byte == '\n') {
+
+        // CR LF, CR NUL and a bare LF all end the line once
+        if (byte == '\n' && last_byte_cr == 1U) {
+            return TELNET_INPUT_NONE;
+        }
+
+        echo(input, output, new_line, sizeof(new_line));
+
+        input->line[input->line_length] = '\0';
+
+        return TELNET_INPUT_LINE;
+    }
+
+    if (byte == '\0') {
+        return TELNET_INPUT_NONE;
+    }
+
+    // in LINEMODE EDIT the client has already applied its special characters
+    if (input->edit_mode == TELNET_EDIT_SERVER) {
+
+        if (byte == input->slc[SLC_IP]) {
+            return cancel_line(input, output);
+        }
+
+        if (byte == input->slc[SLC_EC] || byte == BS || byte == DEL) {
+            erase_characters(input, output, 1U);
+            return TELNET_INPUT_NONE;
+        }
+
+        if (byte == input->slc[SLC_EL]) {
+            erase_characters(input, output, input->line_length);
+            return TELNET_INPUT_NONE;
+        }
+
+        if (byte == input->slc[SLC_EW]) {
+            erase_word(input, output);
+            return TELNET_INPUT_NONE;
+        }
+    }
+
+    if (byte < ' ' || input->line_length >= TELNET_LINE_MAX) {
+        return TELNET_INPUT_NONE;
+    }
+
+    input->line[input->line_length++] = (char) byte;
+
+    echo(input, output, &byte, 1U);
+
+    return TELNET_INPUT_NONE;
+}
+
+void telnet_input_init(telnet_input *input, telnet_output *output) {
+
+    uint8_t i;
+
+    input->state = TELNET_INPUT_DATA;
+    input->edit_mode = TELNET_EDIT_NEGOTIATING;
+    input->echo = 0U;
+    input->last_byte_cr = 0U;
+    input->verb = 0U;
+    input->mode = 0U;
+    input->subnegotiation_length = 0U;
+    input->line_length = 0U;
+
+    memset(input->slc, 0, sizeof(input->slc));
+
+    for (i = 0; i < sizeof(default_slc) / sizeof(default_slc[0]); i++) {
+        input->slc[default_slc[i][0]] = default_slc[i][2];
+    }
+
+    send_option(output, TELNET_DO, OPTION_LINEMODE);
+}
+
+telnet_input_result telnet_input_process(telnet_input *input, telnet_output *output, uint8_t byte) {
+
+    switch (input->state) {
+
+        case TELNET_INPUT_DATA:
+            if (byte == TELNET_IAC) {
+                input->state = TELNET_INPUT_IAC;
+                return TELNET_INPUT_NONE;
+            }
+
+            return process_data(input, output, byte);
+
+        case TELNET_INPUT_IAC:
+            input->state = TELNET_INPUT_DATA;
+
+            if (byte == TELNET_IAC) {
+                // escaped 0xFF data byte
+                return process_data(input, output, byte);
+            }
+
+            if (byte == TELNET_IP) {
+                // ^C translated by a LINEMODE TRAPSIG client
+                return cancel_line(input, output);
+            }
+
+            if (byte == TELNET_SB) {
+                input->subnegotiation_length = 0U;
+                input->state = TELNET_INPUT_SUBNEGOTIATION;
+            } else if (byte >= TELNET_WILL && byte <= TELNET_DONT) {
+                input->verb = byte;
+                input->state = TELNET_INPUT_OPTION;
+            }
+
+            // other two byte commands (NOP, AYT, ...) are ignored
+            return TELNET_INPUT_NONE;
+
+        case TELNET_INPUT_OPTION:
+            input->state = TELNET_INPUT_DATA;
+            process_option(input, output, byte);
+            return TELNET_INPUT_NONE;
+
+        case TELNET_INPUT_SUBNEGOTIATION:
+            if (byte == TELNET_IAC) {
+                input->state = TELNET_INPUT_SUBNEGOTIATION_IAC;
+            } else if (input->subnegotiation_length < TELNET_SUBNEGOTIATION_MAX) {
+                input->subnegotiation[input->subnegotiation_length++] = byte;
+            }
+            return TELNET_INPUT_NONE;
+
+        case TELNET_INPUT_SUBNEGOTIATION_IAC:
+            if (byte == TELNET_SE) {
+                input->state = TELNET_INPUT_DATA;
+                process_subnegotiation(input, output);
+            } else {
+                // IAC IAC is a data byte 0xFF inside the subnegotiation
+                input->state = TELNET_INPUT_SUBNEGOTIATION;
+
+                if (input->subnegotiation_length < TELNET_SUBNEGOTIATION_MAX) {
+                    input->subnegotiation[input->subnegotiation_length++] = byte;
+                }
+            }
+            return TELNET_INPUT_NONE;
+    }
+
+    return TELNET_INPUT_NONE;
+}
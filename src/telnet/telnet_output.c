@@ -0,0 +1,310 @@
+/*
+ *  Per-session output coalescing ring.
+ *
+ *  lwIP is configured with MEMP_NUM_TCP_SEG 4 and TCP_SND_QUEUELEN 4, so
+ *  every tcp_write() of a few bytes wastes one of very few segments and
+ *  puts a tiny frame on the wire. Output is therefore collected here and
+ *  passed to lwIP in MSS sized chunks.
+ *
+ *  The ring memory is referenced by lwIP directly (no TCP_WRITE_FLAG_COPY),
+ *  which is why bytes are released only after the peer acknowledges them.
+ *  Constant data is referenced the same way straight from flash, so a help
+ *  screen costs neither ring space nor lwIP heap.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "network/tcp_metrics.h"
+#include "telnet/telnet_output.h"
+
+#define BUFFER_MASK     (TELNET_OUTPUT_BUFFER_SIZE - 1U)
+
+#if (TELNET_OUTPUT_BUFFER_SIZE & BUFFER_MASK) != 0
+#error "TELNET_OUTPUT_BUFFER_SIZE must be a power of two"
+#endif
+
+static telnet_output_reference *reference_at(telnet_output *output, uint8_t n) {
+    return &output->references[(output->reference_first + n) % TELNET_OUTPUT_REFERENCES];
+}
+
+static const telnet_output_reference *reference_at_const(const telnet_output *output, uint8_t n) {
+    return &output->references[(output->reference_first + n) % TELNET_OUTPUT_REFERENCES];
+}
+
+// the oldest reference that still has bytes to be passed to lwIP
+static telnet_output_reference *next_unqueued_reference(telnet_output *output) {
+
+    uint8_t i;
+
+    for (i = 0; i < output->reference_count; i++) {
+
+        telnet_output_reference *reference = reference_at(output, i);
+
+        if (reference->queued < reference->length) {
+            return reference;
+        }
+    }
+
+    return NULL;
+}
+
+void telnet_output_init(telnet_output *output, struct tcp_pcb *pcb) {
+
+    output->pcb = pcb;
+    output->acked = 0U;
+    output->queued = 0U;
+    output->head = 0U;
+    output->reference_first = 0U;
+    output->reference_count = 0U;
+    output->dropped = 0U;
+}
+
+uint16_t telnet_output_free_space(const telnet_output *output) {
+    return (uint16_t) (TELNET_OUTPUT_BUFFER_SIZE - (uint16_t) (output->head - output->acked));
+}
+
+uint16_t telnet_output_pending(const telnet_output *output) {
+
+    uint16_t pending = (uint16_t) (output->head - output->queued);
+    uint8_t i;
+
+    for (i = 0; i < output->reference_count; i++) {
+
+        const telnet_output_reference *reference = reference_at_const(output, i);
+
+        pending += reference->length - reference->queued;
+    }
+
+    return pending;
+}
+
+uint16_t telnet_output_unacknowledged(const telnet_output *output) {
+
+    uint16_t unacknowledged = (uint16_t) (output->queued - output->acked);
+    uint8_t i;
+
+    for (i = 0; i < output->reference_count; i++) {
+
+        const telnet_output_reference *reference = reference_at_const(output, i);
+
+        unacknowledged += reference->queued - reference->acked;
+    }
+
+    return unacknowledged;
+}
+
+uint16_t telnet_output_write(telnet_output *output, const void *data, uint16_t length) {
+
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint16_t free_space = telnet_output_free_space(output);
+
+    if (length > free_space) {
+        output->dropped += length - free_space;
+        length = free_space;
+    }
+
+    // copy in at most two pieces, before and after the wrap
+    uint16_t offset = output->head & BUFFER_MASK;
+    uint16_t first = TELNET_OUTPUT_BUFFER_SIZE - offset;
+
+    if (first > length) {
+        first = length;
+    }
+
+    memcpy(&output->buffer[offset], bytes, first);
+    memcpy(&output->buffer[0], bytes + first, length - first);
+
+    output->head += length;
+
+    // send whatever already fills a segment
+    telnet_output_flush(output, 0U);
+
+    return length;
+}
+
+uint16_t telnet_output_write_static(telnet_output *output, const void *data, uint16_t length) {
+
+    // short data is referenced too when the ring is full, e.g. the prompt after a long response
+    if ((length < TELNET_OUTPUT_REFERENCE_MIN && length <= telnet_output_free_space(output)) ||
+        output->reference_count == TELNET_OUTPUT_REFERENCES) {
+        return telnet_output_write(output, data, length);
+    }
+
+    telnet_output_reference *reference = reference_at(output, output->reference_count);
+
+    reference->data = (const uint8_t *) data;
+    reference->length = length;
+    reference->position = output->head;
+    reference->queued = 0U;
+    reference->acked = 0U;
+
+    output->reference_count++;
+
+    telnet_output_flush(output, 0U);
+
+    return length;
+}
+
+uint16_t telnet_output_vprintf(telnet_output *output, const char *format, va_list args) {
+
+    char text[TELNET_OUTPUT_PRINTF_MAX];
+
+    int length = vsnprintf(text, sizeof(text), format, args);
+
+    if (length <= 0) {
+        return 0U;
+    }
+
+    if (length >= (int) sizeof(text)) {
+        length = sizeof(text) - 1;
+    }
+
+    return telnet_output_write(output, text, (uint16_t) length);
+}
+
+uint16_t telnet_output_printf(telnet_output *output, const char *format, ...) {
+
+    va_list args;
+
+    va_start(args, format);
+    uint16_t written = telnet_output_vprintf(output, format, args);
+    va_end(args);
+
+    return written;
+}
+
+uint16_t telnet_output_take_dropped(telnet_output *output) {
+
+    uint16_t dropped = output->dropped;
+
+    output->dropped = 0U;
+
+    return dropped;
+}
+
+void telnet_output_flush(telnet_output *output, uint8_t push) {
+
+    struct tcp_pcb *pcb = output->pcb;
+    uint16_t pending = telnet_output_pending(output);
+    uint16_t mss = tcp_mss(pcb);
+    uint8_t written = 0U;
+    uint8_t blocked = 0U;
+
+    while (pending > 0U) {
+
+        if (push == 0U && pending < mss && pending + telnet_output_free_space(output) >= mss) {
+            // wait for a full segment, a prompt or the flush timer; a tail
+            // the ring has no room to complete goes now, it waits for an ACK
+            break;
+        }
+
+        // ring bytes up to the next reference go first, then the reference
+        telnet_output_reference *reference = next_unqueued_reference(output);
+        uint16_t limit = (reference != NULL) ? reference->position : output->head;
+        const uint8_t *data;
+        uint16_t chunk;
+
+        if (output->queued != limit) {
+
+            uint16_t offset = output->queued & BUFFER_MASK;
+
+            data = &output->buffer[offset];
+            chunk = TELNET_OUTPUT_BUFFER_SIZE - offset;
+
+            if (chunk > (uint16_t) (limit - output->queued)) {
+                chunk = limit - output->queued;
+            }
+        } else {
+            data = reference->data + reference->queued;
+            chunk = reference->length - reference->queued;
+        }
+
+        // backpressure: never ask lwIP for more than it can queue
+        uint16_t space = tcp_sndbuf(pcb);
+
+        if (space == 0U || tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN) {
+            blocked = 1U;
+            break;
+        }
+
+        if (chunk > space) {
+            chunk = space;
+        }
+
+        if (push == 0U && chunk > mss && chunk == pending) {
+            // leave the tail for the next full segment
+            chunk = (chunk / mss) * mss;
+        }
+
+        uint8_t flags = (chunk < pending) ? TCP_WRITE_FLAG_MORE : 0U;
+
+        // neither the ring nor flash data needs to be copied by lwIP
+        if (tcp_write(pcb, data, chunk, flags) != ERR_OK) {
+            // out of segments, retried from the tcp_sent callback
+            blocked = 1U;
+            break;
+        }
+
+        if (output->queued != limit) {
+            output->queued += chunk;
+        } else {
+            reference->queued += chunk;
+        }
+
+        pending -= chunk;
+        written = 1U;
+    }
+
+    if (written == 1U) {
+        tcp_output(pcb);
+    }
+
+    tcp_metrics_sndbuf_wait(pcb, blocked);
+}
+
+void telnet_output_acknowledged(telnet_output *output, uint16_t length) {
+
+    // acknowledged bytes are consumed in stream order, ring bytes before
+    // a reference position first, then the referenced data
+    while (length > 0U && output->reference_count > 0U) {
+
+        telnet_output_reference *reference = reference_at(output, 0U);
+        uint16_t take;
+
+        if (output->acked != reference->position) {
+
+            take = reference->position - output->acked;
+
+            if (take > length) {
+                take = length;
+            }
+
+            output->acked += take;
+            length -= take;
+            continue;
+        }
+
+        take = reference->length - reference->acked;
+
+        if (take > length) {
+            take = length;
+        }
+
+        reference->acked += take;
+        length -= take;
+
+        if (reference->acked == reference->length) {
+            output->reference_first = (output->reference_first + 1U) % TELNET_OUTPUT_REFERENCES;
+            output->reference_count--;
+        }
+    }
+
+    uint16_t unacknowledged = (uint16_t) (output->queued - output->acked);
+
+    if (length > unacknowledged) {
+        length = unacknowledged;
+    }
+
+    output->acked += length;
+}
@@ -0,0 +1,236 @@
+/*
+ *  Incremental screen updates for live views over telnet.
+ *
+ *  The caller keeps the frame the terminal shows, so sessions following
+ *  the same view share one copy. A new frame is compared with it cell by
+ *  cell and only the differences are sent: a cursor
+ *  position (CUP) or a CR LF to reach a changed run, the run itself and an
+ *  erase to end of line (EL) for rows that got shorter. A top refresh where
+ *  a few percentages change costs tens of bytes instead of a full repaint.
+ *
+ *  The cursor is parked below the view after every update, so a prompt or
+ *  a ^C echo lands underneath it.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "telnet/telnet_screen.h"
+
+/** Equal cells between two changed runs that are rewritten rather than skipped with a cursor move */
+#define RUN_MERGE_GAP       4U
+
+/** Output is staged in pieces of this size before it goes to the session */
+#define STAGE_SIZE          64U
+
+typedef struct {
+    telnet_session *session;
+    uint16_t length;
+    uint16_t written;
+    uint8_t failed : 1;
+    char data[STAGE_SIZE];
+} screen_output;
+
+
+static void output_flush(screen_output *output) {
+
+    if (output->length == 0U) {
+        return;
+    }
+
+    if (telnet_session_write(output->session, output->data, output->length) != output->length) {
+        output->failed = 1U;
+    }
+
+    output->written += output->length;
+    output->length = 0U;
+}
+
+static void output_put(screen_output *output, const char *data, uint16_t length) {
+
+    while (length > 0U) {
+
+        uint16_t chunk = STAGE_SIZE - output->length;
+
+        if (chunk > length) {
+            chunk = length;
+        }
+
+        memcpy(&output->data[output->length], data, chunk);
+        output->length += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (output->length == STAGE_SIZE) {
+            output_flush(output);
+        }
+    }
+}
+
+static void move_cursor(telnet_screen *screen, screen_output *output, const telnet_screen_frame *frame,
+        uint8_t row, uint8_t column) {
+
+    if (screen->cursor_known == 1U && screen->cursor_row == row) {
+
+        if (screen->cursor_column == column) {
+            return;
+        }
+
+        // a short step right is cheaper by rewriting the cells in between, they are already up to date
+        if (column > screen->cursor_column && (uint8_t) (column - screen->cursor_column) <= RUN_MERGE_GAP) {
+            output_put(output, &frame->cells[row][screen->cursor_column], column - screen->cursor_column);
+            screen->cursor_column = column;
+            return;
+        }
+    }
+
+    if (screen->cursor_known == 1U && column == 0U && row == screen->cursor_row + 1U) {
+        output_put(output, "\r\n", 2U);
+    } else {
+        char sequence[10];
+        int length = snprintf(sequence, sizeof(sequence), "\x1b[%u;%uH", row + 1U, column + 1U);
+
+        output_put(output, sequence, (uint16_t) length);
+    }
+
+    screen->cursor_row = row;
+    screen->cursor_column = column;
+    screen->cursor_known = 1U;
+}
+
+// one past the last non-blank cell
+static uint8_t row_end(const char *cells) {
+
+    uint8_t end = TELNET_SCREEN_COLUMNS;
+
+    while (end > 0U && cells[end - 1U] == ' ') {
+        end--;
+    }
+
+    return end;
+}
+
+static void update_row(telnet_screen *screen, screen_output *output, const telnet_screen_frame *frame,
+        const char *shown, uint8_t row) {
+
+    const char *cells = frame->cells[row];
+    uint8_t end = row_end(cells);
+    uint8_t column = 0U;
+
+    while (column < end) {
+
+        if (cells[column] == shown[column]) {
+            column++;
+            continue;
+        }
+
+        uint8_t start = column;
+        uint8_t last = column;
+
+        // extend the run over short stretches of equal cells
+        while (column < end && (uint8_t) (column - last) <= RUN_MERGE_GAP) {
+
+            if (cells[column] != shown[column]) {
+                last = column;
+            }
+
+            column++;
+        }
+
+        move_cursor(screen, output, frame, row, start);
+        output_put(output, &cells[start], (uint16_t) (last + 1U - start));
+
+        if (last + 1U == TELNET_SCREEN_COLUMNS) {
+            // the terminal may or may not have wrapped
+            screen->cursor_known = 0U;
+        } else {
+            screen->cursor_column = last + 1U;
+        }
+
+        column = last + 1U;
+    }
+
+    if (row_end(shown) > end) {
+        move_cursor(screen, output, frame, row, end);
+        output_put(output, "\x1b[K", 3U);
+    }
+}
+
+void telnet_screen_init(telnet_screen *screen) {
+
+    screen->valid = 0U;
+    screen->cursor_known = 0U;
+}
+
+void telnet_screen_frame_clear(telnet_screen_frame *frame) {
+    memset(frame->cells, ' ', sizeof(frame->cells));
+}
+
+void telnet_screen_frame_printf(telnet_screen_frame *frame, uint8_t row, const char *format, ...) {
+
+    char text[TELNET_SCREEN_COLUMNS + 1U];
+    va_list args;
+
+    if (row >= TELNET_SCREEN_ROWS) {
+        return;
+    }
+
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if (length < 0) {
+        return;
+    }
+
+    if (length > (int) TELNET_SCREEN_COLUMNS) {
+        length = TELNET_SCREEN_COLUMNS;
+    }
+
+    memset(frame->cells[row], ' ', TELNET_SCREEN_COLUMNS);
+    memcpy(frame->cells[row], text, (size_t) length);
+}
+
+uint16_t telnet_screen_update(telnet_screen *screen, const telnet_screen_frame *shown,
+        const telnet_screen_frame *frame, telnet_session *session) {
+
+    screen_output output;
+    char blank[TELNET_SCREEN_COLUMNS];
+    uint8_t repaint = 0U;
+    uint8_t row;
+
+    output.session = session;
+    output.length = 0U;
+    output.written = 0U;
+    output.failed = 0U;
+
+    if (screen->valid == 0U) {
+        // home and clear, then everything counts as changed
+        output_put(&output, "\x1b[H\x1b[2J", 7U);
+        memset(blank, ' ', sizeof(blank));
+        repaint = 1U;
+
+        screen->cursor_row = 0U;
+        screen->cursor_column = 0U;
+        screen->cursor_known = 1U;
+        screen->valid = 1U;
+    }
+
+    for (row = 0; row < TELNET_SCREEN_ROWS; row++) {
+        update_row(screen, &output, frame, (repaint == 1U) ? blank : shown->cells[row], row);
+    }
+
+    if (output.written + output.length > 0U) {
+        move_cursor(screen, &output, frame, TELNET_SCREEN_ROWS, 0U);
+    }
+
+    output_flush(&output);
+
+    if (output.failed == 1U) {
+        // part of the update was lost, the terminal state is unknown
+        telnet_screen_init(screen);
+    }
+
+    return output.written;
+}
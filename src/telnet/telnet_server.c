@@ -0,0 +1,701 @@
+/*
+ *  Telnet server on the lwIP raw TCP API.
+ *
+ *  All callbacks run in the tcpip thread, so session state needs no locking
+ *  as long as the line handler does not hand it to another task.
+ *
+ *  Input is pipelined: all complete lines of a segment are parsed first and
+ *  then executed back to back, their responses collect in the output ring
+ *  and leave in one flush. A line runs only once the output space it
+ *  declares through the telnet_line_reserve is free, a handler in the
+ *  tcpip thread cannot wait for more. When the line queue is full, the
+ *  rest of the input stays in the held pbuf with the receive window
+ *  closed, copied to the lwIP heap so it cannot pin the receive pool the
+ *  ACKs arrive in. Both resume from the sent callback once the peer
+ *  acknowledged output. A response longer than declared ends with a
+ *  notice instead of silently losing its tail.
+ *
+ *  A line handler may detach the session to run a slow command in another
+ *  task. The pipeline then stops at that line, which keeps the responses in
+ *  order, and continues when the session is attached again.
+ *
+ *  A following session works the other way round: the server pulls output
+ *  from a pump as ring space frees up, so any number of sessions can read
+ *  one shared source without buffering it per session. The flush timer
+ *  keeps running while a session follows to pick up new data.
+ *
+ *  Output of a pump or a detached line leaves in full segments while it
+ *  keeps coming; the tail goes with the prompt, when a flush timer run
+ *  found nothing new, or at once when the ring has no room to complete
+ *  it. Nagle is off, it would only hold that tail for the delayed ACK.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lwip/timeouts.h"
+#include "telnet/telnet_server.h"
+
+/** tcp_poll() interval in TCP coarse timer ticks (500 ms) */
+#define POLL_INTERVAL   4U
+
+static const char banner[] = "\r\nPIC32 telnet server\r\n";
+static const char prompt[] = "> ";
+static const char truncated[] = "\r\n[output truncated, the session output ring is full]\r\n";
+
+static err_t session_sent(void *arg, struct tcp_pcb *pcb, u16_t len);
+static err_t session_poll(void *arg, struct tcp_pcb *pcb);
+static void session_err(void *arg, err_t err);
+static uint8_t run_pump(telnet_session *session);
+static void process_input(telnet_session *session);
+
+static telnet_session sessions[TELNET_MAX_SESSIONS];
+static telnet_line_handler line_handler = NULL;
+static telnet_line_reserve line_reserve = NULL;
+static struct tcp_pcb *listen_pcb = NULL;
+static uint8_t flush_timer_armed = 0U;
+
+
+// a pump or a detached line will write more, its output leaves in full segments
+static uint8_t producing(const telnet_session *session) {
+    return (session->pump != NULL || session->detached == 1U) ? 1U : 0U;
+}
+
+static void flush_timer_handler(void *arg) {
+
+    int i;
+
+    flush_timer_armed = 0U;
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        if (sessions[i].in_use == 0U || sessions[i].pcb == NULL) {
+            continue;
+        }
+
+        if (sessions[i].closing == 0U && sessions[i].pump != NULL) {
+
+            if (run_pump(&sessions[i]) == 1U) {
+                // poll the source again for new data
+                flush_timer_armed = 1U;
+            } else {
+                // continue with the lines typed while following
+                process_input(&sessions[i]);
+            }
+        }
+
+        // the tail goes once a run found nothing more coming
+        uint8_t push = (producing(&sessions[i]) == 0U || sessions[i].produced == 0U) ? 1U : 0U;
+
+        sessions[i].produced = 0U;
+
+        telnet_output_flush(&sessions[i].output, push);
+
+        if (telnet_output_pending(&sessions[i].output) > 0U) {
+            // held for the next run or blocked by tcp_sndbuf(), try again later
+            flush_timer_armed = 1U;
+        }
+    }
+
+    if (flush_timer_armed == 1U) {
+        sys_timeout(TELNET_FLUSH_INTERVAL_MS, flush_timer_handler, NULL);
+    }
+}
+
+static void arm_flush_timer(void) {
+
+    if (flush_timer_armed == 0U) {
+        flush_timer_armed = 1U;
+        sys_timeout(TELNET_FLUSH_INTERVAL_MS, flush_timer_handler, NULL);
+    }
+}
+
+static void output_written(telnet_session *session) {
+
+    session->produced = 1U;
+
+    if (telnet_output_pending(&session->output) > 0U) {
+        arm_flush_timer();
+    }
+}
+
+static void write_prompt(telnet_session *session) {
+
+    // bypasses the sink, the prompt belongs to the connection
+    telnet_output_write_static(&session->output, prompt, sizeof(prompt) - 1U);
+
+    if (telnet_output_pending(&session->output) > 0U) {
+        arm_flush_timer();
+    }
+}
+
+static void stop_following(telnet_session *session) {
+
+    session->pump = NULL;
+    session->pump_context = NULL;
+
+    if (session->detached == 0U && session->closing == 0U) {
+        write_prompt(session);
+    }
+}
+
+// returns 1 while the session keeps following
+static uint8_t run_pump(telnet_session *session) {
+
+    if (session->pump == NULL) {
+        return 0U;
+    }
+
+    if (session->pump(session, session->pump_context) == 0U) {
+        stop_following(session);
+        return 0U;
+    }
+
+    return 1U;
+}
+
+static void release_session(telnet_session *session) {
+
+    if (session->received != NULL) {
+        pbuf_free(session->received);
+        session->received = NULL;
+    }
+
+    tcp_metrics_detach(&session->metrics);
+
+    session->pcb = NULL;
+    session->pump = NULL;
+    session->pump_context = NULL;
+
+    if (session->detached == 1U) {
+        // the other task still uses the session, released in telnet_session_attach()
+        return;
+    }
+
+    session->in_use = 0U;
+    session->closing = 0U;
+}
+
+static void finish_close(telnet_session *session) {
+
+    struct tcp_pcb *pcb = session->pcb;
+
+    // the output ring must not be referenced by lwIP any more
+    if (telnet_output_pending(&session->output) > 0U ||
+        telnet_output_unacknowledged(&session->output) > 0U) {
+        return;
+    }
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0U);
+
+    if (tcp_close(pcb) != ERR_OK) {
+        // out of memory for the FIN, retried from the poll callback
+        tcp_arg(pcb, session);
+        tcp_sent(pcb, session_sent);
+        tcp_err(pcb, session_err);
+        tcp_poll(pcb, session_poll, POLL_INTERVAL);
+        return;
+    }
+
+    release_session(session);
+}
+
+// parses held input into the line queue until it is full, returns 1 if anything was consumed
+static uint8_t parse_received(telnet_session *session) {
+
+    struct pbuf *q;
+    uint16_t consumed = 0U;
+    uint16_t i;
+
+    for (q = session->received; q != NULL && session->line_count < TELNET_PIPELINE_DEPTH; q = q->next) {
+
+        const uint8_t *payload = (const uint8_t *) q->payload;
+
+        for (i = 0; i < q->len && session->line_count < TELNET_PIPELINE_DEPTH; i++) {
+
+            consumed++;
+
+            switch (telnet_input_process(&session->input, &session->output, payload[i])) {
+
+                case TELNET_INPUT_LINE: {
+
+                    uint8_t slot = (session->line_first + session->line_count) % TELNET_PIPELINE_DEPTH;
+
+                    memcpy(session->lines[slot], session->input.line, session->input.line_length + 1U);
+                    session->line_count++;
+                    session->input.line_length = 0U;
+                    break;
+                }
+
+                case TELNET_INPUT_CANCEL:
+                    // an interrupt also discards the lines typed ahead
+                    session->line_count = 0U;
+
+                    if (session->pump != NULL) {
+                        stop_following(session);
+                    } else if (session->detached == 0U) {
+                        write_prompt(session);
+                    }
+                    break;
+
+                case TELNET_INPUT_NONE:
+                    break;
+            }
+        }
+    }
+
+    if (consumed == 0U) {
+        return 0U;
+    }
+
+    // the window only opens for parsed bytes, a full queue throttles the peer
+    tcp_recved(session->pcb, consumed);
+    session->received = pbuf_free_header(session->received, consumed);
+
+    return 1U;
+}
+
+// output space the line needs, never more than the ring
+static uint16_t reserve_for(const char *line) {
+
+    uint16_t reserve = (line_reserve != NULL) ? line_reserve(line) : TELNET_PIPELINE_OUTPUT_RESERVE;
+
+    return (reserve > TELNET_OUTPUT_BUFFER_SIZE) ? TELNET_OUTPUT_BUFFER_SIZE : reserve;
+}
+
+// runs queued lines in order while the output ring has room for their responses
+static uint8_t execute_lines(telnet_session *session) {
+
+    uint8_t executed = 0U;
+
+    while (session->line_count > 0U &&
+           session->closing == 0U &&
+           session->detached == 0U &&
+           session->pump == NULL) {
+
+        char *line = session->lines[session->line_first];
+
+        if (telnet_output_free_space(&session->output) < reserve_for(line)) {
+            // resumed from the sent callback once the peer acknowledged output
+            break;
+        }
+
+        session->line_first = (session->line_first + 1U) % TELNET_PIPELINE_DEPTH;
+        session->line_count--;
+
+        // writers that retry short writes, workers and pumps, leave counts behind
+        telnet_output_take_dropped(&session->output);
+
+        if (line_handler != NULL) {
+            line_handler(session, line, (uint16_t) strlen(line));
+        }
+
+        if (session->detached == 0U && telnet_output_take_dropped(&session->output) > 0U) {
+            telnet_output_write_static(&session->output, truncated, sizeof(truncated) - 1U);
+        }
+
+        if (session->closing == 0U && session->detached == 0U && session->pump == NULL) {
+            write_prompt(session);
+        }
+
+        executed = 1U;
+    }
+
+    return executed;
+}
+
+// moves held input out of the receive pool, the ACKs that free the output ring need it
+static void unpin_received(telnet_session *session) {
+
+    struct pbuf *q;
+
+    for (q = session->received; q != NULL; q = q->next) {
+
+        if (pbuf_match_allocsrc(q, PBUF_POOL)) {
+            break;
+        }
+    }
+
+    if (q == NULL) {
+        return;
+    }
+
+    struct pbuf *copy = pbuf_clone(PBUF_RAW, PBUF_RAM, session->received);
+
+    if (copy == NULL) {
+        // heap exhausted, keep the pool buffers
+        return;
+    }
+
+    pbuf_free(session->received);
+    session->received = copy;
+}
+
+static void process_input(telnet_session *session) {
+
+    uint8_t progress = 1U;
+
+    // a command may close the session, the rest of the input is dropped
+    while (progress == 1U && session->closing == 0U) {
+
+        progress = parse_received(session);
+
+        // a pump that finished lets the queued lines run
+        if (session->pump != NULL && run_pump(session) == 0U) {
+            progress = 1U;
+        }
+
+        if (execute_lines(session) == 1U) {
+            progress = 1U;
+        }
+    }
+
+    if (session->peer_closed == 1U && session->pump != NULL) {
+        // nobody left to read the output
+        stop_following(session);
+    }
+
+    if (session->peer_closed == 1U &&
+        session->closing == 0U &&
+        session->detached == 0U &&
+        session->pump == NULL &&
+        session->received == NULL &&
+        session->line_count == 0U) {
+        telnet_session_close(session);
+    }
+
+    // echo, negotiation replies and responses leave in one burst, a
+    // producer still running fills its segments first
+    if (session->in_use == 1U) {
+
+        telnet_output_flush(&session->output, (producing(session) == 0U) ? 1U : 0U);
+
+        if (telnet_output_pending(&session->output) > 0U) {
+            arm_flush_timer();
+        }
+    }
+}
+
+static err_t session_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+
+    telnet_session *session = (telnet_session *) arg;
+
+    if (p == NULL) {
+        // peer closed the connection, still answer what it sent before
+        session->peer_closed = 1U;
+        process_input(session);
+        return ERR_OK;
+    }
+
+    if (err != ERR_OK || session->closing == 1U) {
+        tcp_recved(pcb, p->tot_len);
+        pbuf_free(p);
+        return ERR_OK;
+    }
+
+    session->last_input = sys_now();
+
+    if (session->received == NULL) {
+        session->received = p;
+    } else {
+        pbuf_cat(session->received, p);
+    }
+
+    process_input(session);
+
+    if (session->received != NULL) {
+        unpin_received(session);
+    }
+
+    return ERR_OK;
+}
+
+static err_t session_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
+
+    telnet_session *session = (telnet_session *) arg;
+
+    telnet_output_acknowledged(&session->output, len);
+
+    if (session->closing == 1U) {
+        telnet_output_flush(&session->output, 1U);
+        finish_close(session);
+        return ERR_OK;
+    }
+
+    // ring space was released, continue with held input, queued lines and the pump
+    process_input(session);
+
+    return ERR_OK;
+}
+
+static err_t session_poll(void *arg, struct tcp_pcb *pcb) {
+
+    telnet_session *session = (telnet_session *) arg;
+
+    if (session == NULL) {
+        return ERR_OK;
+    }
+
+    telnet_output_flush(&session->output, 1U);
+
+    if (session->closing == 1U) {
+        finish_close(session);
+    }
+
+    return ERR_OK;
+}
+
+static void session_err(void *arg, err_t err) {
+
+    telnet_session *session = (telnet_session *) arg;
+
+    // the pcb is already freed by lwIP
+    if (session != NULL) {
+        release_session(session);
+    }
+}
+
+static err_t server_accept(void *arg, struct tcp_pcb *newpcb, err_t err) {
+
+    telnet_session *session = NULL;
+    int i;
+
+    if (err != ERR_OK || newpcb == NULL) {
+        return ERR_VAL;
+    }
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        if (sessions[i].in_use == 0U) {
+            session = &sessions[i];
+            break;
+        }
+    }
+
+    if (session == NULL) {
+        tcp_abort(newpcb);
+        return ERR_ABRT;
+    }
+
+    session->pcb = newpcb;
+    session->in_use = 1U;
+    session->closing = 0U;
+    session->peer_closed = 0U;
+    session->detached = 0U;
+    session->produced = 0U;
+    session->sink = NULL;
+    session->sink_context = NULL;
+    session->pump = NULL;
+    session->pump_context = NULL;
+    session->received = NULL;
+    session->last_input = sys_now();
+    session->line_first = 0U;
+    session->line_count = 0U;
+
+    telnet_output_init(&session->output, newpcb);
+    telnet_input_init(&session->input, &session->output);
+    tcp_metrics_attach(&session->metrics, newpcb);
+
+    // the output ring coalesces already, Nagle would hold its tail behind
+    // an unacknowledged segment until the peer's delayed ACK
+    tcp_nagle_disable(newpcb);
+
+    tcp_arg(newpcb, session);
+    tcp_recv(newpcb, session_recv);
+    tcp_sent(newpcb, session_sent);
+    tcp_err(newpcb, session_err);
+    tcp_poll(newpcb, session_poll, POLL_INTERVAL);
+
+    telnet_session_write_static(session, banner, sizeof(banner) - 1U);
+    write_prompt(session);
+    telnet_session_flush(session);
+
+    return ERR_OK;
+}
+
+err_t telnet_server_init(telnet_line_handler handler, telnet_line_reserve reserve) {
+
+    err_t err;
+
+    line_handler = handler;
+    line_reserve = reserve;
+
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+
+    if (pcb == NULL) {
+        return ERR_MEM;
+    }
+
+    err = tcp_bind(pcb, IP_ANY_TYPE, TELNET_SERVER_PORT);
+
+    if (err != ERR_OK) {
+        tcp_close(pcb);
+        return err;
+    }
+
+    listen_pcb = tcp_listen(pcb);
+
+    if (listen_pcb == NULL) {
+        tcp_close(pcb);
+        return ERR_MEM;
+    }
+
+    tcp_accept(listen_pcb, server_accept);
+
+    return ERR_OK;
+}
+
+void telnet_server_close_idle(void *arg) {
+
+    static const char message[] = "\r\nIdle timeout\r\n";
+    u32_t now = sys_now();
+    int i;
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+
+        telnet_session *session = &sessions[i];
+
+        // a running command or a live view counts as activity
+        if (session->in_use == 0U ||
+            session->pcb == NULL ||
+            session->closing == 1U ||
+            session->detached == 1U ||
+            session->pump != NULL ||
+            (u32_t) (now - session->last_input) < TELNET_IDLE_TIMEOUT_MS) {
+            continue;
+        }
+
+        telnet_session_write_static(session, message, sizeof(message) - 1U);
+        telnet_session_close(session);
+    }
+}
+
+uint16_t telnet_session_write(telnet_session *session, const void *data, uint16_t length) {
+
+    if (session->sink != NULL) {
+        return session->sink(session->sink_context, data, length);
+    }
+
+    uint16_t written = telnet_output_write(&session->output, data, length);
+
+    output_written(session);
+
+    return written;
+}
+
+uint16_t telnet_session_write_static(telnet_session *session, const void *data, uint16_t length) {
+
+    if (session->sink != NULL) {
+        return session->sink(session->sink_context, data, length);
+    }
+
+    uint16_t written = telnet_output_write_static(&session->output, data, length);
+
+    output_written(session);
+
+    return written;
+}
+
+uint16_t telnet_session_printf(telnet_session *session, const char *format, ...) {
+
+    va_list args;
+
+    if (session->sink != NULL) {
+
+        char text[TELNET_OUTPUT_PRINTF_MAX];
+
+        va_start(args, format);
+        int length = vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+
+        if (length < 0) {
+            return 0U;
+        }
+
+        if (length >= (int) sizeof(text)) {
+            length = sizeof(text) - 1U;
+        }
+
+        return session->sink(session->sink_context, text, (uint16_t) length);
+    }
+
+    va_start(args, format);
+    uint16_t written = telnet_output_vprintf(&session->output, format, args);
+    va_end(args);
+
+    output_written(session);
+
+    return written;
+}
+
+void telnet_session_flush(telnet_session *session) {
+
+    telnet_output_flush(&session->output, 1U);
+
+    if (telnet_output_pending(&session->output) > 0U) {
+        arm_flush_timer();
+    }
+}
+
+void telnet_session_close(telnet_session *session) {
+
+    session->closing = 1U;
+
+    telnet_output_flush(&session->output, 1U);
+
+    finish_close(session);
+}
+
+void telnet_session_detach(telnet_session *session, telnet_session_sink sink, void *context) {
+
+    session->sink = sink;
+    session->sink_context = context;
+    session->detached = 1U;
+}
+
+void telnet_session_attach(telnet_session *session) {
+
+    session->sink = NULL;
+    session->sink_context = NULL;
+    session->detached = 0U;
+
+    if (session->pcb == NULL) {
+        // the connection was lost while the line ran
+        release_session(session);
+        return;
+    }
+
+    if (session->closing == 1U) {
+        return;
+    }
+
+    write_prompt(session);
+    process_input(session);
+}
+
+void telnet_session_follow(telnet_session *session, telnet_session_pump pump, void *context) {
+
+    session->pump = pump;
+    session->pump_context = context;
+
+    // first batch right away, the flush timer polls for the rest
+    arm_flush_timer();
+}
+
+uint16_t telnet_session_deliver(telnet_session *session, const void *data, uint16_t length) {
+
+    if (session->pcb == NULL || session->closing == 1U) {
+        return length;
+    }
+
+    uint16_t written = telnet_output_write(&session->output, data, length);
+
+    // the line is still running, the prompt or the flush timer sends the tail
+    output_written(session);
+
+    return written;
+}
@@ -0,0 +1,180 @@
+/*
+ *  Interrupt driven UART1 driver on FreeRTOS stream buffers.
+ *
+ *  plib_uart1 spins on UTXBF and URXDA, a printf at 9600 baud costs about
+ *  1 ms of CPU per character. Here writers only copy into the transmit
+ *  stream buffer and the interrupt handler refills the FIFO each time it
+ *  runs empty (UTXISEL = 10). Received bytes are moved from the FIFO into
+ *  the receive stream buffer, a blocked reader wakes up with the first
+ *  byte.
+ */
+
+#include <stddef.h>
+
+#include "device.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "uart/uart1_driver.h"
+
+/** Bytes moved per stream buffer call in the interrupt handler */
+#define ISR_CHUNK       8U
+
+static StreamBufferHandle_t tx_buffer = NULL;
+static StreamBufferHandle_t rx_buffer = NULL;
+static SemaphoreHandle_t tx_lock = NULL;
+static volatile uint32_t dropped = 0U;
+
+// a stream buffer keeps one byte of its storage empty to tell full from empty
+static uint8_t tx_storage[UART1_DRIVER_TX_SIZE + 1U];
+static uint8_t rx_storage[UART1_DRIVER_RX_SIZE + 1U];
+static StaticStreamBuffer_t tx_control;
+static StaticStreamBuffer_t rx_control;
+static StaticSemaphore_t tx_lock_control;
+
+
+static void start_transmitter(void) {
+
+    // raising the flag runs the handler, it fills the FIFO from the buffer
+    IFS0SET = _IFS0_U1TXIF_MASK;
+    IEC0SET = _IEC0_U1TXIE_MASK;
+}
+
+int uart1_driver_init(void) {
+
+    tx_buffer = xStreamBufferCreateStatic(UART1_DRIVER_TX_SIZE, 1U, tx_storage, &tx_control);
+    rx_buffer = xStreamBufferCreateStatic(UART1_DRIVER_RX_SIZE, 1U, rx_storage, &rx_control);
+    tx_lock = xSemaphoreCreateMutexStatic(&tx_lock_control);
+
+    if (tx_buffer == NULL || rx_buffer == NULL || tx_lock == NULL) {
+        return -1;
+    }
+
+    IEC0CLR = _IEC0_U1EIE_MASK | _IEC0_U1RXIE_MASK | _IEC0_U1TXIE_MASK;
+    IFS0CLR = _IFS0_U1EIF_MASK | _IFS0_U1RXIF_MASK | _IFS0_U1TXIF_MASK;
+
+    // one vector for error, receive and transmit
+    IPC6CLR = _IPC6_U1IP_MASK | _IPC6_U1IS_MASK;
+    IPC6SET = (UART1_DRIVER_INTERRUPT_PRIORITY << _IPC6_U1IP_POSITION);
+
+    // receive interrupt as long as the FIFO is not empty
+    U1STACLR = _U1STA_URXISEL_MASK;
+
+    IEC0SET = _IEC0_U1RXIE_MASK;
+
+    return 0;
+}
+
+size_t uart1_driver_write(const void *data, size_t length, TickType_t timeout) {
+
+    size_t written;
+
+    if (xSemaphoreTake(tx_lock, timeout) != pdTRUE) {
+        return 0U;
+    }
+
+    written = xStreamBufferSend(tx_buffer, data, length, timeout);
+
+    start_transmitter();
+
+    xSemaphoreGive(tx_lock);
+
+    return written;
+}
+
+size_t uart1_driver_read(void *buffer, size_t length, TickType_t timeout) {
+    return xStreamBufferReceive(rx_buffer, buffer, length, timeout);
+}
+
+size_t uart1_driver_write_space(void) {
+    return xStreamBufferSpacesAvailable(tx_buffer);
+}
+
+uint8_t uart1_driver_setup(UART_SERIAL_SETUP *setup) {
+
+    uint8_t applied;
+
+    // the handler must not touch the UART while it is switched off
+    taskENTER_CRITICAL();
+    applied = UART1_SerialSetup(setup, 0U) ? 1U : 0U;
+    taskEXIT_CRITICAL();
+
+    start_transmitter();
+
+    return applied;
+}
+
+void uart1_driver_purge_rx(void) {
+
+    taskENTER_CRITICAL();
+    xStreamBufferReset(rx_buffer);
+    taskEXIT_CRITICAL();
+}
+
+void uart1_driver_purge_tx(void) {
+
+    if (xSemaphoreTake(tx_lock, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    xStreamBufferReset(tx_buffer);
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(tx_lock);
+}
+
+uint32_t uart1_driver_dropped(void) {
+    return dropped;
+}
+
+void uart1_driver_interrupt_handler(void) {
+
+    BaseType_t woken = pdFALSE;
+    uint8_t chunk[ISR_CHUNK];
+    size_t count = 0U;
+
+    while ((U1STA & _U1STA_URXDA_MASK) != 0U) {
+
+        chunk[count++] = (uint8_t) U1RXREG;
+
+        if (count == ISR_CHUNK) {
+            dropped += count - xStreamBufferSendFromISR(rx_buffer, chunk, count, &woken);
+            count = 0U;
+        }
+    }
+
+    if (count > 0U) {
+        dropped += count - xStreamBufferSendFromISR(rx_buffer, chunk, count, &woken);
+    }
+
+    if ((U1STA & _U1STA_OERR_MASK) != 0U) {
+        // the receiver stops until the overrun is cleared, which also empties the FIFO
+        U1STACLR = _U1STA_OERR_MASK;
+        dropped++;
+    }
+
+    // the receive flag is only cleared once the FIFO is empty
+    IFS0CLR = _IFS0_U1EIF_MASK | _IFS0_U1RXIF_MASK;
+
+    if ((IEC0 & _IEC0_U1TXIE_MASK) != 0U && (IFS0 & _IFS0_U1TXIF_MASK) != 0U) {
+
+        IFS0CLR = _IFS0_U1TXIF_MASK;
+
+        while ((U1STA & _U1STA_UTXBF_MASK) == 0U) {
+
+            uint8_t byte;
+
+            if (xStreamBufferReceiveFromISR(tx_buffer, &byte, 1U, &woken) == 0U) {
+                // nothing left, start_transmitter() enables the interrupt again
+                IEC0CLR = _IEC0_U1TXIE_MASK;
+                break;
+            }
+
+            U1TXREG = byte;
+        }
+    }
+
+    portEND_SWITCHING_ISR(woken);
+}
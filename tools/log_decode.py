@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""Decodes deferred log records captured from the UART or the telnet log command.
+
+The firmware prints records as hex lines and never formats them:
+
+    #L <format address> <ticks> [<argument> ...]
+    #D <number of records lost>
+
+The format address points into the .log_strings section of the firmware
+ELF file. This tool reads the strings from the ELF, applies the arguments
+and prints readable lines. Other lines of the capture pass through, so a
+console log with printf output mixed in stays readable.
+
+    python3 tools/log_decode.py pic32-telnet.X/dist/default/production/pic32-telnet.X.production.elf capture.txt
+    telnet 192.168.1.10 | python3 tools/log_decode.py firmware.elf
+
+%s arguments are resolved only if they point to constant strings in the
+ELF file, other pointers are printed as addresses.
+"""
+
+import re
+import struct
+import sys
+
+FORMAT_SPEC = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcspn%])")
+
+TICK_HZ = 1000
+
+
+class Elf(object):
+    """Just enough of ELF to read bytes at a virtual address.
+
+    The firmware is ELF32, the host build under sim/ is ELF64.
+    """
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+
+        if self.data[:4] != b"\x7fELF" or self.data[4] not in (1, 2):
+            sys.exit("log_decode: %s is not an ELF file" % path)
+
+        self.endian = "<" if self.data[5] == 1 else ">"
+
+        if self.data[4] == 1:
+            (shoff,) = struct.unpack_from(self.endian + "I", self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + "HHH", self.data, 0x2E)
+            layout = "IIIIIIIIII"
+        else:
+            (shoff,) = struct.unpack_from(self.endian + "Q", self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.endian + "HHH", self.data, 0x3A)
+            layout = "IIQQQQIIQQ"
+
+        headers = []
+        for i in range(shnum):
+            fields = struct.unpack_from(self.endian + layout, self.data, shoff + i * shentsize)
+            headers.append(fields)
+
+        names = headers[shstrndx]
+        self.sections = []
+
+        for name, kind, flags, addr, offset, size, _, _, _, _ in headers:
+            label = self._cstring(names[4] + name)
+            # SHT_NOBITS sections (.bss) have no file content
+            if addr != 0 and kind != 8:
+                self.sections.append((label, addr, offset, size))
+
+    def _cstring(self, offset):
+        end = self.data.index(b"\0", offset)
+        return self.data[offset:end].decode("ascii", "replace")
+
+    def string_at(self, address):
+        # kseg0 and kseg1 alias the same flash, try both views
+        for candidate in (address, address ^ 0x20000000):
+            for name, addr, offset, size in self.sections:
+                if addr <= candidate < addr + size:
+                    return self._cstring(offset + candidate - addr)
+        return None
+
+
+def to_signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def apply_format(elf, text, args):
+    out = []
+    position = 0
+    index = 0
+
+    for match in FORMAT_SPEC.finditer(text):
+        out.append(text[position:match.start()])
+        position = match.end()
+
+        flags, width, precision, _, conversion = match.groups()
+
+        if conversion == "%":
+            out.append("%")
+            continue
+
+        if width == "*":
+            width = str(args[index]) if index < len(args) else ""
+            index += 1
+
+        if index >= len(args):
+            out.append("<?>")
+            continue
+
+        value = args[index]
+        index += 1
+
+        spec = "%" + (flags or "") + (width or "") + ("." + precision if precision else "")
+
+        if conversion in "di":
+            out.append((spec + "d") % to_signed(value))
+        elif conversion == "u":
+            out.append((spec + "d") % value)
+        elif conversion in "oxX":
+            out.append((spec + conversion) % value)
+        elif conversion == "c":
+            out.append((spec + "c") % chr(value & 0xFF))
+        elif conversion == "p":
+            out.append("0x%08x" % value)
+        elif conversion == "s":
+            string = elf.string_at(value)
+            out.append((spec + "s") % (string if string is not None else "<0x%08x>" % value))
+        else:
+            out.append(match.group(0))
+
+    out.append(text[position:])
+    return "".join(out)
+
+
+def decode_line(elf, line):
+    words = line.split()
+
+    if len(words) >= 2 and words[0] == "#D":
+        return "*** %d lines dropped ***" % int(words[1], 16)
+
+    if len(words) < 3 or words[0] != "#L":
+        return line
+
+    try:
+        values = [int(word, 16) for word in words[1:]]
+    except ValueError:
+        return line
+
+    address, ticks, args = values[0], values[1], values[2:]
+    text = elf.string_at(address)
+
+    if text is None:
+        return "[%10.3f] <unknown format 0x%08x> %s" % (ticks / float(TICK_HZ), address, " ".join(words[3:]))
+
+    return "[%10.3f] %s" % (ticks / float(TICK_HZ), apply_format(elf, text, args))
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit("usage: log_decode.py firmware.elf [capture]")
+
+    elf = Elf(sys.argv[1])
+    source = open(sys.argv[2], errors="replace") if len(sys.argv) == 3 else sys.stdin
+
+    for line in source:
+        print(decode_line(elf, line.rstrip("\r\n")))
+
+
+if __name__ == "__main__":
+    main()
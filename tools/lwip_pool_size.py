@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""Proposes lwIP pool sizes from measured high-water marks.
+
+Takes any number of measurements and prints the pool options of
+include/lwipopts.h with the smallest values that cover them:
+
+    bench JSON      sim/bench/telnet_bench.py --json, every phase counts
+    pools capture   output of the pools shell command, firmware built
+                    with LWIP_POOL_STATS 1, one or more dumps per file
+
+    python3 tools/lwip_pool_size.py --sessions 4 bench.json
+    python3 tools/lwip_pool_size.py --sessions 2 --throughput 2000 --rtt 5 pools.txt
+
+The pools that grow with the connections (heap, TCP_PCB, TCP_SEG, PBUF)
+are scaled linearly from the sessions of each measurement to --sessions:
+the sessions phase of the bench reports its count, every other phase and
+every capture counts as --observed-sessions. Part of each pool is fixed,
+so the scaling errs on the large side. The other pools keep their
+high-water mark. Every pool gets --margin elements on top, the heap
+--heap-margin bytes, rounded up to 256.
+
+A pool that failed an allocation hit its limit, its real demand is
+unknown: the proposal adds the margin to the limit, measure again with it.
+A pool nothing used and the pools the code sizes itself (listeners,
+timeouts) keep their current value.
+
+--throughput in kbit/s sizes one connection's windows for the
+bandwidth-delay product at --rtt milliseconds. The proposal then obeys
+the sanity checks of lwIP's init.c, which LWIP_DISABLE_TCP_SANITY_CHECKS
+turns off in the firmware: TCP_SND_QUEUELEN of at least two per send
+segment, MEMP_NUM_TCP_SEG of at least TCP_SND_QUEUELEN and a PBUF_POOL
+that holds a full receive window.
+
+The RAM column needs the element sizes of the target, which only a pools
+capture of the firmware has; the host build's are 64 bit sizes.
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import sys
+
+LWIPOPTS_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "lwipopts.h")
+
+# lwIP's opt.h values for the options lwipopts.h leaves out
+LWIP_DEFAULTS = {
+    "MEMP_NUM_TCPIP_MSG_API": 8,
+    "MEMP_NUM_TCPIP_MSG_INPKT": 8,
+}
+
+# pool, option, grows with the sessions
+POOLS = (
+    ("HEAP", "MEM_SIZE", True),
+    ("TCP_PCB", "MEMP_NUM_TCP_PCB", True),
+    ("TCP_SEG", "MEMP_NUM_TCP_SEG", True),
+    ("PBUF", "MEMP_NUM_PBUF", True),
+    ("PBUF_POOL", "PBUF_POOL_SIZE", False),
+    ("TCPIP_MSG_INPKT", "MEMP_NUM_TCPIP_MSG_INPKT", False),
+    ("TCPIP_MSG_API", "MEMP_NUM_TCPIP_MSG_API", False),
+    ("NETCONN", "MEMP_NUM_NETCONN", False),
+    ("NETBUF", "MEMP_NUM_NETBUF", False),
+    ("UDP_PCB", "MEMP_NUM_UDP_PCB", False),
+    ("RAW_PCB", "MEMP_NUM_RAW_PCB", False),
+)
+
+# sized by the code that uses them, reported only
+FIXED = (
+    ("TCP_PCB_LISTEN", "MEMP_NUM_TCP_PCB_LISTEN"),
+    ("SYS_TIMEOUT", "MEMP_NUM_SYS_TIMEOUT"),
+)
+
+# Ethernet, IPv4 and TCP headers in front of the data of a PBUF_POOL pbuf
+POOL_PBUF_HEADERS = 14 + 20 + 20
+
+HEAP_ROUNDING = 256
+
+POOLS_LINE = re.compile(r"^(?:> )?([A-Z][A-Z0-9_]*)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s*$")
+
+DEFINE = re.compile(r"^\s*#define\s+(\w+)\s+(.+?)\s*(?:/\*.*)?$")
+
+
+def load_options(path):
+    """Returns the numeric options of lwipopts.h, expressions of earlier options resolved."""
+
+    options = dict(LWIP_DEFAULTS)
+    texts = {}
+
+    with open(path) as f:
+        for line in f:
+            match = DEFINE.match(line)
+            if match is None:
+                continue
+
+            name, text = match.groups()
+            texts[name] = text
+            expression = re.sub(r"\b[A-Za-z_]\w*\b", lambda word: str(options.get(word.group(0), word.group(0))), text)
+
+            if re.fullmatch(r"[0-9\s()+*/-]+", expression):
+                options[name] = int(eval(expression))
+
+    return options, texts
+
+
+class Usage:
+    """The worst a pool saw over all measurements."""
+
+    def __init__(self):
+        self.max = 0
+        self.avail = 0
+        self.err = 0
+        self.size = None
+        self.per_session = 0.0
+        self.sessions = 0
+
+    def add(self, max_used, avail, err, sessions, size=None):
+        self.max = max(self.max, max_used)
+        self.avail = max(self.avail, avail)
+        self.err += err
+        self.per_session = max(self.per_session, max_used / max(sessions, 1))
+        self.sessions = max(self.sessions, sessions)
+        if size is not None:
+            self.size = size
+
+
+def read_bench(report, observed, usage):
+    for phase, figures in report.get("results", {}).items():
+        sessions = figures.get("max_sessions", observed)
+        pools = dict(figures.get("pools", {}))
+        if "heap" in figures:
+            pools["HEAP"] = figures["heap"]
+        for name, pool in pools.items():
+            usage.setdefault(name, Usage()).add(pool["max"], pool["avail"], pool["err"], sessions)
+
+
+def read_capture(text, observed, usage):
+    found = False
+
+    for line in text.splitlines():
+        match = POOLS_LINE.match(line.strip("\r"))
+        if match is None:
+            continue
+
+        name = match.group(1)
+        size, avail, _, max_used, err = (int(value) for value in match.groups()[1:])
+        usage.setdefault(name, Usage()).add(max_used, avail, err, observed, size)
+        found = True
+
+    return found
+
+
+def propose(usage, options, args):
+    """Returns option -> (proposed value, note) for every pool option."""
+
+    proposal = {}
+
+    for pool, option, scaled in POOLS:
+        current = options.get(option)
+        seen = usage.get(pool)
+
+        if seen is None or (seen.max == 0 and seen.err == 0):
+            proposal[option] = (current, "not used, kept")
+            continue
+
+        if pool == "HEAP":
+            demand = seen.per_session * args.sessions if scaled else seen.max
+            value = int(math.ceil((demand + args.heap_margin) / HEAP_ROUNDING) * HEAP_ROUNDING)
+        else:
+            demand = math.ceil(seen.per_session * args.sessions) if scaled else seen.max
+            value = int(demand) + args.margin
+
+        note = "%d sessions" % args.sessions if scaled else "high-water"
+
+        if seen.err:
+            value = max(value, seen.avail + (args.heap_margin if pool == "HEAP" else args.margin))
+            note = "ran out %d times, measure again" % seen.err
+
+        proposal[option] = (value, note)
+
+    for pool, option in FIXED:
+        proposal[option] = (options.get(option), "sized by the code")
+
+    mss = options["TCP_MSS"]
+
+    if args.throughput:
+        window = args.throughput * 1000.0 / 8.0 * args.rtt / 1000.0
+        segments = max(2, int(math.ceil(window / mss)))
+        note = "%d kbit/s at %g ms" % (args.throughput, args.rtt)
+        proposal["TCP_WND"] = (segments * mss, note)
+        proposal["TCP_SND_BUF"] = (segments * mss, note)
+    else:
+        proposal["TCP_WND"] = (options["TCP_WND"], "kept")
+        proposal["TCP_SND_BUF"] = (options["TCP_SND_BUF"], "kept")
+
+    # lwIP's sanity checks, in dependency order
+    send_segments = proposal["TCP_SND_BUF"][0] // mss
+    queue = max(2 * send_segments, 2)
+    proposal["TCP_SND_QUEUELEN"] = (queue, "2 per send segment")
+    raise_to(proposal, "MEMP_NUM_TCP_SEG", queue, "TCP_SND_QUEUELEN")
+
+    if args.throughput:
+        raise_to(proposal, "MEM_SIZE", int(math.ceil((proposal["TCP_SND_BUF"][0] + args.heap_margin) /
+                                                     HEAP_ROUNDING) * HEAP_ROUNDING), "send buffer")
+
+    payload = options["PBUF_POOL_BUFSIZE"] - POOL_PBUF_HEADERS
+    raise_to(proposal, "PBUF_POOL_SIZE", int(math.ceil(proposal["TCP_WND"][0] / payload)), "receive window")
+
+    return proposal
+
+
+def raise_to(proposal, option, minimum, reason):
+    value, note = proposal[option]
+
+    if value is None or value < minimum:
+        proposal[option] = (minimum, "raised for " + reason)
+
+
+def element_bytes(size):
+    # memp.c aligns every element to MEM_ALIGNMENT, 4 on the PIC32
+    return (size + 3) // 4 * 4
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Propose lwIP pool sizes from measured high-water marks.")
+    parser.add_argument("inputs", nargs="+", help="bench JSON files or captures of the pools command")
+    parser.add_argument("--sessions", type=int, default=2, help="telnet sessions to size for")
+    parser.add_argument("--observed-sessions", type=int, default=1,
+                        help="sessions open during a capture or a bench phase without a count")
+    parser.add_argument("--throughput", type=int, help="kbit/s one connection should reach")
+    parser.add_argument("--rtt", type=float, default=10.0, help="round trip time for --throughput in ms")
+    parser.add_argument("--margin", type=int, default=1, help="elements added to every pool")
+    parser.add_argument("--heap-margin", type=int, default=512, help="bytes added to the heap")
+    parser.add_argument("--options", default=LWIPOPTS_H, help="the lwipopts.h to compare with")
+    args = parser.parse_args()
+
+    options, texts = load_options(args.options)
+    usage = {}
+
+    for path in args.inputs:
+        with open(path) as f:
+            text = f.read()
+        try:
+            read_bench(json.loads(text), args.observed_sessions, usage)
+        except ValueError:
+            if not read_capture(text, args.observed_sessions, usage):
+                sys.exit("lwip_pool_size: %s is neither a bench report nor a pools capture" % path)
+
+    proposal = propose(usage, options, args)
+    pools_of = dict((option, pool) for pool, option, _ in POOLS)
+    pools_of.update((option, pool) for pool, option in FIXED)
+    ram = 0
+    ram_known = True
+
+    print("%-26s %8s %8s %12s %8s  %s" % ("option", "current", "proposed", "max/avail", "ram", "note"))
+
+    for option, (value, note) in proposal.items():
+        current = options.get(option)
+        seen = usage.get(pools_of.get(option))
+        high = "%d/%d" % (seen.max, seen.avail) if seen is not None else "-"
+        delta = "-"
+
+        if seen is not None and current is not None and value is not None:
+            if option == "MEM_SIZE":
+                delta = value - current
+            elif seen.size is not None:
+                delta = (value - current) * element_bytes(seen.size)
+            else:
+                ram_known = False
+            if delta != "-":
+                ram += delta
+                delta = "%+d" % delta
+
+        print("%-26s %8s %8s %12s %8s  %s" % (option, "?" if current is None else current,
+                                              "?" if value is None else value, high, delta, note))
+
+    print("\nRAM %+d bytes%s" % (ram, "" if ram_known else ", pools without a size from a target capture not counted"))
+
+    print("\n/* proposal for %d sessions%s */" % (args.sessions, ", %d kbit/s at %g ms" % (args.throughput, args.rtt)
+                                                 if args.throughput else ""))
+    for option, (value, _) in proposal.items():
+        if value is None:
+            continue
+        text = texts.get(option, str(value))
+        if value != options.get(option):
+            if option == "MEM_SIZE" and value % 1024 == 0:
+                text = "(%d * 1024)" % (value // 1024)
+            elif option in ("TCP_WND", "TCP_SND_BUF"):
+                text = "(%d * TCP_MSS)" % (value // options["TCP_MSS"])
+            else:
+                text = str(value)
+        print("#define %-30s %s" % (option, text))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Generates the perfect hash for the shell command table.
+
+Reads include/shell/shell_commands.def and writes include/shell/shell_hash.h
+with a seed and a slot table such that every command name hashes to its
+own slot. The firmware then finds a command with one hash and one strcmp,
+no matter how many commands are registered.
+
+The hash must match hash_name() in src/shell/shell.c:
+
+    hash = seed
+    for each byte: hash = (hash ^ byte) * 16777619      (32 bit FNV-1a step)
+    slot = (hash ^ (hash >> 16)) & (slots - 1)
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+DEF_FILE = os.path.join(ROOT, "include", "shell", "shell_commands.def")
+OUT_FILE = os.path.join(ROOT, "include", "shell", "shell_hash.h")
+
+FNV_PRIME = 16777619
+EMPTY = 0xFF
+
+
+def read_names(path):
+    with open(path) as f:
+        text = f.read()
+
+    # skip the comment block, it documents the macro itself
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+
+    return re.findall(r"^\s*SHELL_COMMAND\(\s*(\w+)\s*,", text, flags=re.M)
+
+
+def hash_name(name, seed):
+    h = seed
+    for byte in name.encode("ascii"):
+        h = ((h ^ byte) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def slot_of(name, seed, slots):
+    h = hash_name(name, seed)
+    return (h ^ (h >> 16)) & (slots - 1)
+
+
+def find_seed(names, slots):
+    for seed in range(1, 1 << 20):
+        taken = set()
+        for name in names:
+            slot = slot_of(name, seed, slots)
+            if slot in taken:
+                break
+            taken.add(slot)
+        else:
+            return seed
+    return None
+
+
+def main():
+    names = read_names(DEF_FILE)
+
+    if len(names) == 0 or len(names) >= EMPTY:
+        sys.exit("shell_hash_gen: need 1..254 commands, found %d" % len(names))
+
+    if len(set(names)) != len(names):
+        sys.exit("shell_hash_gen: duplicate command name")
+
+    # load factor of at most one half keeps the seed search short
+    slots = 4
+    while slots < 2 * len(names):
+        slots *= 2
+
+    seed = find_seed(names, slots)
+
+    while seed is None:
+        slots *= 2
+        seed = find_seed(names, slots)
+
+    table = [EMPTY] * slots
+    for index, name in enumerate(names):
+        table[slot_of(name, seed, slots)] = index
+
+    rows = []
+    for i in range(0, slots, 8):
+        rows.append("    " + ", ".join("0x%02XU" % v for v in table[i:i + 8]))
+
+    with open(OUT_FILE, "w") as f:
+        f.write("#pragma once\n\n")
+        f.write("/*\n")
+        f.write(" *  Generated by tools/shell_hash_gen.py from shell_commands.def, do not edit.\n")
+        f.write(" *\n")
+        f.write(" *  Commands: %s\n" % " ".join(names))
+        f.write(" */\n\n")
+        f.write("#define SHELL_HASH_SEED         0x%08XU\n" % seed)
+        f.write("#define SHELL_HASH_SLOTS        %dU\n" % slots)
+        f.write("#define SHELL_HASH_COMMANDS     %dU\n" % len(names))
+        f.write("#define SHELL_HASH_NAME_MAX     %dU\n" % max(len(name) for name in names))
+        f.write("#define SHELL_HASH_EMPTY        0x%02XU\n\n" % EMPTY)
+        f.write("/** Position of every command in shell_commands.def, checked against it at compile time */\n")
+        width = max(len(name) for name in names) + len("SHELL_HASH_INDEX_") + 1
+        for index, name in enumerate(names):
+            f.write("#define %-*s %dU\n" % (width, "SHELL_HASH_INDEX_" + name, index))
+        f.write("\n")
+        f.write("/** Command index for every hash slot, SHELL_HASH_EMPTY when unused */\n")
+        f.write("#define SHELL_HASH_TABLE { \\\n")
+        f.write(", \\\n".join(rows))
+        f.write(" \\\n}\n")
+
+    print("shell_hash_gen: %d commands, %d slots, seed 0x%08X" % (len(names), slots, seed))
+
+
+if __name__ == "__main__":
+    main()
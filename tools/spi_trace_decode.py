@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""Decodes an ENC624J600 SPI trace captured from the spitrace command.
+
+Firmware built with ENC624J600_TRACE=1 records every chip select bounded
+transaction and dumps them as hex lines:
+
+    #T <core timer Hz>
+    #S <start> <duration> <opcode << 24 | second byte << 16 | bytes on the bus>
+
+This tool names the operations from include/enc624j600/enc624j600_registers.h,
+lists them with their start and duration and then totals the time per
+operation, so the cost of a driver path shows up without a logic analyzer:
+
+          0.000000      3.421 us  WCRU ETXLEN 2B
+          0.000012     42.105 us  WGPDATA 60B
+
+    python3 tools/spi_trace_decode.py capture.txt
+    python3 tools/spi_trace_decode.py --totals capture.txt
+
+Other lines of the capture are ignored. Times use the core timer rate of
+the #T line, 38 MHz on the PIC32. The host build traces too, its core
+timer runs on host time:
+
+    make -C sim FREERTOS_POSIX_PORT=... CFLAGS="-O2 -g -DENC624J600_TRACE=1"
+"""
+
+import argparse
+import os
+import re
+import sys
+
+REGISTERS_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "enc624j600",
+                           "enc624j600_registers.h")
+
+RECORD = re.compile(r"#([TS])((?: [0-9a-fA-F]{8})+)")
+
+DEFINE = re.compile(r"#define\s+(\w+)\s+0x([0-9A-Fa-f]+)U?\b")
+
+# banked SFR operations carry the address in the low 5 bits of the opcode
+BANKED = ((0x00, "RCR"), (0x40, "WCR"), (0x80, "BFS"), (0xA0, "BFC"))
+
+BANK_SELECT = {0xC0: 0, 0xC2: 1, 0xC4: 2, 0xC6: 3}
+
+
+def load_names(path):
+    """Returns the register names by address and the opcode names by opcode."""
+
+    registers = {}
+    opcodes = {}
+    group = None
+
+    with open(path) as f:
+        for line in f:
+            if "@defgroup" in line:
+                group = line.split()[2]
+                continue
+
+            match = DEFINE.match(line.strip())
+            if match is None:
+                continue
+
+            name, value = match.group(1), int(match.group(2), 16)
+
+            if group == "Unbanked_SFR_Address":
+                registers.setdefault(value, name)
+            elif group == "SPI_Instruction_Set":
+                opcodes[value] = name
+
+    return registers, opcodes
+
+
+class Decoder(object):
+    """Turns records into operation names, tracking the selected SFR bank."""
+
+    def __init__(self, registers, opcodes):
+        self.registers = registers
+        self.opcodes = opcodes
+        self.bank = 0
+
+    def register(self, address):
+        if address in self.registers:
+            return self.registers[address]
+
+        if address - 1 in self.registers:
+            return self.registers[address - 1] + "H"
+
+        return "0x%02X" % address
+
+    def decode(self, opcode, argument, length):
+        """Returns (operation, description) of one transaction."""
+
+        if opcode in BANK_SELECT:
+            self.bank = BANK_SELECT[opcode]
+
+        name = self.opcodes.get(opcode)
+
+        if name is not None:
+            if length <= 1:
+                return name, name
+
+            if opcode in (0x20, 0x22, 0x24, 0x26):
+                return name, "%s %s %dB" % (name, self.register(argument), length - 2)
+
+            return name, "%s %dB" % (name, length - 1)
+
+        if opcode < 0xC0:
+            for base, banked in BANKED:
+                if base <= opcode < base + 0x20:
+                    address = self.bank * 0x20 + (opcode - base)
+                    return banked, "%s %s %dB" % (banked, self.register(address), length - 1)
+
+        unknown = "0x%02X" % opcode
+        return unknown, "%s %dB" % (unknown, length - 1)
+
+
+def parse(source):
+    """Yields the timer rate once, then (start, duration, info) per record."""
+
+    for line in source:
+        # a shell prompt may precede the first line of the dump
+        match = RECORD.search(line)
+        if match is None:
+            continue
+
+        values = [int(word, 16) for word in match.group(2).split()]
+
+        if match.group(1) == "T" and len(values) == 1:
+            yield values[0]
+        elif match.group(1) == "S" and len(values) == 3:
+            yield tuple(values)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode an ENC624J600 SPI trace dump.")
+    parser.add_argument("capture", nargs="?", help="dump of spitrace, stdin if omitted")
+    parser.add_argument("--registers", default=REGISTERS_H, help="enc624j600_registers.h to take the names from")
+    parser.add_argument("--totals", action="store_true", help="print the totals only")
+    args = parser.parse_args()
+
+    registers, opcodes = load_names(args.registers)
+    decoder = Decoder(registers, opcodes)
+    source = open(args.capture, errors="replace") if args.capture else sys.stdin
+
+    timer_hz = None
+    first = None
+    totals = {}
+
+    for item in parse(source):
+        if isinstance(item, int):
+            timer_hz = item
+            continue
+
+        if timer_hz is None:
+            sys.exit("spi_trace_decode: no #T line before the first record")
+
+        start, duration, info = item
+        opcode, argument, length = info >> 24, (info >> 16) & 0xFF, info & 0xFFFF
+        operation, text = decoder.decode(opcode, argument, length)
+
+        if first is None:
+            first = start
+
+        if not args.totals:
+            # the core timer wraps every 113 s at 38 MHz
+            offset = ((start - first) & 0xFFFFFFFF) / float(timer_hz)
+            print("%14.6f %10.3f us  %s" % (offset, duration * 1e6 / timer_hz, text))
+
+        count, size, ticks = totals.get(operation, (0, 0, 0))
+        totals[operation] = (count + 1, size + length, ticks + duration)
+
+    if not totals:
+        return
+
+    all_ticks = sum(ticks for _, _, ticks in totals.values()) or 1
+
+    if not args.totals:
+        print("")
+
+    print("%-10s %8s %10s %12s %8s %6s" % ("operation", "count", "bytes", "time us", "avg us", "share"))
+
+    for operation, (count, size, ticks) in sorted(totals.items(), key=lambda item: -item[1][2]):
+        micros = ticks * 1e6 / timer_hz
+        print("%-10s %8d %10d %12.1f %8.2f %5.1f%%" % (operation, count, size, micros, micros / count,
+                                                      100.0 * ticks / all_ticks))
+
+    count = sum(count for count, _, _ in totals.values())
+    size = sum(size for _, size, _ in totals.values())
+    print("%-10s %8d %10d %12.1f" % ("total", count, size, all_ticks * 1e6 / timer_hz))
+
+
+if __name__ == "__main__":
+    main()